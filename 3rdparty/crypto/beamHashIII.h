@@ -45,6 +45,9 @@ class BeamHash_III : public PoWScheme {
 	int InitialiseState(blake2b_state& base_state);
 	bool IsValidSolution(const blake2b_state& base_state, std::vector<unsigned char> soln);
 
+	// Allocation-free version, soln must point to the 104-byte minimal encoding
+	static bool IsValidSolution(const blake2b_state& base_state, const uint8_t* soln, size_t size);
+
 	#ifdef ENABLE_MINING
 	bool OptimisedSolve(const blake2b_state& base_state,
                         const std::function<bool(const std::vector<unsigned char>&)> validBlock,
@@ -210,64 +210,215 @@ int BeamHash_III::InitialiseState(blake2b_state& base_state) {
 }
 
 
+/********
+
+    Allocation-free verifier
+
+    Works on fixed stack buffers and is bit-exact with the stepElem based flow
+    used by the solver. All the checks of a round are conjunctive, so the index
+    ordering and distinctness conditions are evaluated once up front. Once they
+    hold, every merged index tree is a contiguous slice of the solution, so only
+    the work bits need to be carried between rounds.
+
+********/
+
+namespace beamHashVerify {
+
+const uint32_t numIndices = 1 << numRounds;
+const uint32_t indexBitSize = collisionBitSize + 1;
+const uint32_t workWords = workBitSize / 64;
+const uint32_t numHashes = numIndices * workWords;
+
+// SipHash lanes evaluated side by side. Every step below is a plain loop over
+// independent lanes, which the compiler maps onto SIMD registers.
+const uint32_t numLanes = 8;
+
+static_assert(numHashes % numLanes == 0, "");
+
+inline void sipRoundLanes(uint64_t* v0, uint64_t* v1, uint64_t* v2, uint64_t* v3) {
+	for (uint32_t j=0; j<numLanes; j++) { v0[j] += v1[j]; v2[j] += v3[j]; }
+	for (uint32_t j=0; j<numLanes; j++) { v1[j] = (v1[j] << 13) | (v1[j] >> 51); v3[j] = (v3[j] << 16) | (v3[j] >> 48); }
+	for (uint32_t j=0; j<numLanes; j++) { v1[j] ^= v0[j]; v3[j] ^= v2[j]; }
+	for (uint32_t j=0; j<numLanes; j++) { v0[j] = (v0[j] << 32) | (v0[j] >> 32); }
+	for (uint32_t j=0; j<numLanes; j++) { v2[j] += v1[j]; v0[j] += v3[j]; }
+	for (uint32_t j=0; j<numLanes; j++) { v1[j] = (v1[j] << 17) | (v1[j] >> 47); v3[j] = (v3[j] << 21) | (v3[j] >> 43); }
+	for (uint32_t j=0; j<numLanes; j++) { v1[j] ^= v2[j]; v3[j] ^= v0[j]; }
+	for (uint32_t j=0; j<numLanes; j++) { v2[j] = (v2[j] << 32) | (v2[j] >> 32); }
+}
+
+// Same as sipHash::siphash24() for numLanes nonces at once
+void siphash24Lanes(const uint64_t* prePow, const uint64_t* nonce, uint64_t* out) {
+	uint64_t v0[numLanes], v1[numLanes], v2[numLanes], v3[numLanes];
+
+	for (uint32_t j=0; j<numLanes; j++) {
+		v0[j] = prePow[0]; v1[j] = prePow[1]; v2[j] = prePow[2];
+		v3[j] = prePow[3] ^ nonce[j];
+	}
+
+	sipRoundLanes(v0, v1, v2, v3);
+	sipRoundLanes(v0, v1, v2, v3);
+
+	for (uint32_t j=0; j<numLanes; j++) {
+		v0[j] ^= nonce[j];
+		v2[j] ^= 0xff;
+	}
+
+	sipRoundLanes(v0, v1, v2, v3);
+	sipRoundLanes(v0, v1, v2, v3);
+	sipRoundLanes(v0, v1, v2, v3);
+	sipRoundLanes(v0, v1, v2, v3);
+
+	for (uint32_t j=0; j<numLanes; j++) out[j] = v0[j] ^ v1[j] ^ v2[j] ^ v3[j];
+}
+
+// Same as GetIndicesFromMinimal(): 25-bit little-endian indices from bytes 0..99
+void getIndices(const uint8_t* soln, uint32_t* indices) {
+	for (uint32_t i=0; i<numIndices; i++) {
+		uint32_t bitPos = i * indexBitSize;
+		const uint8_t* p = soln + (bitPos >> 3);
+
+		uint32_t val = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+		indices[i] = (val >> (bitPos & 7)) & ((1U << indexBitSize) - 1);
+	}
+}
+
+// Same as stepElem::applyMix() for an element whose index tree is indices[0..nIndices)
+void applyMix(uint64_t* work, const uint32_t* indices, uint32_t nIndices, uint32_t remLen) {
+	uint64_t temp[8];
+	for (uint32_t k=0; k<workWords; k++) temp[k] = work[k];
+	temp[7] = 0;
+
+	uint32_t padNum = ((512-remLen) + collisionBitSize) / indexBitSize;
+	padNum = std::min(padNum, nIndices);
+
+	for (uint32_t i=0; i<padNum; i++) {
+		uint32_t pos = remLen + i*indexBitSize;
+		uint32_t word = pos >> 6;
+		uint32_t shift = pos & 63;
+
+		temp[word] |= static_cast<uint64_t>(indices[i]) << shift;
+		if ((shift + indexBitSize > 64) && (word + 1 < 8))
+			temp[word + 1] |= static_cast<uint64_t>(indices[i]) >> (64 - shift);
+	}
+
+	uint64_t result = 0;
+	for (uint32_t i=0; i<8; i++) {
+		result += sipHash::rotl(temp[i], (29*(i+1)) & 0x3F);
+	}
+
+	work[0] = sipHash::rotl(result, 24);
+}
+
+// Same as the stepElem merging constructor, without the index tree
+void merge(uint64_t* out, const uint64_t* a, const uint64_t* b, uint32_t remLen) {
+	uint64_t x[workWords];
+	for (uint32_t k=0; k<workWords; k++) x[k] = a[k] ^ b[k];
+
+	for (uint32_t k=0; k<workWords; k++) {
+		uint64_t val = x[k] >> collisionBitSize;
+		if (k + 1 < workWords) val |= x[k + 1] << (64 - collisionBitSize);
+
+		uint32_t bitPos = k * 64;
+		if (bitPos >= remLen) {
+			val = 0;
+		} else if (remLen - bitPos < 64) {
+			val &= (static_cast<uint64_t>(1) << (remLen - bitPos)) - 1;
+		}
+
+		out[k] = val;
+	}
+}
+
+bool checkIndices(const uint32_t* indices) {
+	// Merged subtrees must be ordered by their leading index
+	for (uint32_t treeSize=1; treeSize<numIndices; treeSize <<= 1) {
+		for (uint32_t i=0; i<numIndices; i += (treeSize << 1)) {
+			if (indices[i] >= indices[i + treeSize]) return false;
+		}
+	}
+
+	for (uint32_t i=0; i<numIndices; i++) {
+		for (uint32_t j=i+1; j<numIndices; j++) {
+			if (indices[i] == indices[j]) return false;
+		}
+	}
+
+	return true;
+}
+
+} //end namespace beamHashVerify
+
+
 bool BeamHash_III::IsValidSolution(const blake2b_state& base_state, std::vector<uint8_t> soln) {
-	
-	if (soln.size() != 104)  {		
+	return IsValidSolution(base_state, soln.data(), soln.size());
+}
+
+bool BeamHash_III::IsValidSolution(const blake2b_state& base_state, const uint8_t* soln, size_t size) {
+	using namespace beamHashVerify;
+
+	if (size != 104)  {
 		return false;
-    	}
-	
+	}
+
+	uint32_t indices[numIndices];
+	getIndices(soln, indices);
+
+	if (!checkIndices(indices)) {
+		return false;
+	}
+
 	uint64_t prePow[4];
 	blake2b_state state = base_state;
 	// Last 4 bytes of solution are our extra nonce
-	blake2b_update(&state, (uint8_t*) &soln[100], 4);			
-	blake2b_final(&state, (uint8_t*) &prePow[0], static_cast<uint8_t>(32));	
+	blake2b_update(&state, soln + 100, 4);
+	blake2b_final(&state, (uint8_t*) &prePow[0], static_cast<uint8_t>(32));
 
-	// This will only evaluate bytes 0..99
-	std::vector<uint32_t> indices = GetIndicesFromMinimal(soln);
+	// Element i occupies work[i*workWords ...], word k being siphash24 of (index << 3) + k
+	uint64_t work[numHashes];
+	for (uint32_t h=0; h<numHashes; h += numLanes) {
+		uint64_t nonce[numLanes];
+		for (uint32_t j=0; j<numLanes; j++) {
+			uint32_t n = h + j;
+			nonce[j] = (indices[n / workWords] << 3) + (n % workWords);
+		}
 
-	std::vector<stepElem> X;
-	for (uint32_t i=0; i<indices.size(); i++) {
-		X.emplace_back(&prePow[0], indices[i]);
+		siphash24Lanes(prePow, nonce, work + h);
 	}
 
-	uint32_t round=1;
-	while (X.size() > 1) {
-		std::vector<stepElem> Xtmp;
-
-		for (size_t i = 0; i < X.size(); i += 2) {
-			uint32_t remLen = workBitSize-(round-1)*collisionBitSize;
-			if (round == 5) remLen -= 64;
-
-			X[i].applyMix(remLen);
-			X[i+1].applyMix(remLen);
-		
-			if (!hasCollision(X[i], X[i+1])) { 
-				//std::cout << "Collision Error" << i << " " << X.size() << " " << X[i].getCollisionBits() << " " << X[i+1].getCollisionBits() << std::endl;
-                		return false;
-            		}
-
-			if (!distinctIndices(X[i], X[i+1])) { 
-				//std::cout << "Non-Distinct" << i << " " << X.size() << std::endl;
-                		return false;
-            		}
-
-			if (!indexAfter(X[i], X[i+1])) { 
-				//std::cout << "Index Order" << i << " " << X.size() << std::endl;
-                		return false;
-            		}
-
-			remLen = workBitSize-round*collisionBitSize;
-			if (round == 4) remLen -= 64;
-			if (round == 5) remLen = collisionBitSize;
-
-			Xtmp.emplace_back(X[i], X[i+1], remLen);
+	uint32_t numElems = numIndices;
+	for (uint32_t round=1; round<=numRounds; round++) {
+		uint32_t treeSize = 1 << (round-1);
+
+		uint32_t mixLen = workBitSize-(round-1)*collisionBitSize;
+		if (round == 5) mixLen -= 64;
+
+		uint32_t remLen = workBitSize-round*collisionBitSize;
+		if (round == 4) remLen -= 64;
+		if (round == 5) remLen = collisionBitSize;
+
+		for (uint32_t i=0; i<numElems; i += 2) {
+			uint64_t* a = work + i*workWords;
+			uint64_t* b = a + workWords;
+
+			applyMix(a, indices + i*treeSize, treeSize, mixLen);
+			applyMix(b, indices + (i+1)*treeSize, treeSize, mixLen);
+
+			if ((a[0] ^ b[0]) & ((1U << collisionBitSize) - 1)) {
+				return false;
+			}
+
+			// In-place: slot i/2 has already been consumed
+			merge(work + (i/2)*workWords, a, b, remLen);
 		}
 
-		X = Xtmp;
-		round++;
+		numElems >>= 1;
+	}
+
+	for (uint32_t k=0; k<workWords; k++) {
+		if (work[k]) return false;
 	}
 
-	return X[0].isZero();	
+	return true;
 }
 
 
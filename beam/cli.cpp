@@ -221,6 +221,8 @@ int main_impl(int argc, char* argv[])
                     find_certificates(powOptions, vm[cli::STRATUM_SECRETS_PATH].as<string>(), vm[cli::STRATUM_USE_TLS].as<bool>());
                     unsigned noncePrefixDigits = vm[cli::NONCEPREFIX_DIGITS].as<unsigned>();
                     if (noncePrefixDigits > 6) noncePrefixDigits = 6;
+                    powOptions.threads = vm[cli::STRATUM_THREADS].as<unsigned>();
+                    powOptions.shareInterval = vm[cli::STRATUM_SHARE_INTERVAL].as<unsigned>();
 					stratumServer = IExternalPOW::create(powOptions, *reactor, io::Address().port(stratumPort), noncePrefixDigits);
 				}
 
@@ -234,6 +236,8 @@ int main_impl(int argc, char* argv[])
 					node.m_Cfg.m_Listen.port(port);
 					node.m_Cfg.m_Listen.ip(INADDR_ANY);
 					node.m_Cfg.m_sPathLocal = vm[cli::STORAGE].as<string>();
+					if (vm.count(cli::TX_POOL_SNAPSHOT))
+						node.m_Cfg.m_sPathTxPool = vm[cli::TX_POOL_SNAPSHOT].as<string>();
 
 					if (Rules::get().FakePoW)
 					{
@@ -255,7 +259,11 @@ int main_impl(int argc, char* argv[])
 					std::string sKeyMine;
 					get_parametr_with_deprecated_synonym(vm, cli::MINER_KEY, cli::KEY_MINE, &sKeyMine);
 
-					if (!(sKeyOwner.empty() && sKeyMine.empty()))
+					std::vector<std::string> vKeysOwnerExtra;
+					if (vm.count(cli::OWNER_KEYS_EXTRA))
+						vKeysOwnerExtra = vm[cli::OWNER_KEYS_EXTRA].as<std::vector<std::string> >();
+
+					if (!(sKeyOwner.empty() && sKeyMine.empty() && vKeysOwnerExtra.empty()))
 					{
 						SecString pass;
 						if (!beam::read_wallet_pass(pass, vm))
@@ -289,6 +297,17 @@ int main_impl(int argc, char* argv[])
 
 							node.m_Keys.m_pOwner = pKdf;
 						}
+
+						for (auto& sKey : vKeysOwnerExtra)
+						{
+							ks.m_sRes = move(sKey);
+
+							std::shared_ptr<HKdfPub> pKdf = std::make_shared<HKdfPub>();
+							if (!ks.Import(*pKdf))
+								throw std::runtime_error("extra view key import failed");
+
+							node.m_Keys.m_vOwnersExtra.push_back(std::move(pKdf));
+						}
 					}
 
 					std::vector<std::string> vPeers = getCfgPeers(vm);
@@ -352,6 +371,12 @@ int main_impl(int argc, char* argv[])
 							node.m_Cfg.m_Horizon.SetInfinite();
 					}
 
+					if (vm.count(cli::SNAPSHOT_IMPORT))
+					{
+						string sPath = vm[cli::SNAPSHOT_IMPORT].as<string>();
+						NodeProcessor::ImportSnapshot(sPath.c_str(), node.m_Cfg.m_sPathLocal.c_str());
+					}
+
 					node.Initialize(stratumServer.get());
 
 					if (vm[cli::PRINT_TXO].as<bool>())
@@ -397,7 +422,13 @@ int main_impl(int argc, char* argv[])
 						node.RefreshCongestions();
 					}
 
-					reactor->run();
+					if (vm.count(cli::SNAPSHOT_EXPORT))
+					{
+						string sPath = vm[cli::SNAPSHOT_EXPORT].as<string>();
+						node.get_Processor().ExportSnapshot(sPath.c_str(), vm[cli::SNAPSHOT_HEIGHT].as<Height>());
+					}
+					else
+						reactor->run();
 				}
 			}
 		}
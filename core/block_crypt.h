@@ -1229,6 +1229,7 @@ namespace beam
 			Difficulty m_Difficulty;
 
 			bool IsValid(const void* pInput, uint32_t nSizeInput, Height) const;
+			bool TestDifficulty(Difficulty) const; // only the solution hash vs the difficulty. Cheap, the solution itself is not verified
 
 			using Cancel = std::function<bool(bool bRetrying)>;
 			// Difficulty and Nonce must be initialized. During the solution it's incremented each time by 1.
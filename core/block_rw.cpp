@@ -481,35 +481,58 @@ namespace beam
 
 	bool RecoveryInfo::IParser::Context::ProceedUtxos()
 	{
+		// utxos are read and verified sequentially, but passed to the parser in batches, so that it may recognize them in parallel
+		const uint32_t nBatch = 1024;
+
+		std::vector<Height> vHeights;
+		std::vector<Output::Ptr> vOutputs;
+		vHeights.reserve(nBatch);
+		vOutputs.reserve(nBatch);
+
 		while (true)
 		{
-			if (!m_Stream.get_Remaining())
-				break; // old-style terminator
+			bool bEnd = !m_Stream.get_Remaining(); // old-style terminator
 
-			Height h;
-			m_Der & h;
+			if (!bEnd)
+			{
+				Height h;
+				m_Der & h;
 
-			if (MaxHeight == h)
-				break;
+				bEnd = (MaxHeight == h);
+				if (!bEnd)
+				{
+					Output::Ptr pOutp(new Output);
+					m_Der & *pOutp;
 
-			Output outp;
-			m_Der & outp;
+					UtxoTree::Key::Data d;
+					d.m_Commitment = pOutp->m_Commitment;
+					d.m_Maturity = pOutp->get_MinMaturity(h);
 
-			UtxoTree::Key::Data d;
-			d.m_Commitment = outp.m_Commitment;
-			d.m_Maturity = outp.get_MinMaturity(h);
+					UtxoTree::Key key;
+					key = d;
 
-			UtxoTree::Key key;
-			key = d;
+					if (!m_UtxoTree.Add(key))
+						ThrowBadData();
 
-			if (!m_UtxoTree.Add(key))
-				ThrowBadData();
+					vHeights.push_back(h);
+					vOutputs.push_back(std::move(pOutp));
+				}
+			}
 
-			if (!m_Parser.OnUtxo(h, outp))
-				return false;
+			if ((vOutputs.size() == nBatch) || (bEnd && !vOutputs.empty()))
+			{
+				if (!m_Parser.OnUtxos(&vHeights.front(), &vOutputs.front(), static_cast<uint32_t>(vOutputs.size())))
+					return false;
 
-			if (!OnProgress())
-				return false;
+				vHeights.clear();
+				vOutputs.clear();
+
+				if (!OnProgress())
+					return false;
+			}
+
+			if (bEnd)
+				break;
 		}
 
 		return true;
@@ -625,6 +648,70 @@ namespace beam
 		return true;
 	}
 
+	bool RecoveryInfo::IParser::OnUtxos(const Height* pH, const Output::Ptr* pOutp, uint32_t nCount)
+	{
+		for (uint32_t i = 0; i < nCount; i++)
+			if (!OnUtxo(pH[i], *pOutp[i]))
+				return false;
+
+		return true;
+	}
+
+	bool RecoveryInfo::IRecognizer::OnUtxos(const Height* pH, const Output::Ptr* pOutp, uint32_t nCount)
+	{
+		Executor* pExec = Executor::s_pInstance;
+		if (!pExec || !m_pOwner || (nCount < 2))
+			return IParser::OnUtxos(pH, pOutp, nCount);
+
+		struct Recovered
+		{
+			CoinID m_Cid;
+			Output::User m_User;
+			bool m_Ok;
+		};
+
+		std::vector<Recovered> vRes(nCount);
+
+		struct Task
+			:public Executor::TaskSync
+		{
+			const Height* m_pH;
+			const Output::Ptr* m_pOutp;
+			Recovered* m_pRes;
+			uint32_t m_Count;
+			Key::IPKdf* m_pOwner;
+
+			void Exec(Executor::Context& ctx) override
+			{
+				uint32_t i0, nPortion;
+				ctx.get_Portion(i0, nPortion, m_Count);
+
+				for (uint32_t i = i0; i < i0 + nPortion; i++)
+				{
+					Recovered& x = m_pRes[i];
+					x.m_Ok = m_pOutp[i]->Recover(m_pH[i], *m_pOwner, x.m_Cid, &x.m_User);
+				}
+			}
+		} t;
+
+		t.m_pH = pH;
+		t.m_pOutp = pOutp;
+		t.m_pRes = &vRes.front();
+		t.m_Count = nCount;
+		t.m_pOwner = m_pOwner.get();
+
+		pExec->ExecAll(t);
+
+		for (uint32_t i = 0; i < nCount; i++)
+		{
+			Recovered& x = vRes[i];
+			if (x.m_Ok && !OnUtxoRecognized(pH[i], *pOutp[i], x.m_Cid, x.m_User))
+				return false;
+		}
+
+		return true;
+	}
+
 	bool RecoveryInfo::IRecognizer::OnShieldedOut(const ShieldedTxo::DescriptionOutp& dout, const ShieldedTxo& txo, const ECC::Hash::Value& hvMsg)
 	{
 		for (Key::Index nIdx = 0; nIdx < static_cast<Key::Index>(m_vSh.size()); nIdx++)
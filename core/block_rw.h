@@ -60,6 +60,8 @@ namespace beam
 			virtual bool OnProgress(uint64_t nPos, uint64_t nTotal) { return true; }
 			virtual bool OnStates(std::vector<Block::SystemState::Full>&) { return true; }
 			virtual bool OnUtxo(Height, const Output&) { return true; }
+			// Called for a batch of consecutive utxos. By default passes them to OnUtxo one-by-one
+			virtual bool OnUtxos(const Height*, const Output::Ptr*, uint32_t nCount);
 			virtual bool OnShieldedOut(const ShieldedTxo::DescriptionOutp& , const ShieldedTxo&, const ECC::Hash::Value& hvMsg) { return true; }
 			virtual bool OnShieldedIn(const ShieldedTxo::DescriptionInp&) { return true; }
 			virtual bool OnAsset(Asset::Full&) { return true; }
@@ -78,6 +80,9 @@ namespace beam
 			void Init(const Key::IPKdf::Ptr&, Key::Index nMaxShieldedIdx = 1);
 
 			virtual bool OnUtxo(Height, const Output&) override;
+			// If there's a current Executor (see Executor::Scope) the batch is recognized on all its threads,
+			// then OnUtxoRecognized is called in the original order, bypassing OnUtxo
+			virtual bool OnUtxos(const Height*, const Output::Ptr*, uint32_t nCount) override;
 			virtual bool OnShieldedOut(const ShieldedTxo::DescriptionOutp&, const ShieldedTxo&, const ECC::Hash::Value& hvMsg) override;
 			virtual bool OnAsset(Asset::Full&) override;
 
@@ -678,6 +678,15 @@ namespace ECC {
 		secp256k1_ge_to_storage(&ge_s, &ge);
 	}
 
+	void Point::Native::BatchNormalizer::get_As(Point& v, const Point::Native& ptNormalized)
+	{
+		secp256k1_ge ge;
+		get_As(ge, ptNormalized);
+		secp256k1_fe_normalize(&ge.x);
+		secp256k1_fe_normalize(&ge.y);
+		ExportEx(v, ge);
+	}
+
 	void Point::Native::BatchNormalizer_Arr::get_At(Element& el, uint32_t iIdx)
 	{
 		el.m_pPoint = m_pPts + iIdx;
@@ -1735,16 +1744,49 @@ namespace ECC {
 	bool g_bContextInitialized = false;
 #endif // NDEBUG
 
+	bool g_bContextEmbedded = false;
+
+#ifdef BEAM_ECC_EMBEDDED_TABLES
+	// generated at build time by ecc_tables_gen
+	extern const uint64_t g_pContextTables[];
+	extern const uint32_t g_nContextTables;
+#endif // BEAM_ECC_EMBEDDED_TABLES
+
 	const Context& Context::get()
 	{
 		assert(g_bContextInitialized);
 		return g_ContextBuf.get();
 	}
 
-	void InitializeContext()
+	bool Context::IsEmbedded()
 	{
-		Context& ctx = g_ContextBuf.get();
+		return g_bContextEmbedded;
+	}
+
+	bool Context::Load(Context& ctx, const void* p, uint32_t nSize)
+	{
+		if (sizeof(Context) != nSize)
+			return false;
 
+		memcpy(reinterpret_cast<void*>(&ctx), p, nSize);
+
+		// Cheap sanity check that the tables were generated for the same data layout: the first prepared G multiple must be G itself,
+		// and the stored scalar constant must be 1/2.
+		secp256k1_ge ge;
+		secp256k1_ge_from_storage(&ge, &ctx.m_Ipp.G_.m_Fast.m_pPt[0]);
+
+		Point pt0, pt1;
+		Point::Native::ExportEx(pt0, ge);
+		Point::Native::ExportEx(pt1, secp256k1_ge_const_g);
+
+		Scalar::Native k = ctx.m_Ipp.m_2Inv;
+		k += ctx.m_Ipp.m_2Inv;
+
+		return (pt0 == pt1) && (k == Scalar::Native(1U));
+	}
+
+	void Context::Derive(Context& ctx)
+	{
 		Mode::Scope scope(Mode::Fast);
 
 		Oracle oracle;
@@ -1840,6 +1882,17 @@ namespace ECC {
 		hpRes
 			<< uint32_t(2) // increment this each time we change signature formula (rangeproof and etc.)
 			>> ctx.m_hvChecksum;
+	}
+
+	void InitializeContext()
+	{
+		Context& ctx = g_ContextBuf.get();
+
+#ifdef BEAM_ECC_EMBEDDED_TABLES
+		g_bContextEmbedded = Context::Load(ctx, g_pContextTables, g_nContextTables);
+		if (!g_bContextEmbedded)
+#endif // BEAM_ECC_EMBEDDED_TABLES
+			Context::Derive(ctx);
 
 		ctx.m_Sig.m_GenG.m_pGen = &ctx.G;
 		ctx.m_Sig.m_GenG.m_pGenPrep = &ctx.m_Ipp.G_;
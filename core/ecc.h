@@ -348,6 +348,20 @@ namespace ECC
 
 		void Create(Oracle&, const Scalar::Native& dotAB, const Scalar::Native* pA, const Scalar::Native* pB, const Modifier& = Modifier());
 
+		struct BatchItem
+		{
+			InnerProduct* m_pRes;
+			Oracle* m_pOracle;
+			const Scalar::Native* m_pDotAB;
+			const Scalar::Native* m_pA;
+			const Scalar::Native* m_pB;
+			const Modifier* m_pMod;
+		};
+
+		// Creates several independent proofs at once. Equivalent to Create() per item, but the proofs are advanced in lockstep:
+		// the MultiMac buffers are shared, and L,R of all the proofs are normalized with a single inversion per cycle.
+		static void CreateBatch(const BatchItem*, uint32_t nCount);
+
 		struct Challenges;
 		bool IsValid(BatchContext&, Challenges&, const Scalar::Native& dotAB, const Modifier& = Modifier()) const;
 
@@ -416,6 +430,18 @@ namespace ECC
 			//			Means - the caller must take care of constructing the nonce, which has external randomness
 
 			void Create(const Scalar::Native& sk, const CreatorParams&, Oracle&, const Point::Native* pHGen = nullptr); // single-pass
+
+			struct BatchItem
+			{
+				Confidential* m_pRes;
+				const Scalar::Native* m_pSk;
+				const CreatorParams* m_pCp;
+				Oracle* m_pOracle;
+				const Point::Native* m_pHGen;
+			};
+
+			// single-pass, several independent proofs. Same as Create() per item, but the generator work and buffers are shared
+			static void CreateBatch(const BatchItem*, uint32_t nCount);
 			bool IsValid(const Point::Native&, Oracle&, const Point::Native* pHGen = nullptr) const;
 			bool IsValid(const Point::Native&, Oracle&, InnerProduct::BatchContext&, const Point::Native* pHGen = nullptr) const;
 
@@ -452,7 +478,8 @@ namespace ECC
 		private:
 			struct ChallengeSet;
 			struct Vectors;
-			static void CalcA(Point&, const Scalar::Native& alpha, Amount v);
+			struct Prover;
+			static void CalcA(Point::Native&, const Scalar::Native& alpha, Amount v);
 		};
 
 		struct Public
@@ -237,14 +237,54 @@ namespace ECC {
 
 		const Modifier& m_Mod;
 
-		MultiMac_WithBufs<(nDim >> (s_iCycle0 + 1)), nDim * 2> m_Mm;
+		typedef MultiMac_WithBufs<(nDim >> (s_iCycle0 + 1)), nDim * 2> Mm;
+		Mm& m_Mm; // may be shared by several calculators
 
 		uint32_t m_GenOrder;
 
 		void Condense();
 		void ExtractLR(int j);
 
-		Calculator(const Modifier& mod) :m_Mod(mod) {}
+		Calculator(const Modifier& mod, Mm& mm) :m_Mod(mod), m_Mm(mm) {}
+	};
+
+	struct PointBatchExport
+		:public Point::Native::BatchNormalizer_Arr
+	{
+		// exports several points with a single inversion
+		std::vector<Point::Native> m_vPts;
+		std::vector<secp256k1_fe> m_vFes;
+		std::vector<Point*> m_vTrg;
+
+		void Add(Point& trg, const Point::Native& pt)
+		{
+			if (pt == Zero)
+				ZeroObject(trg);
+			else
+			{
+				m_vPts.push_back(pt);
+				m_vTrg.push_back(&trg);
+			}
+		}
+
+		void Flush()
+		{
+			m_Size = static_cast<uint32_t>(m_vPts.size());
+			if (!m_Size)
+				return;
+
+			m_vFes.resize(m_Size);
+			m_pPts = &m_vPts.front();
+			m_pFes = &m_vFes.front();
+
+			Normalize();
+
+			for (uint32_t i = 0; i < m_Size; i++)
+				get_As(*m_vTrg[i], m_pPts[i]);
+
+			m_vPts.clear();
+			m_vTrg.clear();
+		}
 	};
 
 	void InnerProduct::Calculator::Condense()
@@ -404,7 +444,8 @@ namespace ECC {
 
 		assert(!mod.m_pAmbient); // supported only in verification mode
 
-		Calculator c(mod);
+		Calculator::Mm mm;
+		Calculator c(mod, mm);
 		c.m_GenOrder = nCycles;
 		c.m_ppSrc[0] = pA;
 		c.m_ppSrc[1] = pB;
@@ -450,6 +491,66 @@ namespace ECC {
 			m_pCondensed[i] = c.m_pVal[i][0];
 	}
 
+	void InnerProduct::CreateBatch(const BatchItem* pItems, uint32_t nCount)
+	{
+		Mode::Scope scope(Mode::Fast);
+
+		Calculator::Mm mm;
+
+		std::vector<Calculator> vCalc;
+		vCalc.reserve(nCount);
+
+		for (uint32_t i = 0; i < nCount; i++)
+		{
+			const BatchItem& x = pItems[i];
+			assert(!x.m_pMod->m_pAmbient);
+
+			vCalc.emplace_back(*x.m_pMod, mm);
+			Calculator& c = vCalc.back();
+
+			c.m_GenOrder = nCycles;
+			c.m_ppSrc[0] = x.m_pA;
+			c.m_ppSrc[1] = x.m_pB;
+
+			*x.m_pOracle << *x.m_pDotAB >> c.m_Cs.m_DotMultiplier;
+		}
+
+		PointBatchExport pbe;
+		Point::Native comm;
+
+		for (uint32_t iCycle = 0; iCycle < nCycles; iCycle++)
+		{
+			for (uint32_t i = 0; i < nCount; i++)
+			{
+				Calculator& c = vCalc[i];
+				c.m_iCycle = iCycle;
+				c.CycleStart(*pItems[i].m_pOracle);
+
+				for (int j = 0; j < 2; j++)
+				{
+					c.ExtractLR(j);
+
+					c.m_Mm.Calculate(comm);
+					pbe.Add(pItems[i].m_pRes->m_pLR[iCycle][j], comm);
+				}
+			}
+
+			pbe.Flush();
+
+			for (uint32_t i = 0; i < nCount; i++)
+			{
+				Calculator& c = vCalc[i];
+				c.CycleExpose(*pItems[i].m_pOracle, *pItems[i].m_pRes);
+				c.Condense();
+				c.CycleEnd();
+			}
+		}
+
+		for (uint32_t i = 0; i < nCount; i++)
+			for (int j = 0; j < 2; j++)
+				pItems[i].m_pRes->m_pCondensed[j] = vCalc[i].m_pVal[j][0];
+	}
+
 	bool InnerProduct::IsValid(const Point::Native& commAB, const Scalar::Native& dotAB, const Modifier& mod) const
 	{
 		if (BatchContext::s_pInstance)
@@ -719,135 +820,221 @@ namespace ECC {
 	};
 #pragma pack (pop)
 
-	bool RangeProof::Confidential::CoSign(const Nonces& nonces, const Scalar::Native& sk, const CreatorParams& cp, Oracle& oracle, Phase::Enum ePhase, const Point::Native* pHGen /* = nullptr */)
+	struct RangeProof::Confidential::Prover
 	{
-		NonceGeneratorBp nonceGen(cp.m_Seed.V);
+		const CreatorParams& m_Cp;
+
+		Scalar::Native m_Alpha, m_Ro;
+		Scalar::Native m_t0, m_t1, m_t2;
+		Scalar::Native m_tDot;
+
+		Vectors m_Vecs;
+		ChallengeSet m_Cs;
+
+		InnerProduct::Modifier::Channel m_Ch1;
+		InnerProduct::Modifier m_Mod;
+
+		Prover(const CreatorParams& cp) :m_Cp(cp) {}
+
+		void CalcPart1(Point::Native& ptA, Point::Native& ptS, MultiMac_WithBufs<1, InnerProduct::nDim * 2 + 1>&);
+		void CalcT(const Part1&, Oracle&);
+		void CalcPart2(const Nonces&, Point::Native& ptT1, Point::Native& ptT2, const Point::Native* pHGen) const;
+		void CalcPart3(Confidential&, const Nonces&, const Scalar::Native& sk, Oracle&, Phase::Enum);
+	};
+
+	void RangeProof::Confidential::Prover::CalcPart1(Point::Native& ptA, Point::Native& ptS, MultiMac_WithBufs<1, InnerProduct::nDim * 2 + 1>& mm)
+	{
+		NonceGeneratorBp nonceGen(m_Cp.m_Seed.V);
 
 		// A = G*alpha + vec(aL)*vec(G) + vec(aR)*vec(H)
-		Scalar::Native alpha, ro;
-		nonceGen >> alpha;
+		nonceGen >> m_Alpha;
 
 		// embed extra params into alpha
 		NoLeak<CreatorParams::Packed> cpp;
-		cpp.V.m_Value = cp.m_Value;
+		cpp.V.m_Value = m_Cp.m_Value;
 
-		cp.BlobSave(cpp.V.m_pUser, sizeof(cpp.V.m_pUser));
+		m_Cp.BlobSave(cpp.V.m_pUser, sizeof(cpp.V.m_pUser));
 
 		static_assert(sizeof(cpp) == sizeof(Scalar));
-        BEAM_VERIFY(!ro.Import((Scalar&) cpp.V)); // if overflow - the params won't be recovered properly, there may be ambiguity
+        BEAM_VERIFY(!m_Ro.Import((Scalar&) cpp.V)); // if overflow - the params won't be recovered properly, there may be ambiguity
 
-		alpha += ro;
+		m_Alpha += m_Ro;
 
-		CalcA(m_Part1.m_A, alpha, cp.m_Value);
+		CalcA(ptA, m_Alpha, m_Cp.m_Value);
 
 		// S = G*ro + vec(sL)*vec(G) + vec(sR)*vec(H)
-		nonceGen >> ro;
+		nonceGen >> m_Ro;
 
-		MultiMac_WithBufs<1, InnerProduct::nDim * 2 + 1> mm;
-		mm.m_pKPrep[mm.m_Prepared] = ro;
+		mm.Reset();
+		mm.m_pKPrep[mm.m_Prepared] = m_Ro;
 		mm.m_ppPrepared[mm.m_Prepared++] = &Context::get().m_Ipp.G_;
 
-		Vectors vecs;
-		vecs.Set(nonceGen);
+		m_Vecs.Set(nonceGen);
 
 		for (int j = 0; j < 2; j++)
 		{
-			if (cp.m_pExtra)
-				vecs.m_pS[j][0] += cp.m_pExtra[j];
+			if (m_Cp.m_pExtra)
+				m_Vecs.m_pS[j][0] += m_Cp.m_pExtra[j];
 
 			for (uint32_t i = 0; i < InnerProduct::nDim; i++)
 			{
-				mm.m_pKPrep[mm.m_Prepared] = vecs.m_pS[j][i];
+				mm.m_pKPrep[mm.m_Prepared] = m_Vecs.m_pS[j][i];
 				mm.m_ppPrepared[mm.m_Prepared++] = &Context::get().m_Ipp.m_pGen_[j][i];
 			}
 		}
 
-		Point::Native comm;
-		mm.Calculate(comm);
-
-		m_Part1.m_S = comm;
-
-		//if (Phase::Step1 == ePhase)
-		//	return; // stop after A,S calculated
+		mm.Calculate(ptS);
+	}
 
+	void RangeProof::Confidential::Prover::CalcT(const Part1& p1, Oracle& oracle)
+	{
 		// get challenges
-		ChallengeSet cs;
-		cs.Init1(m_Part1, oracle);
-		cs.SetZZ();
-		vecs.Set(cs);
+		m_Cs.Init1(p1, oracle);
+		m_Cs.SetZZ();
+		m_Vecs.Set(m_Cs);
 
 		// calculate t1, t2 - parts of vec(L)*vec(R) which depend on (future) x and x^2.
-		Scalar::Native t0(Zero), t1(Zero), t2(Zero);
+		m_t0 = Zero;
+		m_t1 = Zero;
+		m_t2 = Zero;
 
 		Scalar::Native l0, r0, rx, yPwr, zz_twoPwr;
 
-		yPwr = vecs.m_One;
-		zz_twoPwr = cs.zz;
+		yPwr = m_Vecs.m_One;
+		zz_twoPwr = m_Cs.zz;
 
 		for (uint32_t i = 0; i < InnerProduct::nDim; i++)
 		{
-			uint32_t bit = 1 & (cp.m_Value >> i);
+			uint32_t bit = 1 & (m_Cp.m_Value >> i);
 
 
-			const Scalar::Native& lx = vecs.m_pS[0][i];
+			const Scalar::Native& lx = m_Vecs.m_pS[0][i];
 
-			r0 = vecs.m_pZ[!bit];
+			r0 = m_Vecs.m_pZ[!bit];
 			r0 *= yPwr;
 			r0 += zz_twoPwr;
 
 			rx = yPwr;
-			rx *= vecs.m_pS[1][i];
+			rx *= m_Vecs.m_pS[1][i];
 
-			zz_twoPwr *= vecs.m_Two;
-			yPwr *= cs.y;
+			zz_twoPwr *= m_Vecs.m_Two;
+			yPwr *= m_Cs.y;
 
-			l0 = -vecs.m_pZ[bit];
-			t0 += l0 * r0;
-			t1 += l0 * rx;
-			t1 += lx * r0;
-			t2 += lx * rx;
+			l0 = -m_Vecs.m_pZ[bit];
+			m_t0 += l0 * r0;
+			m_t1 += l0 * rx;
+			m_t1 += lx * r0;
+			m_t2 += lx * rx;
 		}
+	}
 
-		if (Phase::Finalize != ePhase) // otherwise m_Part2 already contains the whole aggregate
+	void RangeProof::Confidential::Prover::CalcPart2(const Nonces& nonces, Point::Native& ptT1, Point::Native& ptT2, const Point::Native* pHGen) const
+	{
+		nonces.AddInfo1(ptT1, ptT2);
+
+		if (Tag::IsCustom(pHGen))
 		{
-			Point::Native comm2;
-			nonces.AddInfo1(comm, comm2);
+			// since we need 2 multiplications - prepare it explicitly.
+			MultiMac::Casual mc;
+			mc.Init(*pHGen);
+
+			MultiMac mm2;
+			mm2.m_pCasual = &mc;
+			mm2.m_Casual = 1;
+			Point::Native comm3;
+
+			mm2.m_pKCasual = Cast::NotConst(&m_t1);
+			mm2.Calculate(comm3);
+			ptT1 += comm3;
+
+			mm2.m_pKCasual = Cast::NotConst(&m_t2);
+			mm2.Calculate(comm3);
+			ptT2 += comm3;
+		}
+		else
+		{
+			ptT1 += Context::get().H_Big * m_t1;
+			ptT2 += Context::get().H_Big * m_t2;
+		}
+	}
 
-			if (Tag::IsCustom(pHGen))
-			{
-				// since we need 2 multiplications - prepare it explicitly.
-				MultiMac::Casual mc;
-				mc.Init(*pHGen);
-
-				MultiMac mm2;
-				mm2.m_pCasual = &mc;
-				mm2.m_Casual = 1;
-				Point::Native comm3;
-
-				mm2.m_pKCasual = &t1;
-				mm2.Calculate(comm3);
-				comm += comm3;
-
-				mm2.m_pKCasual = &t2;
-				mm2.Calculate(comm3);
-				comm2 += comm3;
-			}
-			else
-			{
-				comm += Context::get().H_Big * t1;
-				comm2 += Context::get().H_Big * t2;
-			}
+	void RangeProof::Confidential::Prover::CalcPart3(Confidential& res, const Nonces& nonces, const Scalar::Native& sk, Oracle& oracle, Phase::Enum ePhase)
+	{
+		m_Cs.Init2(res.m_Part2, oracle); // get challenge 
+
+		// m_TauX = tau2*x^2 + tau1*x + sk*z^2
+		Scalar::Native l0, r0;
+		nonces.AddInfo2(l0, sk, m_Cs);
+
+		if (Phase::SinglePass != ePhase)
+			l0 += res.m_Part3.m_TauX;
+
+		res.m_Part3.m_TauX = l0;
+
+		// m_Mu = alpha + ro*x
+		l0 = m_Ro;
+		l0 *= m_Cs.x;
+		l0 += m_Alpha;
+		res.m_Mu = l0;
+
+		// m_tDot
+		l0 = m_t0;
+
+		r0 = m_t1;
+		r0 *= m_Cs.x;
+		l0 += r0;
+
+		r0 = m_t2;
+		r0 *= m_Cs.x;
+		r0 *= m_Cs.x;
+		l0 += r0;
+
+		m_tDot = l0;
+		res.m_tDot = l0;
+
+		// construct vectors l,r, use buffers pS
+		// P - m_Mu*G
+		m_Vecs.ToLR(m_Cs, m_Cp.m_Value);
+
+		Scalar::Native& yInv = m_Alpha; // alias
+		yInv.SetInv(m_Cs.y);
+
+		m_Ch1.SetPwr(yInv);
+		m_Mod.m_ppC[1] = &m_Ch1;
+	}
+
+	bool RangeProof::Confidential::CoSign(const Nonces& nonces, const Scalar::Native& sk, const CreatorParams& cp, Oracle& oracle, Phase::Enum ePhase, const Point::Native* pHGen /* = nullptr */)
+	{
+		Prover p(cp);
+
+		Point::Native comm, comm2;
+		{
+			MultiMac_WithBufs<1, InnerProduct::nDim * 2 + 1> mm;
+			p.CalcPart1(comm2, comm, mm);
+		}
+
+		m_Part1.m_A = comm2;
+		m_Part1.m_S = comm;
+
+		//if (Phase::Step1 == ePhase)
+		//	return; // stop after A,S calculated
+
+		p.CalcT(m_Part1, oracle);
+
+		if (Phase::Finalize != ePhase) // otherwise m_Part2 already contains the whole aggregate
+		{
+			p.CalcPart2(nonces, comm, comm2, pHGen);
 
 			if (Phase::SinglePass != ePhase)
 			{
-				Point::Native p;
-				if (!p.Import(m_Part2.m_T1))
+				Point::Native pt;
+				if (!pt.Import(m_Part2.m_T1))
 					return false;
-				comm += p;
+				comm += pt;
 
-				if (!p.Import(m_Part2.m_T2))
+				if (!pt.Import(m_Part2.m_T2))
 					return false;
-				comm2 += p;
+				comm2 += pt;
 			}
 
 			m_Part2.m_T1 = comm;
@@ -857,56 +1044,84 @@ namespace ECC {
 		if (Phase::Step2 == ePhase)
 			return true; // stop after T1,T2 calculated
 
-		cs.Init2(m_Part2, oracle); // get challenge 
+		p.CalcPart3(*this, nonces, sk, oracle, ePhase);
 
-		// m_TauX = tau2*x^2 + tau1*x + sk*z^2
-		nonces.AddInfo2(l0, sk, cs);
+		m_P_Tag.Create(oracle, p.m_tDot, p.m_Vecs.m_pS[0], p.m_Vecs.m_pS[1], p.m_Mod);
 
-		if (Phase::SinglePass != ePhase)
-			l0 += m_Part3.m_TauX;
+		return true;
+	}
 
-		m_Part3.m_TauX = l0;
+	void RangeProof::Confidential::CreateBatch(const BatchItem* pItems, uint32_t nCount)
+	{
+		// All the proofs are advanced in lockstep, so that the points exposed to the oracles at each stage are normalized at once
+		std::vector<Prover> vP;
+		vP.reserve(nCount);
 
-		// m_Mu = alpha + ro*x
-		l0 = ro;
-		l0 *= cs.x;
-		l0 += alpha;
-		m_Mu = l0;
+		std::vector<Nonces> vNonces(nCount);
+		PointBatchExport pbe;
 
-		// m_tDot
-		l0 = t0;
+		{
+			MultiMac_WithBufs<1, InnerProduct::nDim * 2 + 1> mm;
+			Point::Native ptA, ptS;
 
-		r0 = t1;
-		r0 *= cs.x;
-		l0 += r0;
+			for (uint32_t i = 0; i < nCount; i++)
+			{
+				const BatchItem& x = pItems[i];
 
-		r0 = t2;
-		r0 *= cs.x;
-		r0 *= cs.x;
-		l0 += r0;
+				NoLeak<uintBig> seedSk;
+				GenerateSeed(seedSk.V, *x.m_pSk, x.m_pCp->m_Value, *x.m_pOracle);
+				vNonces[i].Init(seedSk.V);
 
-		m_tDot = l0;
+				vP.emplace_back(*x.m_pCp);
+				vP.back().CalcPart1(ptA, ptS, mm);
 
-		// construct vectors l,r, use buffers pS
-		// P - m_Mu*G
-		vecs.ToLR(cs, cp.m_Value);
+				pbe.Add(x.m_pRes->m_Part1.m_A, ptA);
+				pbe.Add(x.m_pRes->m_Part1.m_S, ptS);
+			}
 
-		Scalar::Native& yInv = alpha; // alias
-		yInv.SetInv(cs.y);
+			pbe.Flush();
+		}
 
-		InnerProduct::Modifier::Channel ch1;
-		ch1.SetPwr(yInv);
-		InnerProduct::Modifier mod;
-		mod.m_ppC[1] = &ch1;
+		Point::Native ptT1, ptT2;
 
-		m_P_Tag.Create(oracle, l0, vecs.m_pS[0], vecs.m_pS[1], mod);
+		for (uint32_t i = 0; i < nCount; i++)
+		{
+			const BatchItem& x = pItems[i];
+			Prover& p = vP[i];
 
-		return true;
+			p.CalcT(x.m_pRes->m_Part1, *x.m_pOracle);
+			p.CalcPart2(vNonces[i], ptT1, ptT2, x.m_pHGen);
+
+			pbe.Add(x.m_pRes->m_Part2.m_T1, ptT1);
+			pbe.Add(x.m_pRes->m_Part2.m_T2, ptT2);
+		}
+
+		pbe.Flush();
+
+		std::vector<InnerProduct::BatchItem> vIp(nCount);
+
+		for (uint32_t i = 0; i < nCount; i++)
+		{
+			const BatchItem& x = pItems[i];
+			Prover& p = vP[i];
+
+			p.CalcPart3(*x.m_pRes, vNonces[i], *x.m_pSk, *x.m_pOracle, Phase::SinglePass);
+
+			InnerProduct::BatchItem& ip = vIp[i];
+			ip.m_pRes = &x.m_pRes->m_P_Tag;
+			ip.m_pOracle = x.m_pOracle;
+			ip.m_pDotAB = &p.m_tDot;
+			ip.m_pA = p.m_Vecs.m_pS[0];
+			ip.m_pB = p.m_Vecs.m_pS[1];
+			ip.m_pMod = &p.m_Mod;
+		}
+
+		InnerProduct::CreateBatch(&vIp.front(), nCount);
 	}
 
-	void RangeProof::Confidential::CalcA(Point& res, const Scalar::Native& alpha, Amount v)
+	void RangeProof::Confidential::CalcA(Point::Native& res, const Scalar::Native& alpha, Amount v)
 	{
-		Point::Native comm = Context::get().G * alpha;
+		res = Context::get().G * alpha;
 
 		{
 			NoLeak<Point::Compact> ge_s;
@@ -919,13 +1134,10 @@ namespace ECC {
 				object_cmov(ge_s.V, Context::get().m_Ipp.m_pGet1_Minus[i], 0 == iBit);
 				object_cmov(ge_s.V, Context::get().m_Ipp.m_pGen_[0][i].m_Fast.m_pPt[0], 1 == iBit);
 
-				comm += ge_s.V;
+				res += ge_s.V;
 			}
 		}
-
-		res = comm;
 	}
-
 	bool RangeProof::Confidential::Recover(Oracle& oracle, CreatorParams& cp) const
 	{
 		NonceGeneratorBp nonceGen(cp.m_Seed.V);
@@ -962,10 +1174,10 @@ namespace ECC {
 		// Calculate m_Part1.m_A, which depends on alpha and the value.
 
 		alpha_minus_params += params; // just alpha
-		Point ptA;
+		Point::Native ptA;
 		CalcA(ptA, alpha_minus_params, cp.m_Value);
 
-		if (ptA != m_Part1.m_A)
+		if (!(ptA == m_Part1.m_A))
 			return false; // the probability of false positive should be negligible
 
 		bool bRecoverSk = (cp.m_pSeedSk && cp.m_pSk);
@@ -0,0 +1,58 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Build-time tool: derives the ECC context and writes its raw image as a C++ source (see BEAM_ECC_EMBEDDED_TABLES).
+
+#include "ecc_native.h"
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+	using namespace ECC;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "Usage: %s <output file>\n", argv[0]);
+		return 1;
+	}
+
+	const uint32_t nSize = sizeof(Context);
+	const uint32_t nWords = (nSize + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	std::vector<uint64_t> vBuf(nWords); // zero-initialized, so that the image is deterministic
+	Context::Derive(*reinterpret_cast<Context*>(&vBuf.front()));
+
+	FILE* pF = fopen(argv[1], "w");
+	if (!pF)
+	{
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return 1;
+	}
+
+	fprintf(pF, "// Generated by ecc_tables_gen, do not edit\n\n#include <cstdint>\n\nnamespace ECC {\n\n");
+	fprintf(pF, "\textern const uint32_t g_nContextTables = %u;\n\n", nSize);
+	fprintf(pF, "\textern const uint64_t g_pContextTables[] = {\n");
+
+	for (uint32_t i = 0; i < nWords; i++)
+		fprintf(pF, ((i & 7) == 7) ? "0x%016" PRIx64 "ULL,\n" : "0x%016" PRIx64 "ULL,", vBuf[i]);
+
+	fprintf(pF, "\n\t};\n\n} // namespace ECC\n");
+
+	bool bOk = !ferror(pF);
+	fclose(pF);
+
+	return bOk ? 0 : 1;
+}
@@ -101,11 +101,7 @@ void FlyClient::NetworkStd::Connection::ResetInternal()
         m_This.OnNodeConnected(false);
 
     while (!m_lst.empty())
-    {
-        RequestNode& n = m_lst.front();
-        m_lst.pop_front();
-        m_This.m_lst.push_back(n);
-    }
+        ReturnRequest(m_lst.front());
 }
 
 void FlyClient::NetworkStd::Connection::OnConnectedSecure()
@@ -597,8 +593,172 @@ bool FlyClient::NetworkStd::Connection::IsAtTip() const
     return m_This.m_Client.get_History().get_Tip(sTip) && (sTip == m_Tip);
 }
 
+namespace {
+
+	// Utxo/Kernel requests pending at the same time are sent in a single batched request, whose results are split back
+	struct RequestBatch
+		:public FlyClient::Request::IHandler
+	{
+		std::vector<FlyClient::Request::Ptr> m_vReqs;
+
+		void Unbundle(FlyClient::NetworkStd::RequestList& lst)
+		{
+			for (const auto& pReq : m_vReqs)
+				if (pReq->m_pTrg)
+					lst.Create_back()->m_pRequest = pReq;
+
+			m_vReqs.clear();
+		}
+	};
+
+	struct RequestUtxoBatch
+		:public FlyClient::RequestUtxoMulti
+		,public RequestBatch
+	{
+		typedef FlyClient::RequestUtxo Item;
+		static const FlyClient::Request::Type s_ItemType = FlyClient::Request::Type::Utxo;
+
+		static bool ShouldAdd(const Item& r) { return !r.m_Msg.m_MaturityMin; }
+		size_t get_Count() const { return m_Msg.m_Utxos.size(); }
+
+		void Add(Item& r)
+		{
+			m_Msg.m_Utxos.push_back(r.m_Msg.m_Utxo);
+			m_vReqs.emplace_back(&r);
+		}
+
+		virtual void OnComplete(FlyClient::Request&) override
+		{
+			// proofs are already verified and complete
+			for (size_t i = 0; i < m_vReqs.size(); i++)
+			{
+				Item& r = Cast::Up<Item>(*m_vReqs[i]);
+				if (r.m_pTrg)
+				{
+					r.m_Res.m_Proofs.swap(m_Res.m_Proofs[i]);
+					r.m_pTrg->OnComplete(r);
+				}
+			}
+		}
+	};
+
+	struct RequestKernelBatch
+		:public FlyClient::RequestKernelMulti
+		,public RequestBatch
+	{
+		typedef FlyClient::RequestKernel Item;
+		static const FlyClient::Request::Type s_ItemType = FlyClient::Request::Type::Kernel;
+
+		static bool ShouldAdd(const Item&) { return true; }
+		size_t get_Count() const { return m_Msg.m_IDs.size(); }
+
+		void Add(Item& r)
+		{
+			m_Msg.m_IDs.push_back(r.m_Msg.m_ID);
+			m_vReqs.emplace_back(&r);
+		}
+
+		virtual void OnComplete(FlyClient::Request&) override
+		{
+			for (size_t i = 0; i < m_vReqs.size(); i++)
+			{
+				Item& r = Cast::Up<Item>(*m_vReqs[i]);
+				if (r.m_pTrg)
+				{
+					r.m_Res.m_Proof = std::move(m_Res.m_Proofs[i]);
+					r.m_pTrg->OnComplete(r);
+				}
+			}
+		}
+	};
+
+	template <typename TBatch>
+	void CreateBatchesOf(FlyClient::NetworkStd::RequestList& lst)
+	{
+		typedef typename TBatch::Item Item;
+
+		while (true)
+		{
+			boost::intrusive_ptr<TBatch> pBatch;
+			FlyClient::NetworkStd::RequestNode* pFirst = nullptr;
+
+			for (auto it = lst.begin(); lst.end() != it; )
+			{
+				FlyClient::NetworkStd::RequestNode& n = *it++;
+				assert(n.m_pRequest);
+
+				if (!n.m_pRequest->m_pTrg || (TBatch::s_ItemType != n.m_pRequest->get_Type()))
+					continue;
+
+				Item& r = Cast::Up<Item>(*n.m_pRequest);
+				if (!TBatch::ShouldAdd(r))
+					continue;
+
+				if (!pFirst)
+				{
+					pFirst = &n; // don't batch a single request
+					continue;
+				}
+
+				if (!pBatch)
+				{
+					pBatch.reset(new TBatch);
+					pBatch->Add(Cast::Up<Item>(*pFirst->m_pRequest));
+					lst.Delete(*pFirst);
+				}
+
+				pBatch->Add(r);
+				lst.Delete(n);
+
+				if (pBatch->get_Count() >= proto::g_ProofsMultiMaxCount)
+					break;
+			}
+
+			if (!pBatch)
+				break;
+
+			pBatch->m_pTrg = pBatch.get();
+			lst.Create_back()->m_pRequest = pBatch;
+		}
+	}
+
+} // namespace
+
+bool FlyClient::NetworkStd::Connection::IsSupportedMulti() const
+{
+	return (Flags::Node & m_Flags) && IsAtTip() && (LoginFlags::Extension::get(m_LoginFlags) >= 9);
+}
+
+void FlyClient::NetworkStd::Connection::CreateBatches()
+{
+	if (!IsSupportedMulti())
+		return;
+
+	CreateBatchesOf<RequestUtxoBatch>(m_This.m_lst);
+	CreateBatchesOf<RequestKernelBatch>(m_This.m_lst);
+}
+
+void FlyClient::NetworkStd::Connection::ReturnRequest(RequestNode& n)
+{
+	m_lst.erase(RequestList::s_iterator_to(n));
+
+	assert(n.m_pRequest);
+	RequestBatch* pBatch = dynamic_cast<RequestBatch*>(n.m_pRequest->m_pTrg);
+	if (pBatch)
+	{
+		// the next node may not support it
+		pBatch->Unbundle(m_This.m_lst);
+		n.m_pRequest->m_pTrg = nullptr;
+		m_This.m_lst.Delete(n);
+	}
+	else
+		m_This.m_lst.push_back(n);
+}
+
 void FlyClient::NetworkStd::Connection::AssignRequests()
 {
+    CreateBatches();
+
     for (RequestList::iterator it = m_This.m_lst.begin(); m_This.m_lst.end() != it; )
         AssignRequest(*it++);
 
@@ -688,6 +848,59 @@ void FlyClient::NetworkStd::Connection::OnRequestData(RequestUtxo& req)
             ThrowUnexpected();
 }
 
+bool FlyClient::NetworkStd::Connection::IsSupported(RequestUtxoMulti& req)
+{
+    return IsSupportedMulti();
+}
+
+void FlyClient::NetworkStd::Connection::OnRequestData(RequestUtxoMulti& req)
+{
+    if (req.m_Res.m_Proofs.size() != req.m_Msg.m_Utxos.size())
+        ThrowUnexpected();
+
+    const Merkle::Proof& suffix = req.m_Res.m_Suffix;
+
+    for (size_t i = 0; i < req.m_Res.m_Proofs.size(); i++)
+    {
+        for (Input::Proof& p : req.m_Res.m_Proofs[i])
+        {
+            p.m_Proof.insert(p.m_Proof.end(), suffix.begin(), suffix.end());
+            if (!m_Tip.IsValidProofUtxo(req.m_Msg.m_Utxos[i], p))
+                ThrowUnexpected();
+        }
+    }
+
+    req.m_Res.m_Suffix.clear();
+}
+
+bool FlyClient::NetworkStd::Connection::IsSupported(RequestKernelMulti& req)
+{
+    return IsSupportedMulti();
+}
+
+void FlyClient::NetworkStd::Connection::OnRequestData(RequestKernelMulti& req)
+{
+    if (req.m_Res.m_Proofs.size() != req.m_Msg.m_IDs.size())
+        ThrowUnexpected();
+
+    const Merkle::HardProof& suffix = req.m_Res.m_Suffix;
+
+    for (size_t i = 0; i < req.m_Res.m_Proofs.size(); i++)
+    {
+        TxKernel::LongProof& p = req.m_Res.m_Proofs[i];
+        if (p.empty())
+            continue;
+
+        if (p.m_State.m_Height < m_Tip.m_Height)
+            p.m_Outer.insert(p.m_Outer.end(), suffix.begin(), suffix.end());
+
+        if (!m_Tip.IsValidProofKernel(req.m_Msg.m_IDs[i], p))
+            ThrowUnexpected();
+    }
+
+    req.m_Res.m_Suffix.clear();
+}
+
 bool FlyClient::NetworkStd::Connection::IsSupported(RequestKernel& req)
 {
     return (Flags::Node & m_Flags) && IsAtTip();
@@ -976,8 +1189,7 @@ void FlyClient::NetworkStd::Connection::OnFirstRequestDone(bool bStillSupported)
         if (!bStillSupported)
         {
             // should retry
-            m_lst.erase(RequestList::s_iterator_to(n));
-            m_This.m_lst.push_back(n);
+            ReturnRequest(n);
             m_This.OnNewRequests();
             return;
         }
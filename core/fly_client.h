@@ -42,7 +42,9 @@ namespace proto {
 	{
 #define REQUEST_TYPES_All(macro) \
 		macro(Utxo,              GetProofUtxo,         ProofUtxo) \
+		macro(UtxoMulti,         GetProofUtxoMulti,    ProofUtxoMulti) \
 		macro(Kernel,            GetProofKernel,       ProofKernel) \
+		macro(KernelMulti,       GetProofKernelMulti,  ProofKernelMulti) \
 		macro(Kernel2,           GetProofKernel2,      ProofKernel2) \
 		macro(Events,            GetEvents,            Events) \
 		macro(Transaction,       NewTransaction,       Status) \
@@ -192,6 +194,9 @@ namespace proto {
 				void PrioritizeSelf();
 				Request& get_FirstRequestStrict(Request::Type);
 				void OnFirstRequestDone(bool bStillSupported);
+				void ReturnRequest(RequestNode&); // back to idle, batches are split
+				bool IsSupportedMulti() const;
+				void CreateBatches();
 
 				io::Timer::Ptr m_pTimer;
 				void OnTimer();
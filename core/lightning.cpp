@@ -18,6 +18,7 @@
 
 namespace {
 const beam::Height kPostLockReserveLag = 5;
+const beam::Height kIdleQueriesPerLockTime = 4;
 }  // namespace
 namespace beam {
 namespace Lightning {
@@ -547,6 +548,28 @@ void Channel::Update()
 	}
 }
 
+Height Channel::get_NextUpdate() const
+{
+	Height hTip = get_Tip();
+	if (m_pRequest || m_pPendingTx || (State::Open != get_State()))
+		return hTip;
+
+	const DataUpdate& d = m_lstUpdates.back();
+	if (DataUpdate::Type::Direct == d.m_Type)
+		return hTip;
+
+	// Idle channel. The msig should be queried often enough to react on the unilateral withdrawal before its lock expires,
+	// and the channel must be auto-closed before the most recent revision expires
+	Height h = m_State.m_hQueryLast + std::max<Height>(m_Params.m_hLockTime / kIdleQueriesPerLockTime, 1);
+
+	const HeightRange* pHR = d.get_HR();
+	assert(pHR); // otherwise the state would be Updating
+	Height hAutoClose = pHR->m_Max - m_Params.m_hPostLockReserve;
+	hAutoClose = (hAutoClose > kPostLockReserveLag) ? (hAutoClose - kPostLockReserveLag) : 0;
+
+	return std::min(h, hAutoClose);
+}
+
 Channel::DataUpdate* Channel::SelectWithdrawalPath()
 {
 	// Select the termination path. Note: it may not be the most recent, because it may (theoretically) be not ready yet.
@@ -214,6 +214,7 @@ namespace Lightning {
 		void Forget(); // If the channel didn't open - the locked inputs will are unlocked
 
 		bool IsNegotiating() const { return m_pNegCtx != nullptr; }
+		Height get_NextUpdate() const; // the height at which Update() is needed, assuming no peer data or rollbacks. Tip or below means immediately
 
 		virtual ~Channel();
 		virtual Height get_Tip() const = 0;
@@ -17,6 +17,7 @@
 #include "core/ecc_native.h"
 #include "proto.h"
 #include "../utility/logger.h"
+#include "../utility/lz_codec.h"
 
 namespace beam {
 namespace proto {
@@ -245,6 +246,59 @@ bool Bbs::Decrypt(uint8_t*& p, uint32_t& n, const ECC::Scalar::Native& privateAd
     return (hvMac == hvMac2);
 }
 
+bool Bbs::Decryptor::Init(const uint8_t* p, uint32_t n)
+{
+    PeerID remotePublic;
+    if (n < remotePublic.nBytes + ECC::Hash::Value::nBytes)
+        return false;
+
+    memcpy(remotePublic.m_pData, p, remotePublic.nBytes);
+    if (!remotePublic.ExportNnz(m_ptNonce))
+        return false;
+
+    m_p = p + remotePublic.nBytes;
+    m_n = n - remotePublic.nBytes;
+    return true;
+}
+
+void Bbs::Decryptor::get_Secret(ECC::Hash::Value& hvSecret, const ECC::Scalar::Native& privateAddr) const
+{
+    ECC::Point::Native ptSecret = m_ptNonce * privateAddr;
+    ECC::Hash::Processor() << ptSecret >> hvSecret;
+}
+
+bool Bbs::Decryptor::Decrypt(ByteBuffer& res, const ECC::Hash::Value& hvSecret, const PeerID& publicAddr) const
+{
+    AES::Encoder enc;
+    enc.Init(hvSecret.m_pData);
+
+    ECC::Hash::Mac hmac;
+    hmac.Reset(hvSecret.m_pData, hvSecret.nBytes);
+
+    AES::StreamCipher cIn;
+    InitCipherIV(cIn, hvSecret, publicAddr);
+
+    ECC::Hash::Value hvMac, hvMac2;
+    memcpy(hvMac.m_pData, m_p, hvMac.nBytes);
+    cIn.XCrypt(enc, hvMac.m_pData, hvMac.nBytes);
+
+    res.assign(m_p + hvMac.nBytes, m_p + m_n);
+    if (!res.empty())
+        cIn.XCrypt(enc, &res.front(), static_cast<uint32_t>(res.size()));
+
+    hmac.Write(res.data(), static_cast<uint32_t>(res.size()));
+    hmac >> hvMac2;
+
+    return (hvMac == hvMac2);
+}
+
+bool Bbs::Decryptor::Decrypt(ByteBuffer& res, const ECC::Scalar::Native& privateAddr, const PeerID& publicAddr) const
+{
+    ECC::NoLeak<ECC::Hash::Value> hvSecret;
+    get_Secret(hvSecret.V, privateAddr);
+    return Decrypt(res, hvSecret.V, publicAddr);
+}
+
 void Bbs::get_HashPartial(ECC::Hash::Processor& hp, const BbsMsg& msg)
 {
 	hp
@@ -300,7 +354,7 @@ NodeConnection::NodeConnection()
 	,m_RulesCfgSent(false)
 {
 #define THE_MACRO(code, msg) \
-    m_Protocol.add_message_handler<NodeConnection, msg##_NoInit, &NodeConnection::OnMsgInternal>(uint8_t(code), this, 0, 1024*1024*10);
+    m_Protocol.add_message_handler<NodeConnection, msg##_NoInit, &NodeConnection::OnMsgInternal>(uint8_t(code), this, 0, g_MsgMaxSize);
 
     BeamNodeMsgsAll(THE_MACRO)
 #undef THE_MACRO
@@ -320,6 +374,12 @@ void NodeConnection::Reset()
     }
 
 	m_RulesCfgSent = false;
+    m_CompressOut = false;
+
+    if (m_Connection && m_nPending)
+        m_Connection->flush(); // best effort
+    m_nPending = 0;
+
     m_Connection = NULL;
     m_pAsyncFail = NULL;
 
@@ -419,7 +479,52 @@ void NodeConnection::OnIoErr(io::ErrorCode err)
 
 size_t NodeConnection::get_Unsent() const
 {
-	return m_Connection ? m_Connection->get_Unsent() : 0;
+	return m_Connection ? (m_Connection->get_Unsent() + m_nPending) : 0;
+}
+
+void NodeConnection::WriteCached()
+{
+    size_t nSize = 0;
+    for (const auto& buf : m_SerializeCache)
+        nSize += buf.size;
+
+    io::Result res = m_Connection->write_msg(m_SerializeCache, false);
+    m_SerializeCache.clear();
+
+    TestIoResultAsync(res);
+    if (!res)
+        return;
+
+    bool bFirst = !m_nPending;
+    m_nPending += nSize;
+
+    if (m_nPending >= s_PendingMax)
+        FlushPending();
+    else
+    {
+        if (bFirst)
+        {
+            if (!m_pFlush)
+                m_pFlush = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { FlushPending(); });
+
+            m_pFlush->post();
+        }
+
+        TestNotDrown();
+    }
+}
+
+void NodeConnection::FlushPending()
+{
+    if (!m_nPending)
+        return;
+    m_nPending = 0;
+
+    if (m_Connection)
+    {
+        TestIoResultAsync(m_Connection->flush());
+        TestNotDrown();
+    }
 }
 
 void NodeConnection::on_protocol_error(uint64_t, ProtocolError error)
@@ -518,19 +623,76 @@ bool NodeConnection::IsLive() const
     return m_Connection && !m_pAsyncFail;
 }
 
+uint32_t NodeConnection::get_CompressThreshold(uint8_t nCode)
+{
+    switch (nCode)
+    {
+    case HdrPack::s_Code:
+    case ContractVars::s_Code:
+        return 1024;
+
+    case BodyPack::s_Code:
+    case ShieldedList::s_Code:
+        return 1024 * 4;
+    }
+
+    return 0;
+}
+
+template <typename T>
+bool NodeConnection::SendCompressed(const T& v)
+{
+    uint32_t nThreshold = get_CompressThreshold(T::s_Code);
+    if (!nThreshold || !m_CompressOut)
+        return false;
+
+    Serializer ser;
+    ser & v;
+    SerializeBuffer sb = ser.buffer();
+
+    if (sb.second < nThreshold)
+        return false;
+
+    // must save at least 1/8, otherwise send it as-is
+    Compressed msg;
+    msg.m_Data.resize(sb.second - sb.second / 8);
+
+    size_t nSize = LzCodec::Compress(&msg.m_Data.front(), msg.m_Data.size(), reinterpret_cast<const uint8_t*>(sb.first), sb.second);
+    if (!nSize)
+        return false;
+
+    msg.m_Data.resize(nSize);
+    msg.m_Code = T::s_Code;
+    msg.m_Size = static_cast<uint32_t>(sb.second);
+
+    Send(msg);
+    return true;
+}
+
+bool NodeConnection::OnMsg2(Compressed&& msg)
+{
+    if (!get_CompressThreshold(msg.m_Code) || (msg.m_Size > g_MsgMaxSize))
+        ThrowUnexpected();
+
+    ByteBuffer buf(msg.m_Size);
+    if (!LzCodec::Decompress(buf.empty() ? nullptr : &buf.front(), buf.size(), msg.m_Data.empty() ? nullptr : &msg.m_Data.front(), msg.m_Data.size()))
+        ThrowUnexpected("decompression");
+
+    // dispatch as if it was received directly
+    return m_Protocol.on_new_message(uint64_t(this), msg.m_Code, buf.empty() ? nullptr : &buf.front(), buf.size());
+}
+
 #define THE_MACRO(code, msg) \
 void NodeConnection::Send(const msg& v) \
 { \
     if (!IsLive()) \
         return; \
+    if (SendCompressed(v)) \
+        return; \
     m_SerializeCache.clear(); \
     MsgSerializer& ser = m_Protocol.serializeNoFinalize(m_SerializeCache, uint8_t(code), v); \
     m_Protocol.Encrypt(m_SerializeCache, ser); \
-    io::Result res = m_Connection->write_msg(m_SerializeCache); \
-    m_SerializeCache.clear(); \
-\
-    TestIoResultAsync(res); \
-    TestNotDrown(); \
+    WriteCached(); \
 } \
 \
 bool NodeConnection::OnMsgInternal(uint64_t, msg##_NoInit&& v) \
@@ -751,6 +913,8 @@ void NodeConnection::OnLoginInternal(Login&& msg)
             ThrowUnexpected("Legacy", NodeProcessingException::Type::Incompatible);
     }
 
+    m_CompressOut = (nExt >= 10);
+
 	OnLogin(std::move(msg));
 }
 
@@ -0,0 +1,511 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Crypto micro-benchmarks: MultiMac, inner product, bulletproofs, lelantus, signatures, oracle.
+//
+// usage: ecc_bench [--json] [--filter substr] [--reps N] [--time ms] [--threads N]
+//
+// Each benchmark is warmed up, then measured in N repetitions (samples) within the time budget. The reported
+// times are per operation (i.e. per proof for the batched variants), percentiles are over the samples.
+// Threads are used only by the lelantus prover (0 = single-threaded, no executor).
+
+#include "../ecc_native.h"
+#include "../block_crypt.h"
+#include "../lelantus.h"
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ECC {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool g_Json = false;
+const char* g_szFilter = nullptr;
+uint32_t g_Reps = 10;
+uint32_t g_Time_ms = 1000; // per benchmark, excluding warmup
+uint32_t g_Warmup_ms = 100;
+uint32_t g_Threads = 0;
+
+const uint32_t g_MinReps = 3;
+
+struct Result
+{
+	std::string m_Name;
+	uint32_t m_Batch;
+	uint32_t m_Reps;
+	uint64_t m_Ops;
+	double m_pUs[5]; // min, p10, median, p90, max
+};
+
+std::vector<Result> g_Results;
+
+double get_Elapsed_us(Clock::time_point t0)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+double get_Percentile(const std::vector<double>& v, double p)
+{
+	// v is sorted. Nearest-rank
+	size_t i = static_cast<size_t>(p * (v.size() - 1) + 0.5);
+	return v[std::min(i, v.size() - 1)];
+}
+
+// fn performs nBatch operations
+void Run(const std::string& sName, uint32_t nBatch, const std::function<void()>& fn)
+{
+	if (g_szFilter && (sName.find(g_szFilter) == std::string::npos))
+		return;
+
+	// warmup, also estimates the call time
+	uint32_t nCalls = 0;
+	Clock::time_point t0 = Clock::now();
+	double dt_us;
+	do
+	{
+		fn();
+		nCalls++;
+		dt_us = get_Elapsed_us(t0);
+	} while (dt_us < g_Warmup_ms * 1e3);
+
+	double tCall_us = dt_us / nCalls;
+
+	uint32_t nReps = g_Reps;
+	double tSample_us = g_Time_ms * 1e3 / nReps;
+
+	if (tCall_us > tSample_us)
+	{
+		// slow op, 1 call per sample. Don't exceed the time budget by much
+		nReps = std::max(g_MinReps, std::min(nReps, static_cast<uint32_t>(g_Time_ms * 1e3 / tCall_us)));
+		tSample_us = tCall_us;
+	}
+
+	uint32_t nCallsPerSample = std::max(1U, static_cast<uint32_t>(tSample_us / tCall_us));
+
+	std::vector<double> vSamples;
+	vSamples.reserve(nReps);
+
+	for (uint32_t iRep = 0; iRep < nReps; iRep++)
+	{
+		t0 = Clock::now();
+		for (uint32_t i = 0; i < nCallsPerSample; i++)
+			fn();
+
+		vSamples.push_back(get_Elapsed_us(t0) / (double(nCallsPerSample) * nBatch));
+	}
+
+	std::sort(vSamples.begin(), vSamples.end());
+
+	Result res;
+	res.m_Name = sName;
+	res.m_Batch = nBatch;
+	res.m_Reps = nReps;
+	res.m_Ops = uint64_t(nReps) * nCallsPerSample * nBatch;
+	res.m_pUs[0] = vSamples.front();
+	res.m_pUs[1] = get_Percentile(vSamples, 0.1);
+	res.m_pUs[2] = get_Percentile(vSamples, 0.5);
+	res.m_pUs[3] = get_Percentile(vSamples, 0.9);
+	res.m_pUs[4] = vSamples.back();
+
+	if (!g_Json)
+	{
+		printf("%-32s %12.1f ops/s  median %10.2f us  p10 %10.2f  p90 %10.2f  (%u x %u)\n",
+			sName.c_str(), 1e6 / res.m_pUs[2], res.m_pUs[2], res.m_pUs[1], res.m_pUs[3], nReps, nCallsPerSample * nBatch);
+		fflush(stdout);
+	}
+
+	g_Results.push_back(std::move(res));
+}
+
+void PrintJson()
+{
+	printf("[\n");
+	for (size_t i = 0; i < g_Results.size(); i++)
+	{
+		const Result& r = g_Results[i];
+		printf("  {\"name\": \"%s\", \"batch\": %u, \"reps\": %u, \"ops\": %llu, \"ops_per_sec\": %.3f, "
+			"\"us_min\": %.3f, \"us_p10\": %.3f, \"us_median\": %.3f, \"us_p90\": %.3f, \"us_max\": %.3f}%s\n",
+			r.m_Name.c_str(), r.m_Batch, r.m_Reps, static_cast<unsigned long long>(r.m_Ops), 1e6 / r.m_pUs[2],
+			r.m_pUs[0], r.m_pUs[1], r.m_pUs[2], r.m_pUs[3], r.m_pUs[4],
+			(i + 1 < g_Results.size()) ? "," : "");
+	}
+	printf("]\n");
+}
+
+std::string FormatName(const char* sz, uint32_t n)
+{
+	return std::string(sz) + " x" + std::to_string(n);
+}
+
+void SetRandom(Scalar::Native& x)
+{
+	Scalar s;
+	while (true)
+	{
+		GenRandom(s.m_Value);
+		if (!x.Import(s))
+			break;
+	}
+}
+
+void SetRandom(Point::Native& x)
+{
+	Point p;
+	GenRandom(p.m_X);
+	p.m_Y = 0;
+
+	while (!x.Import(p))
+		p.m_X.Inc();
+}
+
+void BenchHash()
+{
+	uint8_t pBuf[0x400];
+	GenRandom(pBuf, sizeof(pBuf));
+
+	Hash::Value hv;
+	Run("Hash.1K", 1, [&]() {
+		Hash::Processor() << beam::Blob(pBuf, sizeof(pBuf)) >> hv;
+	});
+
+	Scalar::Native k;
+	Run("Oracle.Scalar", 1, [&]() {
+		Oracle oracle;
+		oracle << hv;
+		oracle >> k;
+	});
+
+	Run("Oracle.Scalar x64", 64, [&]() {
+		// challenges drawn from the same oracle, as in the proofs
+		Oracle oracle;
+		oracle << hv;
+		for (uint32_t i = 0; i < 64; i++)
+			oracle >> k;
+	});
+}
+
+void BenchSignature()
+{
+	Scalar::Native sk;
+	SetRandom(sk);
+	Point::Native pk = Context::get().G * sk;
+
+	Hash::Value hv;
+	GenRandom(hv);
+
+	Signature sig;
+	Run("Signature.Sign", 1, [&]() {
+		sig.Sign(hv, sk);
+	});
+
+	Run("Signature.Verify", 1, [&]() {
+		if (!sig.IsValid(hv, pk))
+			std::abort();
+	});
+}
+
+void BenchMultiMac()
+{
+	Mode::Scope scope(Mode::Fast);
+
+	for (uint32_t n : { 16U, 128U, 1024U })
+	{
+		std::vector<Point::Native> vPt(n);
+		std::vector<Scalar::Native> vK(n);
+		for (uint32_t i = 0; i < n; i++)
+		{
+			SetRandom(vPt[i]);
+			SetRandom(vK[i]);
+		}
+
+		MultiMac_Dyn mm;
+		mm.Prepare(n, 0);
+
+		Point::Native res;
+		Run(FormatName("MultiMac.Casual", n), 1, [&]() {
+			mm.Reset();
+			for (uint32_t i = 0; i < n; i++)
+			{
+				mm.m_pCasual[i].Init(vPt[i]);
+				mm.m_pKCasual[i] = vK[i];
+			}
+			mm.m_Casual = n;
+			mm.Calculate(res);
+		});
+	}
+
+	{
+		// all the inner product generators
+		const uint32_t n = InnerProduct::nDim * 2;
+		std::vector<Scalar::Native> vK(n);
+		for (uint32_t i = 0; i < n; i++)
+			SetRandom(vK[i]);
+
+		MultiMac_Dyn mm;
+		mm.Prepare(0, n);
+
+		Point::Native res;
+		Run(FormatName("MultiMac.Prepared", n), 1, [&]() {
+			mm.Reset();
+			for (uint32_t i = 0; i < n; i++)
+			{
+				mm.m_ppPrepared[i] = &Context::get().m_Ipp.m_pGen_[i / InnerProduct::nDim][i % InnerProduct::nDim];
+				mm.m_pKPrep[i] = vK[i];
+			}
+			mm.m_Prepared = n;
+			mm.Calculate(res);
+		});
+	}
+}
+
+void BenchInnerProduct()
+{
+	Scalar::Native pA[InnerProduct::nDim];
+	Scalar::Native pB[InnerProduct::nDim];
+
+	for (size_t i = 0; i < InnerProduct::nDim; i++)
+	{
+		SetRandom(pA[i]);
+		SetRandom(pB[i]);
+	}
+
+	Scalar::Native dot;
+	InnerProduct::get_Dot(dot, pA, pB);
+
+	InnerProduct ip;
+	Point::Native commAB;
+
+	Run("InnerProduct.Create", 1, [&]() {
+		ip.Create(commAB, dot, pA, pB);
+	});
+
+	Run("InnerProduct.Verify", 1, [&]() {
+		if (!ip.IsValid(commAB, dot))
+			std::abort();
+	});
+}
+
+void BenchBulletproof()
+{
+	Scalar::Native sk;
+	SetRandom(sk);
+
+	RangeProof::CreatorParams cp;
+	GenRandom(cp.m_Seed.V);
+	cp.m_Value = 23110;
+
+	RangeProof::Confidential bp;
+	Run("BulletProof.Create", 1, [&]() {
+		Oracle oracle;
+		bp.Create(sk, cp, oracle);
+	});
+
+	for (uint32_t nBatch : { 16U, 256U })
+	{
+		std::vector<RangeProof::Confidential> vBp(nBatch);
+		std::vector<Oracle> vOracle(nBatch);
+		std::vector<RangeProof::Confidential::BatchItem> vItems(nBatch);
+
+		for (uint32_t i = 0; i < nBatch; i++)
+		{
+			RangeProof::Confidential::BatchItem& x = vItems[i];
+			x.m_pRes = &vBp[i];
+			x.m_pSk = &sk;
+			x.m_pCp = &cp;
+			x.m_pOracle = &vOracle[i];
+			x.m_pHGen = nullptr;
+		}
+
+		Run(FormatName("BulletProof.Create", nBatch), nBatch, [&]() {
+			for (uint32_t i = 0; i < nBatch; i++)
+				vOracle[i].Reset();
+			RangeProof::Confidential::CreateBatch(&vItems.front(), nBatch);
+		});
+	}
+
+	Point::Native comm = Commitment(sk, cp.m_Value);
+
+	Run("BulletProof.Verify", 1, [&]() {
+		Oracle oracle;
+		if (!bp.IsValid(comm, oracle))
+			std::abort();
+	});
+
+	typedef InnerProduct::BatchContextEx<4> MyBatch; // as used by the node
+	std::unique_ptr<MyBatch> pBc(new MyBatch);
+
+	for (uint32_t nBatch : { 16U, 256U })
+	{
+		Run(FormatName("BulletProof.Verify", nBatch), nBatch, [&]() {
+			InnerProduct::BatchContext::Scope scope(*pBc);
+
+			for (uint32_t i = 0; i < nBatch; i++)
+			{
+				Oracle oracle;
+				if (!bp.IsValid(comm, oracle))
+					std::abort();
+			}
+
+			if (!pBc->Flush())
+				std::abort();
+		});
+	}
+}
+
+void BenchLelantus(uint32_t M)
+{
+	beam::Lelantus::Cfg cfg(4, M);
+	const uint32_t N = cfg.get_N();
+
+	beam::Lelantus::CmListVec lst;
+	lst.m_vec.resize(N);
+
+	Point::Native pt;
+	SetRandom(pt);
+	for (uint32_t i = 0; i < N; i++, pt += pt)
+		pt.Export(lst.m_vec[i]);
+
+	Point::Native hGen; // zero - default
+
+	beam::Lelantus::Proof proof;
+	proof.m_Cfg = cfg;
+	beam::Lelantus::Prover p(lst, proof);
+
+	p.m_Witness.m_V = 100500;
+	p.m_Witness.m_R = 4U;
+	p.m_Witness.m_R_Output = 756U;
+	p.m_Witness.m_L = 333 % N;
+	SetRandom(p.m_Witness.m_SpendSk);
+
+	pt = Context::get().G * p.m_Witness.m_SpendSk;
+	Point ptSpendPk = pt;
+	Scalar::Native ser;
+	beam::Lelantus::SpendKey::ToSerial(ser, ptSpendPk);
+
+	pt = Context::get().G * p.m_Witness.m_R;
+	Tag::AddValue(pt, &hGen, p.m_Witness.m_V);
+	pt += Context::get().J * ser;
+	pt.Export(lst.m_vec[p.m_Witness.m_L]);
+
+	std::unique_ptr<beam::ExecutorMT_R> pEx;
+	std::unique_ptr<beam::Executor::Scope> pExScope;
+	if (g_Threads)
+	{
+		pEx.reset(new beam::ExecutorMT_R);
+		pEx->set_Threads(g_Threads);
+		pExScope.reset(new beam::Executor::Scope(*pEx));
+	}
+
+	Hash::Value seed = Zero;
+
+	std::string sN = "N=" + std::to_string(N);
+
+	Run("Lelantus.Create " + sN, 1, [&]() {
+		Oracle oracle;
+		p.Generate(seed, oracle, &hGen);
+	});
+
+	typedef InnerProduct::BatchContextEx<4> MyBatch;
+	std::unique_ptr<MyBatch> pBc(new MyBatch);
+	std::vector<Scalar::Native> vKs(N);
+
+	for (uint32_t nBatch : { 1U, 16U })
+	{
+		// the batch shares the same set, as the node does when verifying a block
+		Run(FormatName(("Lelantus.Verify " + sN).c_str(), nBatch), nBatch, [&]() {
+			memset0(&vKs.front(), sizeof(Scalar::Native) * vKs.size());
+
+			for (uint32_t i = 0; i < nBatch; i++)
+			{
+				Oracle oracle;
+				if (!proof.IsValid(*pBc, oracle, &vKs.front(), &hGen))
+					std::abort();
+			}
+
+			lst.Calculate(pBc->m_Sum, 0, N, &vKs.front());
+
+			if (!pBc->Flush())
+				std::abort();
+		});
+	}
+}
+
+bool ParseArgs(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* sz = argv[i];
+		if (!strcmp(sz, "--json"))
+		{
+			g_Json = true;
+			continue;
+		}
+
+		if (i + 1 == argc)
+			return false;
+		const char* szVal = argv[++i];
+
+		if (!strcmp(sz, "--filter"))
+			g_szFilter = szVal;
+		else if (!strcmp(sz, "--reps"))
+			g_Reps = std::max(1U, static_cast<uint32_t>(std::strtoul(szVal, nullptr, 10)));
+		else if (!strcmp(sz, "--time"))
+			g_Time_ms = static_cast<uint32_t>(std::strtoul(szVal, nullptr, 10));
+		else if (!strcmp(sz, "--threads"))
+			g_Threads = static_cast<uint32_t>(std::strtoul(szVal, nullptr, 10));
+		else
+			return false;
+	}
+
+	return true;
+}
+
+} // namespace
+
+} // namespace ECC
+
+int main(int argc, char* argv[])
+{
+	using namespace ECC;
+
+	if (!ParseArgs(argc, argv))
+	{
+		printf("usage: ecc_bench [--json] [--filter substr] [--reps N] [--time ms] [--threads N]\n");
+		return 1;
+	}
+
+	InitializeContext();
+
+	BenchHash();
+	BenchSignature();
+	BenchMultiMac();
+	BenchInnerProduct();
+	BenchBulletproof();
+
+	for (uint32_t M : { 4U, 5U, 6U }) // N = 256, 1024 (the default cfg), 4096
+		BenchLelantus(M);
+
+	if (g_Json)
+		PrintJson();
+
+	return 0;
+}
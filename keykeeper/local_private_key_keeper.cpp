@@ -283,6 +283,48 @@ namespace beam::wallet
         return Status::Success;
     }
 
+    IPrivateKeyKeeper2::Status::Type LocalPrivateKeyKeeper2::InvokeSync(Method::CreateOutputs& x)
+    {
+        // outputs are independent, their rangeproofs are built in parallel
+        struct MyTask
+            :public Executor::TaskSync
+        {
+            LocalPrivateKeyKeeper2* m_pThis;
+            std::vector<Method::CreateOutput>* m_pOutputs;
+            std::vector<Status::Type> m_vRes;
+
+            virtual void Exec(Executor::Context& ctx) override
+            {
+                uint32_t i0, nCount;
+                ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_pOutputs->size()));
+
+                for (uint32_t i = 0; i < nCount; i++)
+                    m_vRes[i0 + i] = m_pThis->InvokeSync(m_pOutputs->at(i0 + i));
+            }
+        } t;
+
+        t.m_pThis = this;
+        t.m_pOutputs = &x.m_vOutputs;
+        t.m_vRes.resize(x.m_vOutputs.size(), Status::Success);
+
+        if (x.m_vOutputs.size() > 1)
+        {
+            ExecutorMT_R exec;
+            exec.ExecAll(t);
+        }
+        else
+        {
+            for (size_t i = 0; i < x.m_vOutputs.size(); i++)
+                t.m_vRes[i] = InvokeSync(x.m_vOutputs[i]);
+        }
+
+        for (Status::Type n : t.m_vRes)
+            if (Status::Success != n)
+                return n;
+
+        return Status::Success;
+    }
+
     IPrivateKeyKeeper2::Status::Type LocalPrivateKeyKeeper2::InvokeSync(Method::CreateInputShielded& x)
     {
         assert(x.m_pKernel && x.m_pList);
@@ -39,6 +39,7 @@ namespace beam::wallet
         virtual Status::Type InvokeSync(Method::method& m) override;
 
         KEY_KEEPER_METHODS(THE_MACRO)
+        THE_MACRO(CreateOutputs)
 #undef THE_MACRO
 
     protected:
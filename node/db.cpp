@@ -47,6 +47,7 @@ namespace beam {
 #define TblStates_Txos			"Txos"
 #define TblStates_Extra			"Extra"
 #define TblStates_Inputs		"Inputs"
+#define TblStates_KrnMmr		"KrnMmr"
 
 #define TblTips					"Tips"
 #define TblTipsReachable		"TipsReachable"
@@ -62,6 +63,7 @@ namespace beam {
 #define TblEvents_Height		"Height"
 #define TblEvents_Body			"Body"
 #define TblEvents_Key			"Key"
+#define TblEvents_Owner			"Owner"
 
 #define TblPeer					"Peers"
 #define TblPeer_Key				"Key"
@@ -350,7 +352,7 @@ void NodeDB::Open(const char* szPath)
 		bCreate = !rs.Step();
 	}
 
-	const uint64_t nVersionTop = 26;
+	const uint64_t nVersionTop = 28;
 
 
 	Transaction t(*this);
@@ -405,6 +407,15 @@ void NodeDB::Open(const char* szPath)
 			ParamDelSafe(ParamID::Deprecated_2);
 			// no break;
 
+		case 26: // no kernel MMRs. Blocks applied before remain without them
+			ExecQuick("ALTER TABLE " TblStates " ADD COLUMN "  "[" TblStates_KrnMmr	"] BLOB");
+			// no break;
+
+		case 27: // single owner events
+			ExecQuick("ALTER TABLE " TblEvents " ADD COLUMN "  "[" TblEvents_Owner	"] INTEGER NOT NULL DEFAULT 0");
+			CreateTables27();
+			// no break;
+
 			ParamIntSet(ParamID::DbVer, nVersionTop);
 
 		case nVersionTop:
@@ -459,6 +470,7 @@ void NodeDB::Create()
 		"[" TblStates_Txos			"] INTEGER,"
 		"[" TblStates_Extra			"] BLOB,"
 		"[" TblStates_Inputs		"] BLOB,"
+		"[" TblStates_KrnMmr		"] BLOB,"
 		"PRIMARY KEY (" TblStates_Height "," TblStates_Hash "),"
 		"FOREIGN KEY (" TblStates_RowPrev ") REFERENCES " TblStates "(OID))");
 
@@ -489,7 +501,8 @@ void NodeDB::Create()
 	ExecQuick("CREATE TABLE [" TblEvents "] ("
 		"[" TblEvents_Height	"] INTEGER NOT NULL,"
 		"[" TblEvents_Body		"] BLOB NOT NULL,"
-		"[" TblEvents_Key		"] BLOB NOT NULL)");
+		"[" TblEvents_Key		"] BLOB NOT NULL,"
+		"[" TblEvents_Owner		"] INTEGER NOT NULL DEFAULT 0)");
 
 	ExecQuick("CREATE INDEX [Idx" TblEvents "] ON [" TblEvents "] ([" TblEvents_Height "],[" TblEvents_Body "]);");
 	ExecQuick("CREATE INDEX [Idx" TblEvents TblEvents_Key "] ON [" TblEvents "] ([" TblEvents_Key "]);");
@@ -527,6 +540,7 @@ void NodeDB::Create()
 	CreateTables21();
 	CreateTables22();
 	CreateTables23();
+	CreateTables27();
 }
 
 void NodeDB::CreateTables20()
@@ -575,11 +589,45 @@ void NodeDB::CreateTables23()
 		"[" TblContracts_Value		"] BLOB NOT NULL)");
 }
 
+void NodeDB::CreateTables27()
+{
+	ExecQuick("CREATE INDEX [Idx" TblEvents TblEvents_Owner "] ON [" TblEvents "] ([" TblEvents_Owner "],[" TblEvents_Height "],[" TblEvents_Body "]);");
+}
+
 void NodeDB::Vacuum()
 {
 	ExecQuick("VACUUM");
 }
 
+void NodeDB::VacuumInto(const char* szPath)
+{
+	std::string sSql = "VACUUM INTO '";
+	for (const char* sz = szPath; *sz; sz++)
+	{
+		if ('\'' == *sz)
+			sSql += '\'';
+		sSql += *sz;
+	}
+	sSql += '\'';
+
+	ExecQuick(sSql.c_str());
+}
+
+void NodeDB::DeleteLocalData()
+{
+	ExecQuick("DELETE FROM " TblPeer);
+	ExecQuick("DELETE FROM " TblBbs);
+	ExecQuick("DELETE FROM " TblDummy);
+	ExecQuick("DELETE FROM " TblEvents);
+
+	ParamDelSafe(ParamID::MyID);
+	ParamDelSafe(ParamID::EventsOwnerID);
+	ParamDelSafe(ParamID::EventsSerif);
+	ParamDelSafe(ParamID::LastRecoveryHeight);
+	ParamDelSafe(ParamID::MappingStamp);
+	ParamDelSafe(ParamID::ForbiddenState);
+}
+
 void NodeDB::ExecQuick(const char* szSql)
 {
 	int n = sqlite3_total_changes(m_pDb);
@@ -1362,6 +1410,30 @@ bool NodeDB::get_StateInputs(uint64_t rowid, std::vector<StateInput>& v)
 	return true;
 }
 
+void NodeDB::set_StateKrnMmr(uint64_t rowid, const Blob& b)
+{
+	Recordset rs(*this, Query::StateSetKrnMmr, "UPDATE " TblStates " SET " TblStates_KrnMmr "=? WHERE rowid=?");
+	rs.put(0, b);
+	rs.put(1, rowid);
+	rs.Step();
+	TestChanged1Row();
+}
+
+bool NodeDB::get_StateKrnMmr(uint64_t rowid, ByteBuffer& buf)
+{
+	Recordset rs(*this, Query::StateGetKrnMmr, "SELECT " TblStates_KrnMmr " FROM " TblStates " WHERE rowid=?");
+	rs.put(0, rowid);
+	rs.StepStrict();
+
+	Blob blob;
+	rs.get(0, blob); // if NULL empty blob will be returned
+	if (!blob.n)
+		return false;
+
+	blob.Export(buf);
+	return true;
+}
+
 void NodeDB::StateInput::Set(TxoID id, const ECC::Point& pt)
 {
 	Set(id, pt.m_X, pt.m_Y);
@@ -1484,7 +1556,7 @@ void NodeDB::DelStateBlockPPR(uint64_t rowid)
 void NodeDB::DelStateBlockAll(uint64_t rowid)
 {
 	Recordset rs(*this, Query::StateDelBlockAll, "UPDATE " TblStates
-		" SET " TblStates_BodyP "=NULL," TblStates_BodyE "=NULL," TblStates_Rollback "=NULL," TblStates_Peer "=NULL," TblStates_Extra "=NULL," TblStates_Txos "=NULL WHERE rowid=?");
+		" SET " TblStates_BodyP "=NULL," TblStates_BodyE "=NULL," TblStates_Rollback "=NULL," TblStates_Peer "=NULL," TblStates_Extra "=NULL," TblStates_Txos "=NULL," TblStates_KrnMmr "=NULL WHERE rowid=?");
 	rs.put(0, rowid);
 	rs.Step();
 	TestChanged1Row();
@@ -1785,14 +1857,15 @@ void NodeDB::MoveFwd(const StateID& sid)
 	put_Cursor(sid);
 }
 
-void NodeDB::InsertEvent(Height h, const Blob& b, const Blob& key)
+void NodeDB::InsertEvent(Height h, const Blob& b, const Blob& key, uint32_t iOwner /* = 0 */)
 {
 	assert(b.n >= sizeof(EventIndexType));
 
-	Recordset rs(*this, Query::EventIns, "INSERT INTO " TblEvents "(" TblEvents_Height "," TblEvents_Body "," TblEvents_Key ") VALUES (?,?,?)");
+	Recordset rs(*this, Query::EventIns, "INSERT INTO " TblEvents "(" TblEvents_Height "," TblEvents_Body "," TblEvents_Key "," TblEvents_Owner ") VALUES (?,?,?,?)");
 	rs.put(0, h);
 	rs.put(1, b);
 	rs.put(2, key);
+	rs.put(3, iOwner);
 	rs.Step();
 	TestChanged1Row();
 }
@@ -1804,15 +1877,16 @@ void NodeDB::DeleteEventsFrom(Height h)
 	rs.Step();
 }
 
-void NodeDB::EnumEvents(WalkerEvent& x, Height hMin)
+void NodeDB::EnumEvents(WalkerEvent& x, Height hMin, uint32_t iOwner /* = 0 */)
 {
-	x.m_Rs.Reset(*this, Query::EventEnum, "SELECT " TblEvents_Height "," TblEvents_Body "," TblEvents_Key " FROM " TblEvents " WHERE " TblEvents_Height ">=? ORDER BY " TblEvents_Height " ASC," TblEvents_Body " ASC");
-	x.m_Rs.put(0, hMin);
+	x.m_Rs.Reset(*this, Query::EventEnum, "SELECT " TblEvents_Height "," TblEvents_Body "," TblEvents_Key "," TblEvents_Owner " FROM " TblEvents " WHERE " TblEvents_Owner "=? AND " TblEvents_Height ">=? ORDER BY " TblEvents_Height " ASC," TblEvents_Body " ASC");
+	x.m_Rs.put(0, iOwner);
+	x.m_Rs.put(1, hMin);
 }
 
 void NodeDB::FindEvents(WalkerEvent& x, const Blob& key)
 {
-	x.m_Rs.Reset(*this, Query::EventFind, "SELECT " TblEvents_Height "," TblEvents_Body "," TblEvents_Key " FROM " TblEvents " WHERE " TblEvents_Key "=? ORDER BY " TblEvents_Height " DESC," TblEvents_Body " DESC");
+	x.m_Rs.Reset(*this, Query::EventFind, "SELECT " TblEvents_Height "," TblEvents_Body "," TblEvents_Key "," TblEvents_Owner " FROM " TblEvents " WHERE " TblEvents_Key "=? ORDER BY " TblEvents_Height " DESC," TblEvents_Body " DESC");
 	x.m_Rs.put(0, key);
 }
 
@@ -1826,6 +1900,7 @@ bool NodeDB::WalkerEvent::MoveNext()
 		ZeroObject(m_Key);
 	else
 		m_Rs.get(2, m_Key);
+	m_Rs.get(3, m_iOwner);
 
 	if (m_Body.n < m_Index.nBytes)
 		ThrowInconsistent();
@@ -2254,222 +2329,222 @@ NodeDB::StreamMmr::StreamMmr(NodeDB& db, StreamType::Enum eType, bool bStoreH0)
 	m_LastOut.m_Pos.X = static_cast<uint64_t>(-1);
 }
 
-void NodeDB::StreamMmr::Append(const Merkle::Hash& hv)
-{
-	uint64_t n = m_Count;
-	ResizeTo(n + 1);
+void NodeDB::StreamMmr::Append(const Merkle::Hash& hv)
+{
+	uint64_t n = m_Count;
+	ResizeTo(n + 1);
 	Mmr::Replace(n, hv);
-}
-
-void NodeDB::StreamMmr::ShrinkTo(uint64_t nCount)
+}
+
+void NodeDB::StreamMmr::ShrinkTo(uint64_t nCount)
 {
 	assert(m_Count >= nCount);
 	ResizeTo(nCount);
 }
 
-void NodeDB::StreamMmr::ResizeTo(uint64_t nCount)
+void NodeDB::StreamMmr::ResizeTo(uint64_t nCount)
 {
 	m_DB.StreamResize(m_eType, get_TotalHashes(nCount, m_StoreH0) * sizeof(Merkle::Hash), get_TotalHashes(m_Count, m_StoreH0) * sizeof(Merkle::Hash));
 	m_Count = nCount;
 }
 
-void NodeDB::StreamMmr::LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const
-{
-	if (CacheFind(hv, pos))
-		return;
-
-	m_DB.StreamIO(m_eType, Pos2Idx(pos, m_StoreH0) * sizeof(Merkle::Hash), hv.m_pData, hv.nBytes, false);
-	Cast::NotConst(this)->CacheAdd(hv, pos);
-}
-
-void NodeDB::StreamMmr::SaveElement(const Merkle::Hash& hv, const Merkle::Position& pos)
-{
-	m_DB.StreamIO(m_eType, Pos2Idx(pos, m_StoreH0) * sizeof(Merkle::Hash), Cast::NotConst(hv.m_pData), hv.nBytes, true);
-	CacheAdd(hv, pos);
-}
-
-bool NodeDB::StreamMmr::CacheFind(Merkle::Hash& hv, const Merkle::Position& pos) const
-{
-	// Note: ALWAYS test the main cache BEFORE m_LastOut, coz that element could already be overwritten
-	if (pos.H < _countof(m_pCache)) // 'if' is needed only if we decide to reduce the cache size
-	{
-		const CacheEntry& ce = m_pCache[pos.H];
-		if (ce.m_X == pos.X)
-		{
-			hv = ce.m_Value;
-			return true;
-		}
-	}
-
-	if ((m_LastOut.m_Pos.H == pos.H) && (m_LastOut.m_Pos.X == pos.X))
-	{
-		hv = m_LastOut.m_Value;
-		return true;
-	}
-
-	return false;
-}
-
-void NodeDB::StreamMmr::CacheAdd(const Merkle::Hash& hv, const Merkle::Position& pos)
-{
-	if (pos.H < _countof(m_pCache)) // 'if' is needed only if we decide to reduce the cache size
-	{
-		CacheEntry& ce = m_pCache[pos.H];
-
-		if ((ce.m_X != pos.X) && (ce.m_X != static_cast<uint64_t>(-1)))
-		{
-			m_LastOut.m_Pos.X = ce.m_X;
-			m_LastOut.m_Pos.H = pos.H;
-			m_LastOut.m_Value = ce.m_Value;
-		}
-
-		ce.m_Value = hv;
-		ce.m_X = pos.X;
-	}
-}
-
-NodeDB::StatesMmr::StatesMmr(NodeDB& db)
-	:StreamMmr(db, StreamType::StatesMmr, false)
-{
-}
-
-uint64_t NodeDB::StatesMmr::H2I(Height h)
-{
-	return (h <= Rules::HeightGenesis) ? 0 : (h - Rules::HeightGenesis);
-}
-
-void NodeDB::StatesMmr::LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const
-{
-	if (pos.H)
-		StreamMmr::LoadElement(hv, pos);
-	else
-	{
-		if (CacheFind(hv, pos))
-			return;
-
-		LoadStateHash(hv, pos.X + Rules::HeightGenesis);
-		Cast::NotConst(this)->CacheAdd(hv, pos);
-	}
-}
-
-void NodeDB::StatesMmr::LoadStateHash(Merkle::Hash& hv, Height h) const
-{
-	uint64_t row = m_DB.FindActiveStateStrict(h);
-	m_DB.get_StateHash(row, hv);
-}
-
-void NodeDB::StatesMmr::SaveElement(const Merkle::Hash& hv, const Merkle::Position& pos)
-{
-	if (pos.H)
-		StreamMmr::SaveElement(hv, pos);
-	else
-		CacheAdd(hv, pos);
-}
-
-const uint32_t NodeDB::s_StreamBlob = 1024*1024; // arbitrary, but should not be changed after DB is created
-
-uint64_t NodeDB::StreamType::Key(uint64_t idx, Enum eType)
-{
-	return idx | (static_cast<uint64_t>(eType) << 32);
-}
-
-
-void NodeDB::StreamResize(StreamType::Enum eType, uint64_t n, uint64_t n0)
-{
-	uint64_t nBlobs0 = (n0 + s_StreamBlob - 1) / s_StreamBlob;
-	uint64_t nBlobs1 = (n + s_StreamBlob - 1) / s_StreamBlob;
-
-	for (; nBlobs0 < nBlobs1; nBlobs0++)
-	{
-		Recordset rs(*this, Query::StreamIns, "INSERT INTO " TblStreams "(" TblStream_ID "," TblStream_Value ") VALUES (?,?)");
-		rs.put(0, StreamType::Key(nBlobs0, eType));
-		rs.putZeroBlob(1, s_StreamBlob);
-		rs.Step();
-		TestChanged1Row();
-	}
-
-	if (nBlobs0 > nBlobs1)
-	{
-		StreamShrinkInternal(StreamType::Key(nBlobs1, eType), StreamType::Key(nBlobs0, eType));
-
-		uint64_t ret = get_RowsChanged();
-		if (ret != nBlobs0 - nBlobs1)
+void NodeDB::StreamMmr::LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const
+{
+	if (CacheFind(hv, pos))
+		return;
+
+	m_DB.StreamIO(m_eType, Pos2Idx(pos, m_StoreH0) * sizeof(Merkle::Hash), hv.m_pData, hv.nBytes, false);
+	Cast::NotConst(this)->CacheAdd(hv, pos);
+}
+
+void NodeDB::StreamMmr::SaveElement(const Merkle::Hash& hv, const Merkle::Position& pos)
+{
+	m_DB.StreamIO(m_eType, Pos2Idx(pos, m_StoreH0) * sizeof(Merkle::Hash), Cast::NotConst(hv.m_pData), hv.nBytes, true);
+	CacheAdd(hv, pos);
+}
+
+bool NodeDB::StreamMmr::CacheFind(Merkle::Hash& hv, const Merkle::Position& pos) const
+{
+	// Note: ALWAYS test the main cache BEFORE m_LastOut, coz that element could already be overwritten
+	if (pos.H < _countof(m_pCache)) // 'if' is needed only if we decide to reduce the cache size
+	{
+		const CacheEntry& ce = m_pCache[pos.H];
+		if (ce.m_X == pos.X)
+		{
+			hv = ce.m_Value;
+			return true;
+		}
+	}
+
+	if ((m_LastOut.m_Pos.H == pos.H) && (m_LastOut.m_Pos.X == pos.X))
+	{
+		hv = m_LastOut.m_Value;
+		return true;
+	}
+
+	return false;
+}
+
+void NodeDB::StreamMmr::CacheAdd(const Merkle::Hash& hv, const Merkle::Position& pos)
+{
+	if (pos.H < _countof(m_pCache)) // 'if' is needed only if we decide to reduce the cache size
+	{
+		CacheEntry& ce = m_pCache[pos.H];
+
+		if ((ce.m_X != pos.X) && (ce.m_X != static_cast<uint64_t>(-1)))
+		{
+			m_LastOut.m_Pos.X = ce.m_X;
+			m_LastOut.m_Pos.H = pos.H;
+			m_LastOut.m_Value = ce.m_Value;
+		}
+
+		ce.m_Value = hv;
+		ce.m_X = pos.X;
+	}
+}
+
+NodeDB::StatesMmr::StatesMmr(NodeDB& db)
+	:StreamMmr(db, StreamType::StatesMmr, false)
+{
+}
+
+uint64_t NodeDB::StatesMmr::H2I(Height h)
+{
+	return (h <= Rules::HeightGenesis) ? 0 : (h - Rules::HeightGenesis);
+}
+
+void NodeDB::StatesMmr::LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const
+{
+	if (pos.H)
+		StreamMmr::LoadElement(hv, pos);
+	else
+	{
+		if (CacheFind(hv, pos))
+			return;
+
+		LoadStateHash(hv, pos.X + Rules::HeightGenesis);
+		Cast::NotConst(this)->CacheAdd(hv, pos);
+	}
+}
+
+void NodeDB::StatesMmr::LoadStateHash(Merkle::Hash& hv, Height h) const
+{
+	uint64_t row = m_DB.FindActiveStateStrict(h);
+	m_DB.get_StateHash(row, hv);
+}
+
+void NodeDB::StatesMmr::SaveElement(const Merkle::Hash& hv, const Merkle::Position& pos)
+{
+	if (pos.H)
+		StreamMmr::SaveElement(hv, pos);
+	else
+		CacheAdd(hv, pos);
+}
+
+const uint32_t NodeDB::s_StreamBlob = 1024*1024; // arbitrary, but should not be changed after DB is created
+
+uint64_t NodeDB::StreamType::Key(uint64_t idx, Enum eType)
+{
+	return idx | (static_cast<uint64_t>(eType) << 32);
+}
+
+
+void NodeDB::StreamResize(StreamType::Enum eType, uint64_t n, uint64_t n0)
+{
+	uint64_t nBlobs0 = (n0 + s_StreamBlob - 1) / s_StreamBlob;
+	uint64_t nBlobs1 = (n + s_StreamBlob - 1) / s_StreamBlob;
+
+	for (; nBlobs0 < nBlobs1; nBlobs0++)
+	{
+		Recordset rs(*this, Query::StreamIns, "INSERT INTO " TblStreams "(" TblStream_ID "," TblStream_Value ") VALUES (?,?)");
+		rs.put(0, StreamType::Key(nBlobs0, eType));
+		rs.putZeroBlob(1, s_StreamBlob);
+		rs.Step();
+		TestChanged1Row();
+	}
+
+	if (nBlobs0 > nBlobs1)
+	{
+		StreamShrinkInternal(StreamType::Key(nBlobs1, eType), StreamType::Key(nBlobs0, eType));
+
+		uint64_t ret = get_RowsChanged();
+		if (ret != nBlobs0 - nBlobs1)
 			ThrowInconsistent();
-	}
-}
-
-void NodeDB::StreamShrinkInternal(uint64_t k0, uint64_t k1)
-{
-	Recordset rs(*this, Query::StreamDel, "DELETE FROM " TblStreams " WHERE " TblStream_ID ">=? AND " TblStream_ID "<?");
-	rs.put(0, k0);
-	rs.put(1, k1);
-	rs.Step();
-}
-
-void NodeDB::StreamsDelAll(StreamType::Enum t0, StreamType::Enum t1)
-{
-	StreamShrinkInternal(StreamType::Key(0, t0), StreamType::Key(std::numeric_limits<uint32_t>::max(), t1));
-}
-
-void NodeDB::ShieldedResize(uint64_t n, uint64_t n0)
-{
-	StreamResize(StreamType::Shielded, n * sizeof(ECC::Point::Storage), n0 * sizeof(ECC::Point::Storage));
-}
-
-void NodeDB::StreamIO(StreamType::Enum eType, uint64_t pos, uint8_t* p, uint64_t nCount, bool bWrite)
-{
-	struct Guard
-	{
-		sqlite3_blob* m_pPtr = nullptr;
-
-		~Guard()
-		{
-			if (m_pPtr)
-				BEAM_VERIFY(SQLITE_OK == sqlite3_blob_close(m_pPtr));
-		}
-	};
-
-	uint64_t nBlob0 = pos / s_StreamBlob;
-	uint32_t nOffs = static_cast<uint32_t>(pos % s_StreamBlob);
-
-	while (nCount)
-	{
-		Guard blob;
-
-		TestRet(sqlite3_blob_open(m_pDb, "main", TblStreams, TblStream_Value, StreamType::Key(nBlob0, eType), bWrite ? 1 : 0, &blob.m_pPtr));
-
-		uint32_t nPortion = s_StreamBlob - nOffs;
-		if (nPortion > nCount)
-			nPortion = static_cast<uint32_t>(nCount);
-
-		int nRes = bWrite ?
-			sqlite3_blob_write(blob.m_pPtr, p, nPortion, nOffs) :
-			sqlite3_blob_read(blob.m_pPtr, p, nPortion, nOffs);
-
-		TestRet(nRes);
-
-		nCount -= nPortion;
-		p += nPortion;
-		nOffs = 0;
-		nBlob0++;
-	}
-}
-
-void NodeDB::ShieldeIO(uint64_t pos, ECC::Point::Storage* p, uint64_t nCount, bool bWrite)
-{
-	StreamIO(StreamType::Shielded, pos * sizeof(ECC::Point::Storage), reinterpret_cast<uint8_t*>(p), nCount * sizeof(ECC::Point::Storage), bWrite);
-}
-
-void NodeDB::ShieldedWrite(uint64_t pos, const ECC::Point::Storage* p, uint64_t nCount)
-{
-	ShieldeIO(pos, Cast::NotConst(p), nCount, true);
-}
-
-void NodeDB::ShieldedRead(uint64_t pos, ECC::Point::Storage* p, uint64_t nCount)
-{
-	ShieldeIO(pos, p, nCount, false);
-}
-
+	}
+}
+
+void NodeDB::StreamShrinkInternal(uint64_t k0, uint64_t k1)
+{
+	Recordset rs(*this, Query::StreamDel, "DELETE FROM " TblStreams " WHERE " TblStream_ID ">=? AND " TblStream_ID "<?");
+	rs.put(0, k0);
+	rs.put(1, k1);
+	rs.Step();
+}
+
+void NodeDB::StreamsDelAll(StreamType::Enum t0, StreamType::Enum t1)
+{
+	StreamShrinkInternal(StreamType::Key(0, t0), StreamType::Key(std::numeric_limits<uint32_t>::max(), t1));
+}
+
+void NodeDB::ShieldedResize(uint64_t n, uint64_t n0)
+{
+	StreamResize(StreamType::Shielded, n * sizeof(ECC::Point::Storage), n0 * sizeof(ECC::Point::Storage));
+}
+
+void NodeDB::StreamIO(StreamType::Enum eType, uint64_t pos, uint8_t* p, uint64_t nCount, bool bWrite)
+{
+	struct Guard
+	{
+		sqlite3_blob* m_pPtr = nullptr;
+
+		~Guard()
+		{
+			if (m_pPtr)
+				BEAM_VERIFY(SQLITE_OK == sqlite3_blob_close(m_pPtr));
+		}
+	};
+
+	uint64_t nBlob0 = pos / s_StreamBlob;
+	uint32_t nOffs = static_cast<uint32_t>(pos % s_StreamBlob);
+
+	while (nCount)
+	{
+		Guard blob;
+
+		TestRet(sqlite3_blob_open(m_pDb, "main", TblStreams, TblStream_Value, StreamType::Key(nBlob0, eType), bWrite ? 1 : 0, &blob.m_pPtr));
+
+		uint32_t nPortion = s_StreamBlob - nOffs;
+		if (nPortion > nCount)
+			nPortion = static_cast<uint32_t>(nCount);
+
+		int nRes = bWrite ?
+			sqlite3_blob_write(blob.m_pPtr, p, nPortion, nOffs) :
+			sqlite3_blob_read(blob.m_pPtr, p, nPortion, nOffs);
+
+		TestRet(nRes);
+
+		nCount -= nPortion;
+		p += nPortion;
+		nOffs = 0;
+		nBlob0++;
+	}
+}
+
+void NodeDB::ShieldeIO(uint64_t pos, ECC::Point::Storage* p, uint64_t nCount, bool bWrite)
+{
+	StreamIO(StreamType::Shielded, pos * sizeof(ECC::Point::Storage), reinterpret_cast<uint8_t*>(p), nCount * sizeof(ECC::Point::Storage), bWrite);
+}
+
+void NodeDB::ShieldedWrite(uint64_t pos, const ECC::Point::Storage* p, uint64_t nCount)
+{
+	ShieldeIO(pos, Cast::NotConst(p), nCount, true);
+}
+
+void NodeDB::ShieldedRead(uint64_t pos, ECC::Point::Storage* p, uint64_t nCount)
+{
+	ShieldeIO(pos, p, nCount, false);
+}
+
 void NodeDB::ShieldedOutpSet(Height h, uint64_t count)
 {
 	Recordset rs(*this, Query::ShieldedStatisticIns, "INSERT INTO " TblShieldedStatistic " (" TblShieldedStatistic_Height "," TblShieldedStatistic_OutCount ") VALUES(?,?)");
@@ -2522,15 +2597,15 @@ void NodeDB::UniqueDeleteStrict(const Blob& key)
 
 	rs.Step();
 	TestChanged1Row();
-}
+}
 
 void NodeDB::UniqueDeleteAll()
 {
 	Recordset rs(*this, Query::UniqueDel, "DELETE FROM " TblUnique);
 	rs.Step();
-}
+}
 
-const Asset::ID NodeDB::s_AssetEmpty0 = Asset::s_MaxCount;
+const Asset::ID NodeDB::s_AssetEmpty0 = Asset::s_MaxCount;
 
 Asset::ID NodeDB::AssetFindByOwner(const PeerID& owner)
 {
@@ -2638,14 +2713,14 @@ Asset::ID NodeDB::AssetDelete(Asset::ID id)
 	return nCount;
 }
 
-void NodeDB::AssetsDelAll()
-{
+void NodeDB::AssetsDelAll()
+{
 	Recordset rs(*this, Query::AssetsDelAll, "DELETE FROM " TblAssets);
 	rs.Step();
 
 	ParamDelSafe(ParamID::AssetsCountUsed);
 	ParamDelSafe(ParamID::AssetsCount);
-}
+}
 
 bool NodeDB::AssetGetSafe(Asset::Full& ai)
 {
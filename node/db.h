@@ -106,6 +106,8 @@ public:
 			StateGetExtra,
 			StateSetInputs,
 			StateGetInputs,
+			StateSetKrnMmr,
+			StateGetKrnMmr,
 			StateSetTxosAndExtra,
 			StateGetTxos,
 			StateFindByTxos,
@@ -231,7 +233,9 @@ public:
 	}
 
 	void Vacuum();
+	void VacuumInto(const char* szPath); // consistent copy into a new file
 	void CheckIntegrity();
+	void DeleteLocalData(); // node-specific data: own ID, peers, bbs, events
 
 	virtual void OnModified() {}
 
@@ -339,7 +343,7 @@ public:
 	void GetStateBlock(uint64_t rowid, ByteBuffer* pP, ByteBuffer* pE, ByteBuffer* pRB);
 	void DelStateBlockPP(uint64_t rowid); // delete perishable, peer. Keep eternal, extra, txos, rollback
 	void DelStateBlockPPR(uint64_t rowid); // delete perishable, rollback, peer. Keep eternal, extra, txos
-	void DelStateBlockAll(uint64_t rowid); // delete perishable, peer, eternal, extra, txos, rollback
+	void DelStateBlockAll(uint64_t rowid); // delete perishable, peer, eternal, extra, txos, rollback, kernels mmr
 
 	struct StateID {
 		uint64_t m_Row;
@@ -379,6 +383,10 @@ public:
 	void set_StateInputs(uint64_t rowid, StateInput*, size_t);
 	bool get_StateInputs(uint64_t rowid, std::vector<StateInput>&);
 
+	// kernels MMR of the block (all the hashes, flat), saved when the block is applied
+	void set_StateKrnMmr(uint64_t rowid, const Blob&);
+	bool get_StateKrnMmr(uint64_t rowid, ByteBuffer&);
+
 	void EnumTips(WalkerState&); // height lowest to highest
 	void EnumFunctionalTips(WalkerState&); // chainwork highest to lowest
 
@@ -399,7 +407,8 @@ public:
 	void assert_valid(); // diagnostic, for tests only
 
 	typedef uint32_t EventIndexType;
-	void InsertEvent(Height, const Blob&, const Blob& key); // body must start with the uintBigFor<EventIndexType>
+	// Events are tagged by the owner index, 0 is the main owner, others are used when the node indexes events for several owners
+	void InsertEvent(Height, const Blob&, const Blob& key, uint32_t iOwner = 0); // body must start with the uintBigFor<EventIndexType>
 	void DeleteEventsFrom(Height);
 
 	struct WalkerEvent {
@@ -408,12 +417,13 @@ public:
 		uintBigFor<EventIndexType>::Type m_Index;
 		Blob m_Body;
 		Blob m_Key;
+		uint32_t m_iOwner;
 
 		bool MoveNext();
 	};
 
-	void EnumEvents(WalkerEvent&, Height hMin);
-	void FindEvents(WalkerEvent&, const Blob& key); // in case of duplication the most recently added comes first
+	void EnumEvents(WalkerEvent&, Height hMin, uint32_t iOwner = 0);
+	void FindEvents(WalkerEvent&, const Blob& key); // all owners. In case of duplication the most recently added comes first
 
 	struct WalkerPeer
 	{
@@ -687,6 +697,7 @@ private:
 	void CreateTables21();
 	void CreateTables22();
 	void CreateTables23();
+	void CreateTables27();
 	void ExecQuick(const char*);
 	std::string ExecTextOut(const char*);
 	bool ExecStep(sqlite3_stmt*);
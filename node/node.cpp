@@ -702,6 +702,212 @@ void Node::MaybeGenerateRecovery()
 	}
 }
 
+// Tx pool snapshot format: version, fork hash, serialized elements (tx + height range), MAC.
+// The MAC is keyed by the node private ID, if it matches - the context-free validation of the txs is trusted, only the
+// context-dependent part is re-evaluated on load.
+static const uint32_t s_TxPoolSnapshotVersion = 1;
+
+void Node::get_TxPoolMac(ECC::Hash::Value& hv, const std::vector<ByteBuffer>& v)
+{
+	ECC::Hash::Processor hp;
+	hp
+		<< "tx-pool"
+		<< m_MyPrivateID
+		<< s_TxPoolSnapshotVersion
+		<< Rules::get().get_LastFork().m_Hash
+		<< v.size();
+
+	for (const auto& buf : v)
+		hp
+			<< buf.size()
+			<< Blob(buf);
+
+	hp >> hv;
+}
+
+void Node::SaveTxPool()
+{
+	if (m_Cfg.m_sPathTxPool.empty() || !m_bTxPoolLoaded)
+		return;
+
+	std::vector<ByteBuffer> v;
+	v.reserve(m_TxPool.m_setProfit.size());
+
+	// best first, so that the most profitable survive if the pool is smaller on load
+	for (const auto& x : m_TxPool.m_setProfit)
+	{
+		const TxPool::Fluff::Element& e = x.get_ParentObj();
+		if (!e.m_pValue)
+			continue;
+
+		Serializer ser;
+		ser
+			& *e.m_pValue
+			& e.m_Height.m_Min
+			& e.m_Height.m_Max;
+
+		v.emplace_back();
+		ser.swap_buf(v.back());
+	}
+
+	ECC::Hash::Value hvMac;
+	get_TxPoolMac(hvMac, v);
+
+	std::string sTmp = m_Cfg.m_sPathTxPool;
+	sTmp += ".tmp";
+
+	bool bOk = false;
+	try
+	{
+		std::FStream fs;
+		fs.Open(sTmp.c_str(), false, true);
+
+		yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> arc(fs);
+		arc
+			& s_TxPoolSnapshotVersion
+			& Rules::get().get_LastFork().m_Hash
+			& v
+			& hvMac;
+
+		fs.Flush();
+		bOk = true;
+	}
+	catch (const std::exception& e)
+	{
+		LOG_WARNING() << "Tx pool snapshot: " << e.what();
+	}
+
+	if (bOk)
+	{
+#ifdef WIN32
+		bOk =
+			MoveFileExW(Utf8toUtf16(sTmp.c_str()).c_str(), Utf8toUtf16(m_Cfg.m_sPathTxPool.c_str()).c_str(), MOVEFILE_REPLACE_EXISTING) ||
+			(GetLastError() == ERROR_FILE_NOT_FOUND);
+#else // WIN32
+		bOk =
+			!rename(sTmp.c_str(), m_Cfg.m_sPathTxPool.c_str()) ||
+			(ENOENT == errno);
+#endif // WIN32
+	}
+
+	if (bOk)
+		LOG_INFO() << "Tx pool snapshot saved, txs=" << v.size();
+	else
+		beam::DeleteFile(sTmp.c_str());
+}
+
+void Node::LoadTxPool()
+{
+	m_bTxPoolLoaded = true;
+
+	if (m_Cfg.m_sPathTxPool.empty())
+		return;
+
+	uint32_t nVer = 0;
+	Merkle::Hash hvFork;
+	std::vector<ByteBuffer> v;
+	ECC::Hash::Value hvMac;
+
+	try
+	{
+		std::FStream fs;
+		if (!fs.Open(m_Cfg.m_sPathTxPool.c_str(), true))
+			return; // no snapshot
+
+		yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> arc(fs);
+		arc & nVer;
+		if (s_TxPoolSnapshotVersion != nVer)
+		{
+			LOG_WARNING() << "Tx pool snapshot: unsupported version " << nVer;
+			return;
+		}
+
+		arc
+			& hvFork
+			& v
+			& hvMac;
+	}
+	catch (const std::exception& e)
+	{
+		LOG_WARNING() << "Tx pool snapshot: " << e.what();
+		return;
+	}
+
+	if (hvFork != Rules::get().get_LastFork().m_Hash)
+	{
+		LOG_WARNING() << "Tx pool snapshot: different rules, ignored";
+		return;
+	}
+
+	ECC::Hash::Value hv;
+	get_TxPoolMac(hv, v);
+	bool bTrusted = (hv == hvMac);
+	if (!bTrusted)
+		LOG_WARNING() << "Tx pool snapshot: MAC mismatch, full validation";
+
+	uint32_t nAdded = 0, nRejected = 0;
+
+	for (const auto& buf : v)
+	{
+		if (m_TxPool.m_setProfit.size() >= m_Cfg.m_MaxPoolTransactions)
+			break;
+
+		Transaction::Ptr ptx = std::make_shared<Transaction>();
+		HeightRange hr;
+
+		try
+		{
+			Deserializer der;
+			der.reset(buf);
+			der
+				& *ptx
+				& hr.m_Min
+				& hr.m_Max;
+		}
+		catch (const std::exception&)
+		{
+			nRejected++;
+			continue;
+		}
+
+		TxPool::Fluff::Element::Tx key;
+		ptx->get_Key(key.m_Key);
+		if (m_TxPool.m_setTxs.end() != m_TxPool.m_setTxs.find(key))
+			continue;
+
+		Transaction::Context::Params pars;
+		Transaction::Context ctx(pars);
+		uint32_t nSizeCorrection = 0;
+		Amount feeReserve = 0;
+		uint8_t nCode;
+
+		if (bTrusted)
+		{
+			// context-free part was verified before the snapshot was taken
+			ctx.m_Height = hr;
+			std::setmax(ctx.m_Height.m_Min, m_Processor.m_Cursor.m_ID.m_Height + 1);
+			ptx->get_Reader().AddStats(ctx.m_Stats);
+
+			nCode = ctx.m_Height.IsEmpty() ?
+				proto::TxStatus::InvalidContext :
+				ValidateTxInContext(ctx, *ptx, nSizeCorrection, feeReserve);
+		}
+		else
+			nCode = ValidateTx(ctx, *ptx, nSizeCorrection, feeReserve);
+
+		if (proto::TxStatus::Ok != nCode)
+		{
+			nRejected++;
+			continue;
+		}
+
+		m_TxPool.AddValidTx(std::move(ptx), ctx, key.m_Key, nSizeCorrection);
+		nAdded++;
+	}
+
+	LOG_INFO() << "Tx pool snapshot loaded, txs=" << nAdded << ", rejected=" << nRejected;
+}
+
 void Node::Processor::OnRolledBack()
 {
     LOG_INFO() << "Rolled back to: " << m_Cursor.m_ID;
@@ -809,6 +1015,11 @@ void Node::Processor::get_ViewerKeys(ViewerKeys& vk)
     vk.m_nSh = static_cast<Key::Index>(get_ParentObj().m_Keys.m_vSh.size());
     if (vk.m_nSh)
         vk.m_pSh = &get_ParentObj().m_Keys.m_vSh.front();
+
+    const auto& vExtra = get_ParentObj().m_Keys.m_vVkExtra;
+    vk.m_nExtra = static_cast<uint32_t>(vExtra.size());
+    if (vk.m_nExtra)
+        vk.m_pExtra = &vExtra.front();
 }
 
 Height Node::Processor::get_MaxAutoRollback()
@@ -882,6 +1093,7 @@ Node::Peer* Node::AllocPeer(const beam::io::Address& addr)
     pPeer->m_pInfo = NULL;
     pPeer->m_Flags = 0;
     pPeer->m_Port = 0;
+    pPeer->m_iOwner = 0;
     ZeroObject(pPeer->m_Tip);
     pPeer->m_RemoteAddr = addr;
     pPeer->m_LoginFlags = 0;
@@ -941,6 +1153,7 @@ void Node::Initialize(IExternalPOW* externalPOW)
 	}
 
 	RefreshOwnedUtxos();
+	LoadTxPool();
 
 	ZeroObject(m_SyncStatus);
     RefreshCongestions();
@@ -957,6 +1170,12 @@ void Node::Initialize(IExternalPOW* externalPOW)
 	m_Processor.get_DB().get_BbsTotals(m_Bbs.m_Totals);
     m_Bbs.Cleanup();
 	m_Bbs.m_HighestPosted_s = m_Processor.get_DB().get_BbsMaxTime();
+
+	if (!m_Cfg.m_sPathTxPool.empty() && m_Cfg.m_Timeout.m_TxPoolSnapshot_ms)
+	{
+		m_pTxPoolTimer = io::Timer::create(io::Reactor::get_Current());
+		m_pTxPoolTimer->start(m_Cfg.m_Timeout.m_TxPoolSnapshot_ms, true, [this]() { SaveTxPool(); });
+	}
 }
 
 uint32_t Node::get_AcessiblePeerCount() const
@@ -991,6 +1210,28 @@ void Node::InitKeys()
 	else
         m_Keys.m_pMiner = nullptr; // can't mine without owner view key, because it's used for Tagging
 
+    // extra owners, 1 shielded viewer each
+    size_t nExtra = m_Keys.m_vOwnersExtra.size();
+    m_Keys.m_vShExtra.resize(nExtra);
+    m_Keys.m_vVkExtra.resize(nExtra);
+
+    for (size_t i = 0; i < nExtra; i++)
+    {
+        Key::IPKdf::Ptr& pKdf = m_Keys.m_vOwnersExtra[i];
+        if (!pKdf)
+            throw std::runtime_error("extra owner key missing");
+
+        m_Keys.m_vShExtra[i].FromOwner(*pKdf, 0);
+
+        NodeProcessor::ViewerKeys& vk = m_Keys.m_vVkExtra[i];
+        vk.m_pMw = pKdf.get();
+        vk.m_pSh = &m_Keys.m_vShExtra[i];
+        vk.m_nSh = 1;
+    }
+
+    if (nExtra)
+        LOG_INFO() << "Extra owners: " << nExtra;
+
     if (!m_Keys.m_pGeneric)
     {
         if (m_Keys.m_pMiner)
@@ -1050,6 +1291,13 @@ void Node::RefreshOwnedUtxos()
 		}
 	}
 
+	for (const auto& pKdf : m_Keys.m_vOwnersExtra)
+	{
+		ECC::Scalar::Native sk;
+		pKdf->DerivePKey(sk, hv1);
+		hp << sk;
+	}
+
 	hp >> hv0;
 
 	Blob blob(hv1);
@@ -1146,7 +1394,10 @@ Node::~Node()
 	m_Processor.Stop();
 
 	if (!std::uncaught_exceptions() && m_Processor.get_DB().IsOpen())
+	{
 		m_PeerMan.OnFlush();
+		SaveTxPool();
+	}
 
     LOG_INFO() << "Node stopped";
 }
@@ -1257,8 +1508,24 @@ void Node::Peer::OnMsg(proto::Authentication&& msg)
         if (pOwner && IsKdfObscured(*pOwner, msg.m_ID))
         {
             m_Flags |= Flags::Owner | Flags::Viewer;
+            m_iOwner = 0;
             ProvePKdfObscured(*pOwner, proto::IDType::Viewer);
         }
+        else
+        {
+            // extra owners get only their events, they don't own the node
+            const auto& vExtra = m_This.m_Keys.m_vOwnersExtra;
+            for (size_t i = 0; i < vExtra.size(); i++)
+            {
+                if (IsKdfObscured(*vExtra[i], msg.m_ID))
+                {
+                    m_Flags |= Flags::Viewer;
+                    m_iOwner = static_cast<uint32_t>(i + 1);
+                    ProvePKdfObscured(*vExtra[i], proto::IDType::Viewer);
+                    break;
+                }
+            }
+        }
 
         if (!b && ShouldFinalizeMining())
             m_This.m_Miner.OnFinalizerChanged(this);
@@ -1270,8 +1537,23 @@ void Node::Peer::OnMsg(proto::Authentication&& msg)
 		if (pOwner && IsPKdfObscured(*pOwner, msg.m_ID))
 		{
 			m_Flags |= Flags::Viewer;
+			m_iOwner = 0;
 			ProvePKdfObscured(*pOwner, proto::IDType::Viewer);
 		}
+		else
+		{
+			const auto& vExtra = m_This.m_Keys.m_vOwnersExtra;
+			for (size_t i = 0; i < vExtra.size(); i++)
+			{
+				if (IsPKdfObscured(*vExtra[i], msg.m_ID))
+				{
+					m_Flags |= Flags::Viewer;
+					m_iOwner = static_cast<uint32_t>(i + 1);
+					ProvePKdfObscured(*vExtra[i], proto::IDType::Viewer);
+					break;
+				}
+			}
+		}
 	}
 
     MaybeSendSerif();
@@ -2163,6 +2445,11 @@ uint8_t Node::ValidateTx(Transaction::Context& ctx, const Transaction& tx, uint3
     if (!(m_Processor.ValidateAndSummarize(ctx, tx, tx.get_Reader()) && ctx.IsValidTransaction()))
         return proto::TxStatus::Invalid;
 
+    return ValidateTxInContext(ctx, tx, nSizeCorrection, feeReserve);
+}
+
+uint8_t Node::ValidateTxInContext(Transaction::Context& ctx, const Transaction& tx, uint32_t& nSizeCorrection, Amount& feeReserve)
+{
     uint8_t nCode = m_Processor.ValidateTxContextEx(tx, ctx.m_Height, false, nSizeCorrection);
     if (proto::TxStatus::Ok != nCode)
         return nCode;
@@ -2384,6 +2671,7 @@ uint8_t Node::OnTransactionStem(Transaction::Ptr&& ptx)
         pGuard->m_pValue.swap(ptx);
 		pGuard->m_Height = ctx.m_Height;
         pGuard->m_FeeReserve = feeReserve;
+        pGuard->m_Tip = m_Processor.m_Cursor.m_ID.m_Hash; // the dummy inputs are validated on top of it too
 
         m_Dandelion.InsertKrn(*pGuard);
 
@@ -2412,9 +2700,21 @@ uint8_t Node::OnTransactionStem(Transaction::Ptr&& ptx)
 
 void Node::OnTransactionAggregated(TxPool::Stem::Element& x)
 {
-	m_Dandelion.DeleteAggr(x);
+	m_Dandelion.FinishAggr(x);
 	LogTxStem(*x.m_pValue, "Aggregation finished");
 
+	if (m_Cfg.m_LogTxStem)
+	{
+		const TxPool::Stem::Stats& s = m_Dandelion.m_Stats;
+		LOG_INFO()
+			<< "Stem aggregation: merged=" << s.m_Merged
+			<< " (incremental=" << s.m_MergedIncremental << ")"
+			<< " failed=" << s.m_MergeFailed
+			<< " finished=" << s.m_Aggregated
+			<< " avg_ms=" << (s.m_Aggregated ? (s.m_AggregationTotal_ms / s.m_Aggregated) : 0)
+			<< " max_ms=" << s.m_AggregationMax_ms;
+	}
+
     // must have at least 1 peer to continue the stem phase
     uint32_t nStemPeers = 0;
 
@@ -2461,41 +2761,7 @@ void Node::OnTransactionAggregated(TxPool::Stem::Element& x)
 
 void Node::PerformAggregation(TxPool::Stem::Element& x)
 {
-    assert(x.m_bAggregating);
-
-    // Aggregation policiy: first select those with worse profit, than those with better
-    TxPool::Stem::ProfitSet::iterator it = TxPool::Stem::ProfitSet::s_iterator_to(x.m_Profit);
-    ++it;
-
-    while (x.m_pValue->m_vOutputs.size() <= m_Cfg.m_Dandelion.m_OutputsMax)
-    {
-        if (m_Dandelion.m_setProfit.end() == it)
-            break;
-
-        TxPool::Stem::Element& src = it->get_ParentObj();
-        ++it;
-
-        m_Dandelion.TryMerge(x, src);
-    }
-
-    it = TxPool::Stem::ProfitSet::s_iterator_to(x.m_Profit);
-    if (m_Dandelion.m_setProfit.begin() != it)
-    {
-        --it;
-        while (x.m_pValue->m_vOutputs.size() <= m_Cfg.m_Dandelion.m_OutputsMax)
-        {
-            TxPool::Stem::Element& src = it->get_ParentObj();
-
-            bool bEnd = (m_Dandelion.m_setProfit.begin() == it);
-            if (!bEnd)
-                --it;
-
-            m_Dandelion.TryMerge(x, src);
-
-            if (bEnd)
-                break;
-        }
-    }
+    m_Dandelion.Aggregate(x, m_Cfg.m_Dandelion.m_OutputsMax);
 
 	LogTxStem(*x.m_pValue, "Aggregated so far");
 
@@ -2745,11 +3011,23 @@ uint8_t Node::OnTransactionFluff(Transaction::Ptr&& ptxArg, const PeerID* pSende
     }
 
     if (m_Miner.IsEnabled() && !m_Miner.m_pTaskToFinalize)
-        m_Miner.SetTimer(m_Cfg.m_Timeout.m_MiningSoftRestart_ms, false);
+    {
+        // A tx that outranks the current block template is worth a new job right away, the template is extended incrementally.
+        // Txs that arrive within the same reactor cycle are coalesced.
+        if (m_TxPool.m_Template.m_bValid && m_TxPool.m_Template.IsOutranked(*pNewTxElem))
+            m_Miner.SetTimer(0, true);
+        else
+            m_Miner.SetTimer(m_Cfg.m_Timeout.m_MiningSoftRestart_ms, false);
+    }
 
     return nCode;
 }
 
+const Merkle::Hash& Node::Dandelion::get_Tip()
+{
+    return get_ParentObj().m_Processor.m_Cursor.m_ID.m_Hash;
+}
+
 void Node::Dandelion::OnTimedOut(Element& x)
 {
     if (x.m_bAggregating)
@@ -2765,11 +3043,21 @@ void Node::Dandelion::OnTimedOut(Element& x)
 	}
 }
 
-bool Node::Dandelion::ValidateTxContext(const Transaction& tx, const HeightRange& hr, const AmountBig::Type& fees, Amount& feeReserve)
+bool Node::Dandelion::ValidateTxContext(const Transaction& tx, const HeightRange& hr, const AmountBig::Type& fees, Amount& feeReserve, bool bPartsValid)
 {
-    uint32_t nBvmCharge = 0;
-    if (proto::TxStatus::Ok != get_ParentObj().m_Processor.ValidateTxContextEx(tx, hr, true, nBvmCharge))
-        return false;
+    NodeProcessor& p = get_ParentObj().m_Processor;
+    uint32_t nBvmCharge = 0; // only std kernels are aggregated
+
+    if (bPartsValid)
+    {
+        if (!hr.IsInRange(p.m_Cursor.m_ID.m_Height + 1))
+            return false;
+    }
+    else
+    {
+        if (proto::TxStatus::Ok != p.ValidateTxContextEx(tx, hr, true, nBvmCharge))
+            return false;
+    }
 
     TxStats s;
     tx.get_Reader().AddStats(s);
@@ -3028,7 +3316,7 @@ void Node::Peer::OnMsg(proto::GetProofState&& msg)
     Send(msgOut);
 }
 
-void Node::Processor::GenerateProofStateStrict(Merkle::HardProof& proof, Height h)
+void Node::Processor::GenerateProofStateStrict(Merkle::HardProof& proof, Height h, bool bSuffix /* = true */)
 {
     assert(h < m_Cursor.m_Sid.m_Height);
 
@@ -3037,16 +3325,21 @@ void Node::Processor::GenerateProofStateStrict(Merkle::HardProof& proof, Height
     m_Mmr.m_States.get_Proof(bld, m_Mmr.m_States.H2I(h));
 
     proof.swap(bld.m_Proof);
+    if (bSuffix)
+        AppendProofSuffix(proof, ProofCache::Kind::History);
+}
 
-    struct MyProofBuilder
-        :public ProofBuilderHard
+void Node::Processor::GenerateProofKernel(TxKernel::LongProof& proof, const Merkle::Hash& idKrn, bool bSuffix /* = true */)
+{
+    Height h = get_ProofKernel(proof.m_Inner, NULL, idKrn);
+    if (h)
     {
-        using ProofBuilderHard::ProofBuilderHard;
-        virtual bool get_History(Merkle::Hash&) override { return false; }
-    };
+        uint64_t rowid = FindActiveAtStrict(h);
+        get_DB().get_State(rowid, proof.m_State);
 
-    MyProofBuilder pb(*this, proof);
-    pb.GenerateProof();
+        if (h < m_Cursor.m_ID.m_Height)
+            GenerateProofStateStrict(proof.m_Outer, h, bSuffix);
+    }
 }
 
 void Node::Peer::OnMsg(proto::GetProofKernel&& msg)
@@ -3055,17 +3348,26 @@ void Node::Peer::OnMsg(proto::GetProofKernel&& msg)
 
     Processor& p = m_This.m_Processor;
 	if (!p.IsFastSync())
-	{
-		Height h = p.get_ProofKernel(msgOut.m_Proof.m_Inner, NULL, msg.m_ID);
-		if (h)
-		{
-			uint64_t rowid = p.FindActiveAtStrict(h);
-			p.get_DB().get_State(rowid, msgOut.m_Proof.m_State);
+		p.GenerateProofKernel(msgOut.m_Proof, msg.m_ID);
+    Send(msgOut);
+}
 
-			if (h < p.m_Cursor.m_ID.m_Height)
-				p.GenerateProofStateStrict(msgOut.m_Proof.m_Outer, h);
-		}
-	}
+void Node::Peer::OnMsg(proto::GetProofKernelMulti&& msg)
+{
+    if (msg.m_IDs.size() > proto::g_ProofsMultiMaxCount)
+        ThrowUnexpected();
+
+    proto::ProofKernelMulti msgOut;
+
+    Processor& p = m_This.m_Processor;
+    if (!p.IsFastSync())
+    {
+        msgOut.m_Proofs.resize(msg.m_IDs.size());
+        for (size_t i = 0; i < msg.m_IDs.size(); i++)
+            p.GenerateProofKernel(msgOut.m_Proofs[i], msg.m_IDs[i], false);
+
+        p.AppendProofSuffix(msgOut.m_Suffix, NodeProcessor::ProofCache::Kind::History);
+    }
     Send(msgOut);
 }
 
@@ -3079,12 +3381,13 @@ void Node::Peer::OnMsg(proto::GetProofKernel2&& msg)
     Send(msgOut);
 }
 
-void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
+void Node::Processor::GenerateProofUtxo(std::vector<Input::Proof>& v, const ECC::Point& comm, Height hMaturityMin, bool bSuffix /* = true */)
 {
     struct Traveler :public UtxoTree::ITraveler
     {
-        proto::ProofUtxo m_Msg;
-        NodeProcessor& m_Proc;
+        std::vector<Input::Proof>& m_vRes;
+        Processor& m_Proc;
+        bool m_Suffix;
 
         virtual bool OnLeaf(const RadixTree::Leaf& x) override {
 
@@ -3092,53 +3395,71 @@ void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
             UtxoTree::Key::Data d;
             d = v.m_Key;
 
-            Input::Proof& ret = m_Msg.m_Proofs.emplace_back();
+            Input::Proof& ret = m_vRes.emplace_back();
 
             ret.m_State.m_Count = v.get_Count();
             ret.m_State.m_Maturity = d.m_Maturity;
             m_Proc.get_Utxos().get_Proof(ret.m_Proof, *m_pCu);
+            if (m_Suffix)
+                m_Proc.AppendProofSuffix(ret.m_Proof, ProofCache::Kind::Utxos);
 
-            struct MyProofBuilder
-                :public NodeProcessor::ProofBuilder
-            {
-                using ProofBuilder::ProofBuilder;
-                virtual bool get_Utxos(Merkle::Hash&) override { return false; }
-            };
-
-            MyProofBuilder pb(m_Proc, ret.m_Proof);
-            pb.GenerateProof();
-
-            return m_Msg.m_Proofs.size() < Input::Proof::s_EntriesMax;
+            return m_vRes.size() < Input::Proof::s_EntriesMax;
         }
 
-        Traveler(NodeProcessor& np) :m_Proc(np) {}
+        Traveler(std::vector<Input::Proof>& vRes, Processor& np) :m_vRes(vRes), m_Proc(np) {}
     };
 
-	Processor& p = m_This.m_Processor;
-    Traveler t(p);
+    Traveler t(v, *this);
+    t.m_Suffix = bSuffix;
+
+    UtxoTree::Cursor cu;
+    t.m_pCu = &cu;
+
+    // bounds
+    UtxoTree::Key kMin, kMax;
+
+    UtxoTree::Key::Data d;
+    d.m_Commitment = comm;
+    d.m_Maturity = hMaturityMin;
+    kMin = d;
+    d.m_Maturity = Height(-1);
+    kMax = d;
+
+    t.m_pBound[0] = kMin.V.m_pData;
+    t.m_pBound[1] = kMax.V.m_pData;
+
+    get_Utxos().Traverse(t);
+}
 
+void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
+{
+    proto::ProofUtxo msgOut;
+
+	Processor& p = m_This.m_Processor;
 	if (!p.IsFastSync())
-	{
-		UtxoTree::Cursor cu;
-		t.m_pCu = &cu;
+		p.GenerateProofUtxo(msgOut.m_Proofs, msg.m_Utxo, msg.m_MaturityMin);
 
-		// bounds
-		UtxoTree::Key kMin, kMax;
+    Send(msgOut);
+}
 
-		UtxoTree::Key::Data d;
-		d.m_Commitment = msg.m_Utxo;
-		d.m_Maturity = msg.m_MaturityMin;
-		kMin = d;
-		d.m_Maturity = Height(-1);
-		kMax = d;
+void Node::Peer::OnMsg(proto::GetProofUtxoMulti&& msg)
+{
+    if (msg.m_Utxos.size() > proto::g_ProofsMultiMaxCount)
+        ThrowUnexpected();
 
-		t.m_pBound[0] = kMin.V.m_pData;
-		t.m_pBound[1] = kMax.V.m_pData;
+    proto::ProofUtxoMulti msgOut;
 
-        p.get_Utxos().Traverse(t);
-	}
+    Processor& p = m_This.m_Processor;
+    if (!p.IsFastSync())
+    {
+        msgOut.m_Proofs.resize(msg.m_Utxos.size());
+        for (size_t i = 0; i < msg.m_Utxos.size(); i++)
+            p.GenerateProofUtxo(msgOut.m_Proofs[i], msg.m_Utxos[i], 0, false);
 
-    Send(t.m_Msg);
+        msgOut.m_Suffix = p.get_ProofSuffix(NodeProcessor::ProofCache::Kind::Utxos);
+    }
+
+    Send(msgOut);
 }
 
 void Node::Processor::GenerateProofShielded(Merkle::Proof& p, const uintBigFor<TxoID>::Type& mmrIdx)
@@ -3147,16 +3468,7 @@ void Node::Processor::GenerateProofShielded(Merkle::Proof& p, const uintBigFor<T
     mmrIdx.Export(nIdx);
 
     m_Mmr.m_Shielded.get_Proof(p, nIdx);
-
-    struct MyProofBuilder
-        :public NodeProcessor::ProofBuilder
-    {
-        using ProofBuilder::ProofBuilder;
-        virtual bool get_Shielded(Merkle::Hash&) override { return false; }
-    };
-
-    MyProofBuilder pb(*this, p);
-    pb.GenerateProof();
+    AppendProofSuffix(p, ProofCache::Kind::Shielded);
 }
 
 void Node::Peer::OnMsg(proto::GetProofShieldedOutp&& msg)
@@ -3230,16 +3542,7 @@ void Node::Peer::OnMsg(proto::GetProofAsset&& msg)
             msgOut.m_Info = std::move(ai);
 
             p.m_Mmr.m_Assets.get_Proof(msgOut.m_Proof, msgOut.m_Info.m_ID - 1);
-
-            struct MyProofBuilder
-                :public NodeProcessor::ProofBuilder
-            {
-                using ProofBuilder::ProofBuilder;
-                virtual bool get_Assets(Merkle::Hash&) override { return false; }
-            };
-
-            MyProofBuilder pb(p, msgOut.m_Proof);
-            pb.GenerateProof();
+            p.AppendProofSuffix(msgOut.m_Proof, NodeProcessor::ProofCache::Kind::Assets);
         }
     }
 
@@ -3557,7 +3860,7 @@ void Node::Peer::OnMsg(proto::GetEvents&& msg)
 
         Serializer ser, serCvt;
 
-        for (db.EnumEvents(wlk, msg.m_HeightMin); wlk.MoveNext(); hLast = wlk.m_Height)
+        for (db.EnumEvents(wlk, msg.m_HeightMin, m_iOwner); wlk.MoveNext(); hLast = wlk.m_Height)
         {
             if ((nCount >= proto::Event::s_Max) && (wlk.m_Height != hLast))
                 break;
@@ -3780,16 +4083,7 @@ void Node::Peer::OnMsg(proto::GetContractVar&& msg)
             NodeProcessor::OnCorrupted();
 
         t.get_Proof(msgOut.m_Proof, cu);
-
-        struct MyProofBuilder
-            :public NodeProcessor::ProofBuilder
-        {
-            using ProofBuilder::ProofBuilder;
-            virtual bool get_Contracts(Merkle::Hash&) override { return false; }
-        };
-
-        MyProofBuilder pb(p, msgOut.m_Proof);
-        pb.GenerateProof();
+        p.AppendProofSuffix(msgOut.m_Proof, NodeProcessor::ProofCache::Kind::Contracts);
 
     }
 
@@ -57,6 +57,7 @@ struct Node
 		bool m_PeersPersistent = false; // keep connection to those peers, regardless to their rating
 
 		std::string m_sPathLocal;
+		std::string m_sPathTxPool; // fluff pool snapshot, saved on shutdown and periodically, loaded on start. Empty - disabled
 		NodeProcessor::Horizon m_Horizon;
 
 		struct Timeout {
@@ -68,6 +69,7 @@ struct Node
 			uint32_t m_TopPeersUpd_ms = 1000 * 60 * 10; // once in 10 minutes
 			uint32_t m_PeersUpdate_ms	= 1000; // reconsider every second
 			uint32_t m_PeersDbFlush_ms = 1000 * 60; // 1 minute
+			uint32_t m_TxPoolSnapshot_ms = 1000 * 60 * 5; // 5 minutes
 		} m_Timeout;
 
 		uint32_t m_MaxConcurrentBlocksRequest = 18;
@@ -175,6 +177,13 @@ struct Node
 
 		std::vector<ShieldedTxo::Viewer> m_vSh; // derived from owner
 
+		// Additional owner view keys (i.e. custodial node). Their events are indexed and served separately, each wallet gets only its own.
+		// Owner index 0 is the main owner (above), the extra owners are indexed from 1. Don't reorder them once the events are indexed.
+		std::vector<Key::IPKdf::Ptr> m_vOwnersExtra;
+
+		std::vector<ShieldedTxo::Viewer> m_vShExtra; // derived, one per extra owner
+		std::vector<NodeProcessor::ViewerKeys> m_vVkExtra; // derived
+
 	} m_Keys;
 
 	~Node();
@@ -249,7 +258,9 @@ private:
 		Block::ChainWorkProof m_Cwp; // cached
 		bool BuildCwp();
 
-		void GenerateProofStateStrict(Merkle::HardProof&, Height);
+		void GenerateProofStateStrict(Merkle::HardProof&, Height, bool bSuffix = true);
+		void GenerateProofKernel(TxKernel::LongProof&, const Merkle::Hash& idKrn, bool bSuffix = true);
+		void GenerateProofUtxo(std::vector<Input::Proof>&, const ECC::Point&, Height hMaturityMin, bool bSuffix = true);
 		void GenerateProofShielded(Merkle::Proof&, const uintBigFor<TxoID>::Type& mmrIdx);
 
 		bool m_bFlushPending = false;
@@ -314,6 +325,12 @@ private:
 	void RefreshOwnedUtxos();
 	void MaybeGenerateRecovery();
 
+	io::Timer::Ptr m_pTxPoolTimer;
+	bool m_bTxPoolLoaded = false; // don't overwrite the snapshot before it was loaded
+	void SaveTxPool();
+	void LoadTxPool();
+	void get_TxPoolMac(ECC::Hash::Value&, const std::vector<ByteBuffer>&);
+
 	struct Wanted
 	{
 		typedef ECC::Hash::Value KeyType;
@@ -361,7 +378,8 @@ private:
 		:public TxPool::Stem
 	{
 		// TxPool::Stem
-		virtual bool ValidateTxContext(const Transaction&, const HeightRange&, const AmountBig::Type&, Amount& feeReserve) override;
+		virtual bool ValidateTxContext(const Transaction&, const HeightRange&, const AmountBig::Type&, Amount& feeReserve, bool bPartsValid) override;
+		virtual const Merkle::Hash& get_Tip() override;
 		virtual void OnTimedOut(Element&) override;
 
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_Dandelion)
@@ -396,6 +414,7 @@ private:
 	Height SampleDummySpentHeight();
 
 	uint8_t ValidateTx(Transaction::Context&, const Transaction&, uint32_t& nSizeCorrection, Amount& feeReserve); // complete validation
+	uint8_t ValidateTxInContext(Transaction::Context&, const Transaction&, uint32_t& nSizeCorrection, Amount& feeReserve); // context-dependent part only, ctx must be summarized
 	static bool CalculateFeeReserve(const TxStats&, const HeightRange&, const AmountBig::Type&, uint32_t nBvmCharge, Amount& feeReserve);
 	void LogTx(const Transaction&, uint8_t nStatus, const Transaction::KeyType&);
 	void LogTxStem(const Transaction&, const char* szTxt);
@@ -510,6 +529,7 @@ private:
 
 		uint16_t m_Flags;
 		uint16_t m_Port; // to connect to
+		uint32_t m_iOwner; // events stream of the authenticated viewer
 		beam::io::Address m_RemoteAddr; // for logging only
 
 		Block::SystemState::Full m_Tip;
@@ -587,6 +607,8 @@ private:
 		virtual void OnMsg(proto::GetProofKernel&&) override;
 		virtual void OnMsg(proto::GetProofKernel2&&) override;
 		virtual void OnMsg(proto::GetProofUtxo&&) override;
+		virtual void OnMsg(proto::GetProofUtxoMulti&&) override;
+		virtual void OnMsg(proto::GetProofKernelMulti&&) override;
 		virtual void OnMsg(proto::GetProofShieldedOutp&&) override;
 		virtual void OnMsg(proto::GetProofShieldedInp&&) override;
 		virtual void OnMsg(proto::GetProofAsset&&) override;
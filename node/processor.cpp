@@ -393,6 +393,9 @@ void NodeProcessor::CommitDB()
 
 void NodeProcessor::InitCursor(bool bMovingUp)
 {
+	if (m_ProofCache.Reset())
+		LOG_DEBUG() << "Proof cache hits=" << m_ProofCache.m_Stats.m_Hits << ", misses=" << m_ProofCache.m_Stats.m_Misses;
+
 	if (m_Cursor.m_Sid.m_Height >= Rules::HeightGenesis)
 	{
 		if (bMovingUp)
@@ -1934,6 +1937,80 @@ void NodeProcessor::ProofBuilderHard::OnProof(Merkle::Hash& hv, bool bNewOnRight
 	m_Proof.back() = hv;
 }
 
+bool NodeProcessor::ProofCache::Reset()
+{
+	bool bWasValid = false;
+	for (uint32_t i = 0; i < Kind::count; i++)
+	{
+		bWasValid |= m_pValid[i];
+		m_pValid[i] = false;
+	}
+	return bWasValid;
+}
+
+const Merkle::Proof& NodeProcessor::get_ProofSuffix(ProofCache::Kind::Enum eKind)
+{
+	assert(eKind < ProofCache::Kind::count);
+	Merkle::Proof& res = m_ProofCache.m_pSuffix[eKind];
+
+	if (m_ProofCache.m_pValid[eKind])
+	{
+		m_ProofCache.m_Stats.m_Hits++;
+		return res;
+	}
+
+	m_ProofCache.m_Stats.m_Misses++;
+
+	struct MyProofBuilder
+		:public ProofBuilder
+	{
+		ProofCache::Kind::Enum m_Kind;
+
+		MyProofBuilder(NodeProcessor& p, Merkle::Proof& proof, ProofCache::Kind::Enum eKind)
+			:ProofBuilder(p, proof)
+			,m_Kind(eKind)
+		{
+		}
+
+		// the subtree of the proven element is not evaluated
+		virtual bool get_History(Merkle::Hash& hv) override {
+			return (ProofCache::Kind::History != m_Kind) && ProofBuilder::get_History(hv);
+		}
+		virtual bool get_Utxos(Merkle::Hash& hv) override {
+			return (ProofCache::Kind::Utxos != m_Kind) && ProofBuilder::get_Utxos(hv);
+		}
+		virtual bool get_Shielded(Merkle::Hash& hv) override {
+			return (ProofCache::Kind::Shielded != m_Kind) && ProofBuilder::get_Shielded(hv);
+		}
+		virtual bool get_Assets(Merkle::Hash& hv) override {
+			return (ProofCache::Kind::Assets != m_Kind) && ProofBuilder::get_Assets(hv);
+		}
+		virtual bool get_Contracts(Merkle::Hash& hv) override {
+			return (ProofCache::Kind::Contracts != m_Kind) && ProofBuilder::get_Contracts(hv);
+		}
+	};
+
+	res.clear();
+	MyProofBuilder pb(*this, res, eKind);
+	pb.GenerateProof();
+
+	m_ProofCache.m_pValid[eKind] = true;
+	return res;
+}
+
+void NodeProcessor::AppendProofSuffix(Merkle::Proof& proof, ProofCache::Kind::Enum eKind)
+{
+	const Merkle::Proof& suffix = get_ProofSuffix(eKind);
+	proof.insert(proof.end(), suffix.begin(), suffix.end());
+}
+
+void NodeProcessor::AppendProofSuffix(Merkle::HardProof& proof, ProofCache::Kind::Enum eKind)
+{
+	const Merkle::Proof& suffix = get_ProofSuffix(eKind);
+	for (const auto& x : suffix)
+		proof.push_back(x.second);
+}
+
 uint64_t NodeProcessor::ProcessKrnMmr(Merkle::Mmr& mmr, std::vector<TxKernel::Ptr>& vKrn, const Merkle::Hash& idKrn, TxKernel::Ptr* ppRes)
 {
 	uint64_t iRet = uint64_t (-1);
@@ -1955,6 +2032,69 @@ uint64_t NodeProcessor::ProcessKrnMmr(Merkle::Mmr& mmr, std::vector<TxKernel::Pt
 	return iRet;
 }
 
+// Block kernels MMR, all the hashes are in a flat array (same layout as in FixedMmr). Saved in the DB prefixed by the kernels count
+struct NodeProcessor::KrnFlatMmr
+	:public Merkle::FlatMmr
+{
+	typedef uintBigFor<uint32_t>::Type Count;
+
+	Merkle::Hash* m_pHashes = nullptr;
+
+	bool Init(ByteBuffer& buf)
+	{
+		if (buf.size() < sizeof(Count))
+			return false;
+
+		uint32_t n;
+		reinterpret_cast<const Count*>(&buf.front())->Export(n);
+
+		if (buf.size() != sizeof(Count) + sizeof(Merkle::Hash) * get_TotalHashes(n, true))
+			return false;
+
+		m_Count = n;
+		m_pHashes = reinterpret_cast<Merkle::Hash*>(&buf.front() + sizeof(Count));
+		return true;
+	}
+
+	uint64_t Find(const Merkle::Hash& hv) const
+	{
+		Merkle::Position pos;
+		pos.H = 0;
+		for (pos.X = 0; pos.X < m_Count; pos.X++)
+			if (m_pHashes[Pos2Idx(pos, true)] == hv)
+				return pos.X;
+
+		return uint64_t(-1);
+	}
+
+protected:
+	virtual void LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const override {
+		hv = m_pHashes[Pos2Idx(pos, true)];
+	}
+
+	virtual void SaveElement(const Merkle::Hash& hv, const Merkle::Position& pos) override {
+		m_pHashes[Pos2Idx(pos, true)] = hv;
+	}
+};
+
+void NodeProcessor::SaveKrnMmr(uint64_t rowid, const TxVectors::Eternal& txve)
+{
+	uint32_t n = static_cast<uint32_t>(txve.m_vKernels.size());
+	if (!n)
+		return;
+
+	ByteBuffer buf(sizeof(KrnFlatMmr::Count) + sizeof(Merkle::Hash) * KrnFlatMmr::get_TotalHashes(n, true));
+	*reinterpret_cast<KrnFlatMmr::Count*>(&buf.front()) = n;
+
+	KrnFlatMmr mmr;
+	mmr.m_pHashes = reinterpret_cast<Merkle::Hash*>(&buf.front() + sizeof(KrnFlatMmr::Count));
+
+	for (const auto& pKrn : txve.m_vKernels)
+		mmr.Append(pKrn->m_Internal.m_ID);
+
+	m_DB.set_StateKrnMmr(rowid, buf);
+}
+
 Height NodeProcessor::get_ProofKernel(Merkle::Proof& proof, TxKernel::Ptr* ppRes, const Merkle::Hash& idKrn)
 {
 	Height h = m_DB.FindKernel(idKrn);
@@ -1963,6 +2103,22 @@ Height NodeProcessor::get_ProofKernel(Merkle::Proof& proof, TxKernel::Ptr* ppRes
 
 	uint64_t rowid = FindActiveAtStrict(h);
 
+	if (!ppRes)
+	{
+		// fast path: the kernels MMR was saved when the block was applied, no need to read the block
+		ByteBuffer buf;
+		KrnFlatMmr mmr;
+		if (m_DB.get_StateKrnMmr(rowid, buf) && mmr.Init(buf))
+		{
+			uint64_t iTrg = mmr.Find(idKrn);
+			if (uint64_t(-1) == iTrg)
+				OnCorrupted();
+
+			mmr.get_Proof(proof, iTrg);
+			return h;
+		}
+	}
+
 	ByteBuffer bbE;
 	m_DB.GetStateBlock(rowid, nullptr, &bbE, nullptr);
 
@@ -2264,9 +2420,9 @@ struct NodeProcessor::MyRecognizer
 			event = static_cast<NodeDB::AssetEvt>(wlk);
 		}
 
-		void InsertEvent(Height h, const Blob& b, const Blob& key) override
+		void InsertEvent(Height h, const Blob& b, const Blob& key, uint32_t iOwner) override
 		{
-			m_Proc.m_DB.InsertEvent(h, b, key);
+			m_Proc.m_DB.InsertEvent(h, b, key, iOwner);
 		}
 
 		bool FindEvents(const Blob& key, Recognizer::IEventHandler& h) override
@@ -2274,7 +2430,7 @@ struct NodeProcessor::MyRecognizer
 			NodeDB::WalkerEvent wlk;
 			for (m_Proc.m_DB.FindEvents(wlk, key); wlk.MoveNext(); )
 			{
-				if (h.OnEvent(wlk.m_Height, wlk.m_Body))
+				if (h.OnEvent(wlk.m_Height, wlk.m_Body, wlk.m_iOwner))
 					return true;
 			}
 
@@ -2447,6 +2603,9 @@ bool NodeProcessor::HandleBlock(const NodeDB::StateID& sid, const Block::SystemS
 		Blob blobRB(bic.m_Rollback);
 		m_DB.set_StateTxosAndExtra(sid.m_Row, &m_Extra.m_Txos, &blobExtra, &blobRB);
 
+		if (bFirstTime)
+			SaveKrnMmr(sid.m_Row, block);
+
 		std::vector<NodeDB::StateInput> v;
 		v.reserve(block.m_vInputs.size());
 
@@ -2512,9 +2671,10 @@ bool NodeProcessor::Recognizer::FindEvent(const TKey& key, TEvt& evt)
 		:public Recognizer::IEventHandler
 	{
 		TEvt& m_Evt;
-		MyHandler(TEvt& x) :m_Evt(x) {}
+		uint32_t& m_iOwner;
+		MyHandler(TEvt& x, uint32_t& iOwner) :m_Evt(x), m_iOwner(iOwner) {}
 
-		bool OnEvent(Height, const Blob& body) override
+		bool OnEvent(Height, const Blob& body, uint32_t iOwner) override
 		{
 			Deserializer der;
 
@@ -2526,10 +2686,11 @@ bool NodeProcessor::Recognizer::FindEvent(const TKey& key, TEvt& evt)
 				return false;
 
 			der & m_Evt;
+			m_iOwner = iOwner;
 			return true;
 		}
 
-	} h(evt);
+	} h(evt, m_iOwner);
 
 	return m_Handler.FindEvents(Blob(&key, sizeof(key)), h);
 }
@@ -2542,7 +2703,7 @@ void NodeProcessor::Recognizer::AddEventInternal(Height h, EventKey::IndexType n
 	ser & TEvt::s_Type;
 	ser & evt;
 
-	m_Handler.InsertEvent(h, Blob(ser.buffer().first, static_cast<uint32_t>(ser.buffer().second)), key);
+	m_Handler.InsertEvent(h, Blob(ser.buffer().first, static_cast<uint32_t>(ser.buffer().second)), key, m_iOwner);
 	m_Handler.OnEvent(h, evt);
 }
 
@@ -2573,11 +2734,9 @@ void NodeProcessor::Recognizer::Recognize(const TxVectors::Full& block, Height h
 
 	NodeProcessor::ViewerKeys vk;
 	m_Handler.get_ViewerKeys(vk);
-	if (vk.m_pMw)
-	{
-		for (size_t i = 0; i < block.m_vOutputs.size(); i++)
-			Recognize(*block.m_vOutputs[i], height, *vk.m_pMw);
-	}
+
+	for (size_t i = 0; i < block.m_vOutputs.size(); i++)
+		Recognize(*block.m_vOutputs[i], height, vk);
 
 	if (!vk.IsEmpty())
 	{
@@ -2680,6 +2839,13 @@ void NodeProcessor::Recognizer::Recognize(const TxKernelShieldedOutput& v, Heigh
 	ViewerKeys vk;
 	m_Handler.get_ViewerKeys(vk);
 
+	for (m_iOwner = 0; m_iOwner < vk.get_Owners(); m_iOwner++)
+		if (Recognize(v, h, nKrnIdx, nID, vk.get_Owner(m_iOwner)))
+			break;
+}
+
+bool NodeProcessor::Recognizer::Recognize(const TxKernelShieldedOutput& v, Height h, uint32_t nKrnIdx, TxoID nID, const ViewerKeys& vk)
+{
 	for (Key::Index nIdx = 0; nIdx < vk.m_nSh; nIdx++)
 	{
 		const ShieldedTxo& txo = v.m_Txo;
@@ -2704,22 +2870,36 @@ void NodeProcessor::Recognizer::Recognize(const TxKernelShieldedOutput& v, Heigh
 		key.m_Y |= EventKey::s_FlagShielded;
 
 		AddEvent(h, EventKey::s_IdxKernel + nKrnIdx, evt, key);
-		break;
+		return true;
+	}
+
+	return false;
+}
+
+void NodeProcessor::Recognizer::Recognize(const Output& x, Height h, const ViewerKeys& vk)
+{
+	// the output is tested against all the owners in a single pass
+	for (m_iOwner = 0; m_iOwner < vk.get_Owners(); m_iOwner++)
+	{
+		Key::IPKdf* pMw = vk.get_Owner(m_iOwner).m_pMw;
+		if (pMw && Recognize(x, h, *pMw))
+			break;
 	}
 }
 
-void NodeProcessor::Recognizer::Recognize(const Output& x, Height h, Key::IPKdf& keyViewer)
+bool NodeProcessor::Recognizer::Recognize(const Output& x, Height h, Key::IPKdf& keyViewer)
 {
 	CoinID cid;
 	Output::User user;
 	if (!x.Recover(h, keyViewer, cid, &user))
-		return;
+		return false;
 
 	// filter-out dummies
 	if (m_Handler.IsDummy(cid))
 	{
-		m_Handler.OnDummy(cid, h);
-		return;
+		if (!m_iOwner)
+			m_Handler.OnDummy(cid, h); // only the main owner is used for mining
+		return true;
 	}
 
 	// bingo!
@@ -2732,19 +2912,28 @@ void NodeProcessor::Recognizer::Recognize(const Output& x, Height h, Key::IPKdf&
 
 	const EventKey::Utxo& key = x.m_Commitment;
 	AddEvent(h, EventKey::s_IdxOutput, evt, key);
+	return true;
 }
 
 void NodeProcessor::Recognizer::Recognize(const TxKernelAssetCreate& v, Height h, uint32_t nKrnIdx)
 {
 	ViewerKeys vk;
 	m_Handler.get_ViewerKeys(vk);
-	if (!vk.m_pMw)
-		return;
 
 	EventKey::AssetCtl key;
-	v.m_MetaData.get_Owner(key, *vk.m_pMw);
-	if (key != v.m_Owner)
-		return;
+	for (m_iOwner = 0; ; m_iOwner++)
+	{
+		if (m_iOwner == vk.get_Owners())
+			return;
+
+		Key::IPKdf* pMw = vk.get_Owner(m_iOwner).m_pMw;
+		if (!pMw)
+			continue;
+
+		v.m_MetaData.get_Owner(key, *pMw);
+		if (key == v.m_Owner)
+			break;
+	}
 
 	// recognized!
 	proto::Event::AssetCtl evt;
@@ -2938,7 +3127,7 @@ void NodeProcessor::get_ViewerKeys(ViewerKeys& vk)
 
 bool NodeProcessor::ViewerKeys::IsEmpty() const
 {
-	return !(m_pMw || m_nSh);
+	return !(m_pMw || m_nSh || m_nExtra);
 }
 
 void NodeProcessor::RescanOwnedTxos()
@@ -2947,25 +3136,55 @@ void NodeProcessor::RescanOwnedTxos()
 
 	MyRecognizer rec(*this);
 
+	// single pass for all the owners
 	struct TxoRecover
-		:public ITxoRecover
+		:public ITxoWalker
 	{
 		MyRecognizer& m_Rec;
+		const ViewerKeys& m_Vk;
 		uint32_t m_Total = 0;
 		uint32_t m_Unspent = 0;
 
-		TxoRecover(Key::IPKdf& key, NodeProcessor& x, MyRecognizer& rec)
-			:ITxoRecover(key)
-			,m_Rec(rec)
+		TxoRecover(const ViewerKeys& vk, MyRecognizer& rec)
+			:m_Rec(rec)
+			,m_Vk(vk)
+		{
+		}
+
+		virtual bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate) override
+		{
+			if (TxoIsNaked(wlk.m_Value))
+				return true;
+
+			return ITxoWalker::OnTxo(wlk, hCreate);
+		}
+
+		virtual bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate, Output& outp) override
 		{
+			uint32_t& iOwner = m_Rec.m_Recognizer.m_iOwner;
+			for (iOwner = 0; iOwner < m_Vk.get_Owners(); iOwner++)
+			{
+				Key::IPKdf* pMw = m_Vk.get_Owner(iOwner).m_pMw;
+
+				CoinID cid;
+				Output::User user;
+				if (pMw && outp.Recover(hCreate, *pMw, cid, &user))
+				{
+					OnRecovered(wlk, hCreate, outp, cid, user);
+					break;
+				}
+			}
+
+			return true;
 		}
 
-		virtual bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate, Output& outp, const CoinID& cid, const Output::User& user) override
+		void OnRecovered(const NodeDB::WalkerTxo& wlk, Height hCreate, Output& outp, const CoinID& cid, const Output::User& user)
 		{
 			if (IsDummy(cid))
 			{
-				m_Rec.m_Handler.m_Proc.OnDummy(cid, hCreate);
-				return true;
+				if (!m_Rec.m_Recognizer.m_iOwner)
+					m_Rec.m_Handler.m_Proc.OnDummy(cid, hCreate);
+				return;
 			}
 
 			proto::Event::Utxo evt;
@@ -2987,19 +3206,22 @@ void NodeProcessor::RescanOwnedTxos()
 				evt.m_Flags = 0;
 				m_Rec.m_Recognizer.AddEvent(wlk.m_SpendHeight, EventKey::s_IdxInput, evt);
 			}
-
-			return true;
 		}
 	};
 
 	ViewerKeys vk;
 	get_ViewerKeys(vk);
 
-	if (vk.m_pMw)
+	bool bMw = false;
+	for (uint32_t iOwner = 0; iOwner < vk.get_Owners(); iOwner++)
+		if (vk.get_Owner(iOwner).m_pMw)
+			bMw = true;
+
+	if (bMw)
 	{
-		LOG_INFO() << "Rescanning owned Txos...";
+		LOG_INFO() << "Rescanning owned Txos, owners=" << vk.get_Owners();
 
-		TxoRecover wlk(*vk.m_pMw, *this, rec);
+		TxoRecover wlk(vk, rec);
 		EnumTxos(wlk);
 
 		LOG_INFO() << "Recovered " << wlk.m_Unspent << "/" << wlk.m_Total << " unspent/total Txos";
@@ -4559,6 +4781,180 @@ void NodeProcessor::ManualRollbackTo(Height h)
 		OnNewState();
 }
 
+void NodeProcessor::ExportSnapshot(const char* szPath, Height h)
+{
+	if (IsFastSync())
+		throw std::runtime_error("Can't export snapshot during fast-sync");
+
+	if (!h)
+		h = m_Cursor.m_ID.m_Height;
+
+	if ((h < Rules::HeightGenesis) || (h > m_Cursor.m_ID.m_Height) || (h < m_Extra.m_TxoHi) || (h < m_Extra.m_Fossil))
+	{
+		std::ostringstream os;
+		os << "Can't export snapshot at Height " << h << ", available range: " << std::max(m_Extra.m_TxoHi, m_Extra.m_Fossil) << "-" << m_Cursor.m_ID.m_Height;
+		throw std::runtime_error(os.str());
+	}
+
+	LOG_INFO() << "Exporting snapshot at " << h << "...";
+
+	if (m_DbTx.IsInProgress())
+		CommitMappingAndDB();
+
+	m_DB.VacuumInto(szPath);
+	m_DbTx.Start(m_DB);
+
+	std::string sPathMapping;
+	get_MappingPath(sPathMapping, szPath);
+
+	try
+	{
+		NodeProcessor np;
+		np.m_Horizon.SetInfinite(); // nothing should be pruned before the rollback
+		np.Initialize(szPath);
+		np.TrimForSnapshot(h);
+	}
+	catch (...)
+	{
+		DeleteFile(szPath);
+		DeleteFile(sPathMapping.c_str());
+		throw;
+	}
+
+	DeleteFile(sPathMapping.c_str()); // would be rebuilt on import anyway
+
+	LOG_INFO() << "Snapshot exported";
+}
+
+void NodeProcessor::TrimForSnapshot(Height h)
+{
+	if (m_Cursor.m_ID.m_Height > h)
+	{
+		NodeDB::StateID sidTop = m_Cursor.m_Sid;
+		RollbackTo(h);
+		DeleteBlocksInRange(sidTop, h);
+	}
+
+	// leave only the active branch
+	while (true)
+	{
+		uint64_t rowid = 0;
+		{
+			NodeDB::WalkerState ws;
+			for (m_DB.EnumTips(ws); ws.MoveNext(); )
+			{
+				if (!(NodeDB::StateFlags::Active & m_DB.GetStateFlags(ws.m_Sid.m_Row)))
+				{
+					rowid = ws.m_Sid.m_Row;
+					break;
+				}
+			}
+		}
+
+		if (!rowid)
+			break;
+
+		while (rowid && !(NodeDB::StateFlags::Active & m_DB.GetStateFlags(rowid)))
+			if (!m_DB.DeleteState(rowid, rowid))
+				break;
+	}
+
+	m_Horizon.m_Branching = 0;
+	m_Horizon.m_Sync.Lo = 0;
+	m_Horizon.m_Sync.Hi = 0;
+	m_Horizon.m_Local.Lo = 0;
+	m_Horizon.m_Local.Hi = 0;
+	m_Horizon.Normalize();
+
+	PruneOld();
+
+	m_DB.DeleteLocalData();
+	CommitDB();
+	Vacuum();
+}
+
+void NodeProcessor::ImportSnapshot(const char* szSnapshot, const char* szPath)
+{
+	LOG_INFO() << "Importing snapshot...";
+
+	std::string sPathMapping;
+	get_MappingPath(sPathMapping, szPath);
+
+	{
+		std::FStream fIn;
+		fIn.Open(szSnapshot, true, true);
+
+		std::FStream fOut;
+		if (fOut.Open(szPath, true))
+			throw std::runtime_error("Node data already exists, snapshot import aborted");
+
+		fOut.Open(szPath, false, true);
+
+		std::vector<uint8_t> vBuf(1024 * 1024);
+		while (true)
+		{
+			size_t n = static_cast<size_t>(std::min<uint64_t>(vBuf.size(), fIn.get_Remaining()));
+			if (!n)
+				break;
+
+			fIn.read(&vBuf.front(), n);
+			fOut.write(&vBuf.front(), n);
+		}
+	}
+
+	try
+	{
+		DeleteFile(sPathMapping.c_str()); // stale image, if any
+
+		// Initialize rebuilds the mapped image from the Txo/contract data, and tests it vs the cursor definition
+		NodeProcessor np;
+		np.Initialize(szPath);
+
+		if (np.m_Cursor.m_ID.m_Height < Rules::HeightGenesis)
+			throw std::runtime_error("Snapshot is empty");
+
+		// header chain from the cursor down to the genesis: PoW, links and chainwork
+		NodeDB::StateID sid = np.m_Cursor.m_Sid;
+		Block::SystemState::Full s = np.m_Cursor.m_Full;
+
+		while (true)
+		{
+			if (!s.IsValid())
+				OnCorrupted();
+
+			if (!np.m_DB.get_Prev(sid))
+			{
+				Difficulty::Raw wrk;
+				wrk = Zero;
+				wrk = wrk + s.m_PoW.m_Difficulty;
+
+				if ((s.m_Height != Rules::HeightGenesis) || (s.m_Prev != Rules::get().Prehistoric) || (s.m_ChainWork != wrk))
+					OnCorrupted();
+				break;
+			}
+
+			Block::SystemState::Full sPrev;
+			np.m_DB.get_State(sid.m_Row, sPrev);
+
+			Merkle::Hash hvPrev;
+			sPrev.get_Hash(hvPrev);
+
+			if ((s.m_Height != sPrev.m_Height + 1) || (s.m_Prev != hvPrev) || (s.m_ChainWork != sPrev.m_ChainWork + s.m_PoW.m_Difficulty))
+				OnCorrupted();
+
+			s = sPrev;
+		}
+
+		LOG_INFO() << "Snapshot imported, Height=" << np.m_Cursor.m_ID.m_Height;
+	}
+	catch (...)
+	{
+		DeleteFile(szPath);
+		DeleteFile(sPathMapping.c_str());
+		throw;
+	}
+}
+
 NodeProcessor::DataStatus::Enum NodeProcessor::OnStateInternal(const Block::SystemState::Full& s, Block::SystemState::ID& id, bool bAlreadyChecked)
 {
 	s.get_ID(id);
@@ -4668,6 +5064,8 @@ NodeProcessor::DataStatus::Enum NodeProcessor::OnTreasury(const Blob& blob)
 	if (!HandleTreasury(blob))
 		return DataStatus::Invalid;
 
+	m_ProofCache.Reset();
+
 	m_Extra.m_Txos++;
 	m_Extra.m_TxosTreasury = m_Extra.m_Txos;
 	m_DB.ParamSet(NodeDB::ParamID::Treasury, &m_Extra.m_TxosTreasury, &blob);
@@ -5020,15 +5418,77 @@ size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretC
 	}
 
 	size_t nTxNum = 0;
+	TxPool::Fluff& txp = bc.m_TxPool;
+	TxPool::Fluff::Template& tpl = txp.m_Template;
 
-	for (TxPool::Fluff::ProfitSet::iterator it = bc.m_TxPool.m_setProfit.begin(); bc.m_TxPool.m_setProfit.end() != it; )
+	// Reuse the previously selected txs if possible. They're applied all at once, and only the txs that arrived since then are examined.
+	// Fall back to the full selection if a fresh tx that outranks the template won't fit.
+	std::vector<TxPool::Fluff::Element*> vFresh;
+	bool bIncremental = tpl.m_bValid && (tpl.m_Tip == m_Cursor.m_ID);
+	if (bIncremental)
 	{
-		TxPool::Fluff::Element& x = (it++)->get_ParentObj();
+		size_t nSizeOutranking = ssc.m_Counter.m_Value + tpl.m_nSize + m_nSizeUtxoComission;
+
+		vFresh.reserve(tpl.m_lstFresh.size());
+		for (TxPool::Fluff::TemplateList::iterator it = tpl.m_lstFresh.begin(); tpl.m_lstFresh.end() != it; it++)
+		{
+			TxPool::Fluff::Element& x = it->get_ParentObj();
+			vFresh.push_back(&x);
+
+			if (tpl.IsOutranked(x))
+				nSizeOutranking += x.m_Profit.m_nSize;
+		}
+
+		if (nSizeOutranking > nSizeMax)
+			bIncremental = false;
+	}
+
+	if (bIncremental)
+	{
+		Amount feesNext = bc.m_Fees + tpl.m_Fees;
+		size_t nSizeNext = ssc.m_Counter.m_Value + tpl.m_nSize;
+		if (!bc.m_Fees && feesNext)
+			nSizeNext += m_nSizeUtxoComission;
+
+		if ((feesNext < bc.m_Fees) || (nSizeNext > nSizeMax) || !HandleValidatedTx(tpl.m_Txs, bic))
+		{
+			bic.m_LimitExceeded = false;
+			bIncremental = false;
+		}
+		else
+		{
+			TxVectors::Writer(bc.m_Block, bc.m_Block).Dump(tpl.m_Txs.get_Reader());
+
+			bc.m_Fees = feesNext;
+			ssc.m_Counter.m_Value = nSizeNext;
+			offset += ECC::Scalar::Native(tpl.m_Txs.m_Offset);
+			nTxNum = tpl.m_nCount;
+
+			std::sort(vFresh.begin(), vFresh.end(), [](const TxPool::Fluff::Element* p0, const TxPool::Fluff::Element* p1) {
+				return p0->m_Profit < p1->m_Profit;
+			});
+		}
+	}
+
+	if (!bIncremental)
+	{
+		txp.TemplateReset();
+
+		vFresh.clear();
+		vFresh.reserve(txp.m_setProfit.size());
+		for (TxPool::Fluff::ProfitSet::iterator it = txp.m_setProfit.begin(); txp.m_setProfit.end() != it; it++)
+			vFresh.push_back(&it->get_ParentObj());
+	}
+
+	for (size_t iTx = 0; iTx < vFresh.size(); iTx++)
+	{
+		TxPool::Fluff::Element& x = *vFresh[iTx];
+		txp.TemplateDrop(x); // considered
 
 		if (AmountBig::get_Hi(x.m_Profit.m_Fee))
 		{
 			// huge fees are unsupported
-			bc.m_TxPool.Delete(x);
+			txp.Delete(x);
 			continue;
 		}
 
@@ -5048,7 +5508,7 @@ size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretC
 			{
 				// won't fit in empty block
 				LOG_INFO() << "Tx is too big.";
-				bc.m_TxPool.Delete(x);
+				txp.Delete(x);
 			}
 			continue;
 		}
@@ -5067,21 +5527,34 @@ size_t NodeProcessor::GenerateNewBlockInternal(BlockContext& bc, BlockInterpretC
 				ssc.m_Counter.m_Value = nSizeNext;
 				offset += ECC::Scalar::Native(tx.m_Offset);
 				++nTxNum;
+
+				txp.TemplateInclude(x);
 			}
 			else
 			{
 				if (bic.m_LimitExceeded)
 					bic.m_LimitExceeded = false; // don't delete it, leave it for the next block
 				else
-					bDelete = true;
+				{
+					if (bIncremental && tpl.IsOutranked(x))
+						tpl.m_bValid = false; // conflicts with a less profitable tx from the template. Leave it for the full selection
+					else
+						bDelete = true;
+				}
 			}
 		}
 
 		if (bDelete)
-			bc.m_TxPool.SetOutdated(x, h); // isn't available in this context
+			txp.SetOutdated(x, h); // isn't available in this context
 	}
 
-	LOG_INFO() << "GenerateNewBlock: size of block = " << ssc.m_Counter.m_Value << "; amount of tx = " << nTxNum;
+	if (!bIncremental)
+	{
+		tpl.m_bValid = true;
+		tpl.m_Tip = m_Cursor.m_ID;
+	}
+
+	LOG_INFO() << "GenerateNewBlock: size of block = " << ssc.m_Counter.m_Value << "; amount of tx = " << nTxNum << (bIncremental ? "; incremental" : "");
 
 	if (BlockContext::Mode::Assemble != bc.m_Mode)
 	{
@@ -5171,7 +5644,10 @@ bool NodeProcessor::GenerateNewBlock(BlockContext& bc)
 		bc.m_Block.m_vInputs[i]->m_Internal.m_Maturity = 0;
 
 	if (!nSizeEstimated)
+	{
+		bc.m_TxPool.m_Template.m_bValid = false;
 		return false;
+	}
 
 	if (BlockContext::Mode::Assemble == bc.m_Mode)
 	{
@@ -5194,6 +5670,7 @@ bool NodeProcessor::GenerateNewBlock(BlockContext& bc)
 	if (!bOk)
 	{
 		LOG_WARNING() << "couldn't apply block after cut-through!";
+		bc.m_TxPool.m_Template.m_bValid = false;
 		return false; // ?!
 	}
 	GenerateNewHdr(bc);
@@ -39,91 +39,91 @@ class NodeProcessor
 	NodeDB::Transaction m_DbTx;
 
 
-	class Mapped
-	{
-		MappedFile m_Mapping;
-
-		struct Type;
-
-	protected:
-
-		template <typename T>
-		T* Allocate(uint32_t iBank)
-		{
-			return (T*) m_Mapping.Allocate(iBank, sizeof(T));
-		}
-
-	public:
-
-		struct Utxo
-			:public UtxoTree
-		{
-			virtual intptr_t get_Base() const override;
-
-			virtual Leaf* CreateLeaf() override;
-			virtual void DeleteEmptyLeaf(Leaf*) override;
-			virtual Joint* CreateJoint() override;
-			virtual void DeleteJoint(Joint*) override;
-
-			virtual MyLeaf::IDQueue* CreateIDQueue() override;
-			virtual void DeleteIDQueue(MyLeaf::IDQueue*) override;
-			virtual MyLeaf::IDNode* CreateIDNode() override;
-			virtual void DeleteIDNode(MyLeaf::IDNode*) override;
-
-			friend class Mapped;
-
-			virtual void OnDirty() override { get_ParentObj().OnDirty(); }
-
-			void EnsureReserve();
-
-			IMPLEMENT_GET_PARENT_OBJ(Mapped, m_Utxo)
-		} m_Utxo;
-
-		struct Contract
-			:public RadixHashOnlyTree
-		{
-			virtual intptr_t get_Base() const override;
-
-			virtual Leaf* CreateLeaf() override;
-			virtual void DeleteLeaf(Leaf* p) override;
-			virtual Joint* CreateJoint() override;
-			virtual void DeleteJoint(Joint*) override;
-
-			virtual void OnDirty() override { get_ParentObj().OnDirty(); }
-
-			friend class Mapped;
-
-			void EnsureReserve();
-
-			void Toggle(const Blob& key, const Blob& data, bool bAdd);
-
-			IMPLEMENT_GET_PARENT_OBJ(Mapped, m_Contract)
-		} m_Contract;
-
-		void OnDirty();
-
-		typedef Merkle::Hash Stamp;
-
-		~Mapped() { Close(); }
-
-		bool Open(const char* sz, const Stamp&);
-		bool IsOpen() const { return m_Mapping.get_Base() != nullptr; }
-
-		void Close();
-		void FlushStrict(const Stamp&);
-
-#pragma pack(push, 1)
-		struct Hdr
-		{
-			MappedFile::Offset m_Dirty; // boolean, just aligned
-			Stamp m_Stamp;
-			MappedFile::Offset m_RootUtxo;
-			MappedFile::Offset m_RootContract;
-		};
-#pragma pack(pop)
-
-		Hdr& get_Hdr();
-	};
+	class Mapped
+	{
+		MappedFile m_Mapping;
+
+		struct Type;
+
+	protected:
+
+		template <typename T>
+		T* Allocate(uint32_t iBank)
+		{
+			return (T*) m_Mapping.Allocate(iBank, sizeof(T));
+		}
+
+	public:
+
+		struct Utxo
+			:public UtxoTree
+		{
+			virtual intptr_t get_Base() const override;
+
+			virtual Leaf* CreateLeaf() override;
+			virtual void DeleteEmptyLeaf(Leaf*) override;
+			virtual Joint* CreateJoint() override;
+			virtual void DeleteJoint(Joint*) override;
+
+			virtual MyLeaf::IDQueue* CreateIDQueue() override;
+			virtual void DeleteIDQueue(MyLeaf::IDQueue*) override;
+			virtual MyLeaf::IDNode* CreateIDNode() override;
+			virtual void DeleteIDNode(MyLeaf::IDNode*) override;
+
+			friend class Mapped;
+
+			virtual void OnDirty() override { get_ParentObj().OnDirty(); }
+
+			void EnsureReserve();
+
+			IMPLEMENT_GET_PARENT_OBJ(Mapped, m_Utxo)
+		} m_Utxo;
+
+		struct Contract
+			:public RadixHashOnlyTree
+		{
+			virtual intptr_t get_Base() const override;
+
+			virtual Leaf* CreateLeaf() override;
+			virtual void DeleteLeaf(Leaf* p) override;
+			virtual Joint* CreateJoint() override;
+			virtual void DeleteJoint(Joint*) override;
+
+			virtual void OnDirty() override { get_ParentObj().OnDirty(); }
+
+			friend class Mapped;
+
+			void EnsureReserve();
+
+			void Toggle(const Blob& key, const Blob& data, bool bAdd);
+
+			IMPLEMENT_GET_PARENT_OBJ(Mapped, m_Contract)
+		} m_Contract;
+
+		void OnDirty();
+
+		typedef Merkle::Hash Stamp;
+
+		~Mapped() { Close(); }
+
+		bool Open(const char* sz, const Stamp&);
+		bool IsOpen() const { return m_Mapping.get_Base() != nullptr; }
+
+		void Close();
+		void FlushStrict(const Stamp&);
+
+#pragma pack(push, 1)
+		struct Hdr
+		{
+			MappedFile::Offset m_Dirty; // boolean, just aligned
+			Stamp m_Stamp;
+			MappedFile::Offset m_RootUtxo;
+			MappedFile::Offset m_RootContract;
+		};
+#pragma pack(pop)
+
+		Hdr& get_Hdr();
+	};
 
 
 	Mapped m_Mapped;
@@ -174,13 +174,15 @@ class NodeProcessor
 	bool HandleKernel(const TxKernel&, BlockInterpretCtx&);
 	bool HandleKernelTypeAny(const TxKernel&, BlockInterpretCtx&);
 
-#define THE_MACRO(id, name) bool HandleKernelType(const TxKernel##name&, BlockInterpretCtx&);
-	BeamKernelsAll(THE_MACRO)
-#undef THE_MACRO
+#define THE_MACRO(id, name) bool HandleKernelType(const TxKernel##name&, BlockInterpretCtx&);
+	BeamKernelsAll(THE_MACRO)
+#undef THE_MACRO
 
 	static uint64_t ProcessKrnMmr(Merkle::Mmr&, std::vector<TxKernel::Ptr>&, const Merkle::Hash& idKrn, TxKernel::Ptr* ppRes);
 
 	struct KrnFlyMmr;
+	struct KrnFlatMmr;
+	void SaveKrnMmr(uint64_t rowid, const TxVectors::Eternal&);
 
 	static const uint32_t s_TxoNakedMin = sizeof(ECC::Point); // minimal output size - commitment
 	static const uint32_t s_TxoNakedMax = s_TxoNakedMin + 0x10; // In case the output has the Incubation period - extra size is needed (actually less than this).
@@ -248,6 +250,7 @@ class NodeProcessor
 
 	void DeleteBlocksInRange(const NodeDB::StateID& sidTop, Height hStop);
 	void DeleteBlock(uint64_t);
+	void TrimForSnapshot(Height);
 
 public:
 
@@ -272,6 +275,12 @@ public:
 	bool ForbidActiveAt(Height);
 	void ManualRollbackTo(Height);
 
+	// Snapshot for the fast bootstrap: a copy of the node data at the specified height (0 = cursor), pruned to the minimal horizons.
+	// The node-specific data (own ID, peers, bbs, events) is not included.
+	void ExportSnapshot(const char* szPath, Height h = 0);
+	// Copies the snapshot into the new node data path, rebuilds the mapped image, and verifies it against the header chain
+	static void ImportSnapshot(const char* szSnapshot, const char* szPath);
+
 	struct Horizon {
 
 		// branches behind this are pruned
@@ -387,7 +396,7 @@ public:
 		}
 
 	protected:
-		virtual void OnProof(Merkle::Hash&, bool);
+		virtual void OnProof(Merkle::Hash&, bool);
 	};
 
 	struct ProofBuilderHard
@@ -401,9 +410,40 @@ public:
 		}
 
 	protected:
-		virtual void OnProof(Merkle::Hash&, bool);
+		virtual void OnProof(Merkle::Hash&, bool);
 	};
 
+	// Proof suffix from the root of the specific subtree up to the state definition. It's the same for all the proofs
+	// at the current tip, hence cached. Reset whenever the cursor moves.
+	struct ProofCache
+	{
+		struct Kind {
+			enum Enum {
+				History,
+				Utxos,
+				Shielded,
+				Assets,
+				Contracts,
+				count
+			};
+		};
+
+		Merkle::Proof m_pSuffix[Kind::count];
+		bool m_pValid[Kind::count];
+
+		struct Stats {
+			uint64_t m_Hits = 0;
+			uint64_t m_Misses = 0;
+		} m_Stats;
+
+		ProofCache() { ZeroObject(m_pValid); }
+		bool Reset(); // returns true if anything was cached
+	} m_ProofCache;
+
+	const Merkle::Proof& get_ProofSuffix(ProofCache::Kind::Enum);
+	void AppendProofSuffix(Merkle::Proof&, ProofCache::Kind::Enum);
+	void AppendProofSuffix(Merkle::HardProof&, ProofCache::Kind::Enum);
+
 	Height get_ProofKernel(Merkle::Proof&, TxKernel::Ptr*, const Merkle::Hash& idKrn);
 
 	void CommitDB();
@@ -453,11 +493,18 @@ public:
 
 	struct ViewerKeys
 	{
-		Key::IPKdf* m_pMw;
-		ShieldedTxo::Viewer* m_pSh;
-		Key::Index m_nSh;
-		
+		Key::IPKdf* m_pMw = nullptr;
+		ShieldedTxo::Viewer* m_pSh = nullptr;
+		Key::Index m_nSh = 0;
+
+		// additional owners, whose events are indexed separately (i.e. custodial node). Owner index 0 stands for the above keys, the extra owners are indexed from 1
+		const ViewerKeys* m_pExtra = nullptr;
+		uint32_t m_nExtra = 0;
+
 		bool IsEmpty() const;
+
+		uint32_t get_Owners() const { return m_nExtra + 1; }
+		const ViewerKeys& get_Owner(uint32_t iOwner) const { return iOwner ? m_pExtra[iOwner - 1] : *this; }
 	};
 
 	virtual void get_ViewerKeys(ViewerKeys&);
@@ -467,29 +514,29 @@ public:
 	uint64_t FindActiveAtStrict(Height);
 	Height FindVisibleKernel(const Merkle::Hash&, const BlockInterpretCtx&);
 
-	uint8_t ValidateTxContextEx(const Transaction&, const HeightRange&, bool bShieldedTested, uint32_t& nBvmCharge); // assuming context-free validation is already performed, but 
-	bool ValidateInputs(const ECC::Point&, Input::Count = 1);
-	bool ValidateUniqueNoDup(BlockInterpretCtx&, const Blob& key, const Blob* pVal);
-	void ManageKrnID(BlockInterpretCtx&, const TxKernel&);
-
-	bool IsShieldedInPool(const Transaction&);
-	bool IsShieldedInPool(const TxKernelShieldedInput&);
-
-	struct GeneratedBlock
-	{
-		Block::SystemState::Full m_Hdr;
-		ByteBuffer m_BodyP;
-		ByteBuffer m_BodyE;
-		Amount m_Fees;
-		Block::Body m_Block; // in/out
-	};
-
-
-	struct BlockContext
-		:public GeneratedBlock
-	{
-		TxPool::Fluff& m_TxPool;
-
+	uint8_t ValidateTxContextEx(const Transaction&, const HeightRange&, bool bShieldedTested, uint32_t& nBvmCharge); // assuming context-free validation is already performed, but 
+	bool ValidateInputs(const ECC::Point&, Input::Count = 1);
+	bool ValidateUniqueNoDup(BlockInterpretCtx&, const Blob& key, const Blob* pVal);
+	void ManageKrnID(BlockInterpretCtx&, const TxKernel&);
+
+	bool IsShieldedInPool(const Transaction&);
+	bool IsShieldedInPool(const TxKernelShieldedInput&);
+
+	struct GeneratedBlock
+	{
+		Block::SystemState::Full m_Hdr;
+		ByteBuffer m_BodyP;
+		ByteBuffer m_BodyE;
+		Amount m_Fees;
+		Block::Body m_Block; // in/out
+	};
+
+
+	struct BlockContext
+		:public GeneratedBlock
+	{
+		TxPool::Fluff& m_TxPool;
+
 		Key::Index m_SubIdx;
 		Key::IKdf& m_Coin;
 		Key::IPKdf& m_Tag;
@@ -554,9 +601,9 @@ public:
 	struct KrnWalkerShielded
 		:public IKrnWalker
 	{
-		virtual bool OnKrn(const TxKernel& krn) override;
-		virtual bool OnKrnEx(const TxKernelShieldedInput&) { return true; }
-		virtual bool OnKrnEx(const TxKernelShieldedOutput&) { return true; }
+		virtual bool OnKrn(const TxKernel& krn) override;
+		virtual bool OnKrnEx(const TxKernelShieldedInput&) { return true; }
+		virtual bool OnKrnEx(const TxKernelShieldedOutput&) { return true; }
 	};
 
 	struct Recognizer;
@@ -566,7 +613,7 @@ public:
 		Recognizer& m_Proc;
 		KrnWalkerRecognize(Recognizer& p) :m_Proc(p) {}
 
-		virtual bool OnKrn(const TxKernel& krn) override;
+		virtual bool OnKrn(const TxKernel& krn) override;
 	};
 
 #pragma pack (push, 1)
@@ -590,15 +637,15 @@ public:
 
 	struct ShieldedBase
 	{
-		uintBigFor<TxoID>::Type m_MmrIndex;
-		uintBigFor<Height>::Type m_Height;
+		uintBigFor<TxoID>::Type m_MmrIndex;
+		uintBigFor<Height>::Type m_Height;
 	};
 
 	struct ShieldedOutpPacked
 		:public ShieldedBase
 	{
-		ECC::Point m_Commitment;
-		uintBigFor<TxoID>::Type m_TxoID;
+		ECC::Point m_Commitment;
+		uintBigFor<TxoID>::Type m_TxoID;
 	};
 
 	struct ShieldedInpPacked
@@ -625,7 +672,7 @@ public:
 		struct IEventHandler
 		{
 			// returns true to stop enumeration
-			virtual bool OnEvent(Height, const Blob& body) = 0;
+			virtual bool OnEvent(Height, const Blob& body, uint32_t iOwner) = 0;
 		};
 
 		struct IHandler
@@ -641,15 +688,18 @@ public:
 			virtual void OnDummy(const CoinID&, Height) {}
 			virtual void OnEvent(Height, const proto::Event::Base&) {}
 			virtual void AssetEvtsGetStrict(NodeDB::AssetEvt& event, Height h, uint32_t nKrnIdx) {}
-			virtual void InsertEvent(Height h, const Blob& b, const Blob& key) {}
-			virtual bool FindEvents(const Blob& key, IEventHandler&) { return false; }
+			virtual void InsertEvent(Height h, const Blob& b, const Blob& key, uint32_t iOwner) {}
+			virtual bool FindEvents(const Blob& key, IEventHandler&) { return false; } // all owners
 		};
 		Recognizer(IHandler& h, Extra& extra);
 
+		uint32_t m_iOwner = 0; // owner of the added events. Set by FindEvent to the owner of the found one
+
 		void Recognize(const TxVectors::Full& block, Height height, uint32_t shieldedOuts, bool validateShieldedOuts = true);
 
 		void Recognize(const Input&, Height);
-		void Recognize(const Output&, Height, Key::IPKdf&);
+		bool Recognize(const Output&, Height, Key::IPKdf&);
+		void Recognize(const Output&, Height, const ViewerKeys&); // tries all the owners
 
 #define THE_MACRO(id, name) void Recognize(const TxKernel##name&, Height, uint32_t);
 		BeamKernelsAll(THE_MACRO)
@@ -667,6 +717,8 @@ public:
 		template <typename TEvt>
 		void AddEventInternal(Height, EventKey::IndexType nIdx, const TEvt&, const Blob& key);
 
+		bool Recognize(const TxKernelShieldedOutput&, Height, uint32_t nKrnIdx, TxoID, const ViewerKeys&);
+
 		IHandler& m_Handler;
 		Extra& m_Extra;
 	};
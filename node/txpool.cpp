@@ -86,6 +86,10 @@ void TxPool::Fluff::InternalInsert(Element& x)
 	{
 		m_setTxs.insert(x.m_Tx);
 		m_setProfit.insert(x.m_Profit);
+
+		assert(Element::Template::State::None == x.m_Template.m_State);
+		x.m_Template.m_State = Element::Template::State::Fresh;
+		m_Template.m_lstFresh.push_back(x.m_Template);
 	}
 }
 
@@ -97,9 +101,75 @@ void TxPool::Fluff::InternalErase(Element& x)
 	{
 		m_setTxs.erase(TxSet::s_iterator_to(x.m_Tx));
 		m_setProfit.erase(ProfitSet::s_iterator_to(x.m_Profit));
+
+		if (Element::Template::State::Included == x.m_Template.m_State)
+			m_Template.m_bValid = false;
+		TemplateDrop(x);
+	}
+}
+
+bool TxPool::Fluff::Template::IsOutranked(const Element& x) const
+{
+	return !m_nCount || (x.m_Profit < m_Worst);
+}
+
+void TxPool::Fluff::TemplateDrop(Element& x)
+{
+	switch (x.m_Template.m_State)
+	{
+	case Element::Template::State::Fresh:
+		m_Template.m_lstFresh.erase(TemplateList::s_iterator_to(x.m_Template));
+		break;
+
+	case Element::Template::State::Included:
+		m_Template.m_lstIncluded.erase(TemplateList::s_iterator_to(x.m_Template));
+		break;
+
+	default: // suppress warning
+		break;
+	}
+
+	x.m_Template.m_State = Element::Template::State::None;
+}
+
+void TxPool::Fluff::TemplateInclude(Element& x)
+{
+	TemplateDrop(x);
+	x.m_Template.m_State = Element::Template::State::Included;
+	m_Template.m_lstIncluded.push_back(x.m_Template);
+
+	Transaction& tx = *x.m_pValue;
+	TxVectors::Writer(m_Template.m_Txs, m_Template.m_Txs).Dump(tx.get_Reader());
+	m_Template.m_Txs.m_Offset = ECC::Scalar::Native(m_Template.m_Txs.m_Offset) + ECC::Scalar::Native(tx.m_Offset);
+
+	m_Template.m_Fees += AmountBig::get_Lo(x.m_Profit.m_Fee);
+	m_Template.m_nSize += x.m_Profit.m_nSize;
+
+	if (!m_Template.m_nCount++ || (m_Template.m_Worst < x.m_Profit))
+	{
+		m_Template.m_Worst.m_Fee = x.m_Profit.m_Fee;
+		m_Template.m_Worst.m_nSize = x.m_Profit.m_nSize;
+		m_Template.m_Worst.m_nSizeCorrected = x.m_Profit.m_nSizeCorrected;
 	}
 }
 
+void TxPool::Fluff::TemplateReset()
+{
+	while (!m_Template.m_lstIncluded.empty())
+		TemplateDrop(m_Template.m_lstIncluded.front().get_ParentObj());
+	while (!m_Template.m_lstFresh.empty())
+		TemplateDrop(m_Template.m_lstFresh.front().get_ParentObj());
+
+	m_Template.m_bValid = false;
+	m_Template.m_Txs.m_vInputs.clear();
+	m_Template.m_Txs.m_vOutputs.clear();
+	m_Template.m_Txs.m_vKernels.clear();
+	m_Template.m_Txs.m_Offset = Zero;
+	m_Template.m_Fees = 0;
+	m_Template.m_nSize = 0;
+	m_Template.m_nCount = 0;
+}
+
 void TxPool::Fluff::Delete(Element& x)
 {
 	assert(x.m_pValue);
@@ -162,28 +232,102 @@ bool TxPool::Stem::TryMerge(Element& trg, Element& src)
 
 	auto fees = trg.m_Profit.m_Fee;
 	fees += src.m_Profit.m_Fee;
+
+	const Merkle::Hash& hvTip = get_Tip();
+	bool bPartsValid =
+		(trg.m_Tip == hvTip) &&
+		(src.m_Tip == hvTip) &&
+		!HaveCommonInputs(*trg.m_pValue, *src.m_pValue);
+
 	Amount feeReserve = 0;
-	if (!ValidateTxContext(txNew, hr, fees, feeReserve))
+	if (!ValidateTxContext(txNew, hr, fees, feeReserve, bPartsValid))
+	{
+		m_Stats.m_MergeFailed++;
 		return false; // conflicting txs, can't merge
+	}
 
-	trg.m_Profit.m_Fee += fees;
-	trg.m_Profit.SetSize(txNew, trg.m_Profit.get_Correction() + src.m_Profit.get_Correction());
+	m_Stats.m_Merged++;
+	if (bPartsValid)
+		m_Stats.m_MergedIncremental++;
 
 	Delete(src);
 	DeleteKrn(trg);
 
+	// the sort keys are about to change
+	m_setProfit.erase(ProfitSet::s_iterator_to(trg.m_Profit));
+	m_setOutputs.erase(OutputsSet::s_iterator_to(trg.m_Outputs));
+
+	trg.m_Profit.m_Fee = fees;
+	trg.m_Profit.SetSize(txNew, trg.m_Profit.get_Correction() + src.m_Profit.get_Correction());
+
 	trg.m_pValue->m_vInputs.swap(txNew.m_vInputs);
 	trg.m_pValue->m_vOutputs.swap(txNew.m_vOutputs);
 	trg.m_pValue->m_vKernels.swap(txNew.m_vKernels);
 	trg.m_pValue->m_Offset = txNew.m_Offset;
 	trg.m_FeeReserve = feeReserve;
 	trg.m_Height = hr;
+	trg.m_Tip = hvTip;
+	trg.m_Outputs.m_Count = static_cast<uint32_t>(trg.m_pValue->m_vOutputs.size());
 
+	m_setProfit.insert(trg.m_Profit);
+	m_setOutputs.insert(trg.m_Outputs);
 	InsertKrn(trg);
 
 	return true;
 }
 
+bool TxPool::Stem::HaveCommonInputs(const Transaction& tx0, const Transaction& tx1)
+{
+	// both are normalized, inputs are sorted
+	for (size_t i0 = 0, i1 = 0; (i0 < tx0.m_vInputs.size()) && (i1 < tx1.m_vInputs.size()); )
+	{
+		int n = tx0.m_vInputs[i0]->m_Commitment.cmp(tx1.m_vInputs[i1]->m_Commitment);
+		if (!n)
+			return true;
+
+		if (n < 0)
+			i0++;
+		else
+			i1++;
+	}
+
+	return false;
+}
+
+void TxPool::Stem::Aggregate(Element& x, uint32_t nOutputsMax)
+{
+	assert(x.m_bAggregating);
+
+	std::vector<const Element*> vFailed; // won't merge later either, the tx only grows
+
+	while (true)
+	{
+		uint32_t nOuts = static_cast<uint32_t>(x.m_pValue->m_vOutputs.size());
+		if (nOuts >= nOutputsMax)
+			break;
+
+		// the last one with the most outputs that still fit
+		OutputsSet::iterator it = m_setOutputs.upper_bound(nOutputsMax - nOuts, Element::Outputs::Comparator());
+
+		Element* pSrc = nullptr;
+		while (m_setOutputs.begin() != it)
+		{
+			Element& y = (--it)->get_ParentObj();
+			if ((&y != &x) && (vFailed.end() == std::find(vFailed.begin(), vFailed.end(), &y)))
+			{
+				pSrc = &y;
+				break;
+			}
+		}
+
+		if (!pSrc)
+			break;
+
+		if (!TryMerge(x, *pSrc))
+			vFailed.push_back(pSrc);
+	}
+}
+
 void TxPool::Stem::Delete(Element& x)
 {
 	uint32_t n_ms;
@@ -221,7 +365,10 @@ void TxPool::Stem::InsertAggr(Element& x)
 	if (!x.m_bAggregating)
 	{
 		x.m_bAggregating = true;
+		x.m_AggregationStart_ms = GetTime_ms();
+		x.m_Outputs.m_Count = static_cast<uint32_t>(x.m_pValue->m_vOutputs.size());
 		m_setProfit.insert(x.m_Profit);
+		m_setOutputs.insert(x.m_Outputs);
 	}
 }
 
@@ -230,10 +377,34 @@ void TxPool::Stem::DeleteAggr(Element& x)
 	if (x.m_bAggregating)
 	{
 		m_setProfit.erase(ProfitSet::s_iterator_to(x.m_Profit));
+		m_setOutputs.erase(OutputsSet::s_iterator_to(x.m_Outputs));
 		x.m_bAggregating = false;
 	}
 }
 
+void TxPool::Stem::FinishAggr(Element& x)
+{
+	if (x.m_bAggregating)
+	{
+		uint32_t dt_ms = GetTime_ms() - x.m_AggregationStart_ms;
+
+		m_Stats.m_Aggregated++;
+		m_Stats.m_AggregationTotal_ms += dt_ms;
+		std::setmax(m_Stats.m_AggregationMax_ms, dt_ms);
+
+		DeleteAggr(x);
+	}
+}
+
+bool TxPool::Stem::Element::Outputs::operator < (const Outputs& t) const
+{
+	if (m_Count != t.m_Count)
+		return m_Count < t.m_Count;
+
+	// Profit::operator < puts the most profitable first
+	return t.get_ParentObj().m_Profit < get_ParentObj().m_Profit;
+}
+
 void TxPool::Stem::DeleteTimer(Element& x)
 {
 	if (x.m_Time.m_Value)
@@ -75,6 +75,19 @@ struct TxPool
 				IMPLEMENT_GET_PARENT_OBJ(Element, m_Queue)
 			} m_Queue;
 
+			struct Template
+				:public boost::intrusive::list_base_hook<>
+			{
+				enum State {
+					None,
+					Fresh, // arrived after the template was assembled
+					Included
+				};
+
+				State m_State = State::None;
+				IMPLEMENT_GET_PARENT_OBJ(Element, m_Template)
+			} m_Template;
+
 			bool IsOutdated() const { return MaxHeight != m_Outdated.m_Height; }
 		};
 
@@ -82,12 +95,37 @@ struct TxPool
 		typedef boost::intrusive::multiset<Element::Profit> ProfitSet;
 		typedef boost::intrusive::multiset<Element::Outdated> OutdatedSet;
 		typedef boost::intrusive::list<Element::Queue> Queue;
+		typedef boost::intrusive::list<Element::Template> TemplateList;
 
 		TxSet m_setTxs;
 		ProfitSet m_setProfit;
 		OutdatedSet m_setOutdated;
 		Queue m_Queue;
 
+		// The txs selected for the last generated block, maintained incrementally as the pool changes.
+		// Valid as long as none of the included txs left the pool, and only on top of the same tip.
+		struct Template
+		{
+			bool m_bValid = false;
+			Block::SystemState::ID m_Tip;
+
+			Transaction m_Txs; // included txs combined, with the summed offset
+			Amount m_Fees = 0;
+			size_t m_nSize = 0;
+			uint32_t m_nCount = 0;
+			TxPool::Profit m_Worst; // the least profitable included tx
+
+			TemplateList m_lstIncluded;
+			TemplateList m_lstFresh;
+
+			bool IsOutranked(const Element&) const; // would be picked before one of the included txs
+
+		} m_Template;
+
+		void TemplateReset();
+		void TemplateInclude(Element&);
+		void TemplateDrop(Element&);
+
 		Element* AddValidTx(Transaction::Ptr&&, const Transaction::Context&, const Transaction::KeyType&, uint32_t nSizeCorrection);
 		void SetOutdated(Element&, Height);
 		void Delete(Element&);
@@ -126,6 +164,22 @@ struct TxPool
 				IMPLEMENT_GET_PARENT_OBJ(Element, m_Profit)
 			} m_Profit;
 
+			struct Outputs
+				:public boost::intrusive::set_base_hook<>
+			{
+				uint32_t m_Count;
+
+				// by the number of outputs, the most profitable last
+				bool operator < (const Outputs& t) const;
+
+				struct Comparator {
+					bool operator()(uint32_t n, const Outputs& x) const { return n < x.m_Count; }
+					bool operator()(const Outputs& x, uint32_t n) const { return x.m_Count < n; }
+				};
+
+				IMPLEMENT_GET_PARENT_OBJ(Element, m_Outputs)
+			} m_Outputs;
+
 			struct Kernel
 				:public boost::intrusive::set_base_hook<>
 			{
@@ -136,6 +190,8 @@ struct TxPool
 
 			HeightRange m_Height;
 			Amount m_FeeReserve;
+			Merkle::Hash m_Tip; // the tx context was validated on top of it
+			uint32_t m_AggregationStart_ms;
 
 			std::vector<Kernel> m_vKrn;
 		};
@@ -143,10 +199,23 @@ struct TxPool
 		typedef boost::intrusive::multiset<Element::Kernel> KrnSet;
 		typedef boost::intrusive::multiset<Element::Time> TimeSet;
 		typedef boost::intrusive::multiset<Element::Profit> ProfitSet;
+		typedef boost::intrusive::multiset<Element::Outputs> OutputsSet;
 
 		KrnSet m_setKrns;
 		TimeSet m_setTime;
 		ProfitSet m_setProfit;
+		OutputsSet m_setOutputs; // same elements as in m_setProfit, to pick the merge candidates
+
+		struct Stats
+		{
+			uint64_t m_Merged = 0;
+			uint64_t m_MergedIncremental = 0; // the context of the merged parts wasn't re-validated
+			uint64_t m_MergeFailed = 0;
+
+			uint64_t m_Aggregated = 0; // txs that finished the aggregation
+			uint64_t m_AggregationTotal_ms = 0;
+			uint32_t m_AggregationMax_ms = 0;
+		} m_Stats;
 
 		void Delete(Element&);
 		void Clear();
@@ -154,10 +223,15 @@ struct TxPool
 		void DeleteKrn(Element&);
 		void InsertAggr(Element&);
 		void DeleteAggr(Element&);
+		void FinishAggr(Element&); // same as DeleteAggr, accounted in the stats
 		void DeleteTimer(Element&);
 
 		bool TryMerge(Element& trg, Element& src);
 
+		// Merges the candidates into the tx while it has room. Picks the ones with the most outputs that still fit,
+		// the most profitable first.
+		void Aggregate(Element&, uint32_t nOutputsMax);
+
 		Element* get_NextTimeout(uint32_t& nTimeout_ms);
 		void SetTimer(uint32_t nTimeout_ms, Element&);
 		void KillTimer();
@@ -167,12 +241,16 @@ struct TxPool
 
 		~Stem() { Clear(); }
 
-		virtual bool ValidateTxContext(const Transaction&, const HeightRange&, const AmountBig::Type& fees, Amount& feeReserve) = 0; // assuming context-free validation is already performed, but 
+		// assuming context-free validation is already performed. If bPartsValid - the tx is a merge of non-conflicting
+		// parts, each validated on top of the current tip, only the height range and the fee reserve are left to check
+		virtual bool ValidateTxContext(const Transaction&, const HeightRange&, const AmountBig::Type& fees, Amount& feeReserve, bool bPartsValid) = 0;
+		virtual const Merkle::Hash& get_Tip() = 0;
 		virtual void OnTimedOut(Element&) = 0;
 
 	private:
 		void DeleteRaw(Element&);
 		void SetTimerRaw(uint32_t nTimeout_ms);
+		static bool HaveCommonInputs(const Transaction&, const Transaction&);
 	};
 };
 
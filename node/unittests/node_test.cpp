@@ -18,12 +18,12 @@
 #include "../db.h"
 #include "../processor.h"
 #include "../../core/fly_client.h"
-#include "../../core/serialization_adapters.h"
+#include "../../core/serialization_adapters.h"
 #include "../../core/treasury.h"
 #include "../../core/block_rw.h"
 #include "../../utility/test_helpers.h"
-#include "../../utility/serialize.h"
-#include "../../utility/blobmap.h"
+#include "../../utility/serialize.h"
+#include "../../utility/blobmap.h"
 #include "../../core/unittest/mini_blockchain.h"
 #include "../../bvm/bvm2.h"
 #include "../../bvm/ManagerStd.h"
@@ -168,29 +168,29 @@ namespace beam
 		Key::IKdf::Ptr pKdf;
 		ECC::SetRandom(pKdf);
 
-		PeerID pid;
-		ECC::Scalar::Native sk;
-		Treasury::get_ID(*pKdf, pid, sk);
-
-		Treasury tres;
-		Treasury::Parameters pars;
-		pars.m_Bursts = 1;
-		Treasury::Entry* pE = tres.CreatePlan(pid, Rules::get().Emission.Value0 / 5, pars);
-
-		pE->m_pResponse.reset(new Treasury::Response);
-		uint64_t nIndex = 1;
-		verify_test(pE->m_pResponse->Create(pE->m_Request, *pKdf, nIndex));
-
-		Treasury::Data data;
-		data.m_sCustomMsg = "test treasury";
-		tres.Build(data);
-
-		beam::Serializer ser;
-		ser & data;
-
-		ser.swap_buf(g_Treasury);
-
-		ECC::Hash::Processor() << Blob(g_Treasury) >> Rules::get().TreasuryChecksum;
+		PeerID pid;
+		ECC::Scalar::Native sk;
+		Treasury::get_ID(*pKdf, pid, sk);
+
+		Treasury tres;
+		Treasury::Parameters pars;
+		pars.m_Bursts = 1;
+		Treasury::Entry* pE = tres.CreatePlan(pid, Rules::get().Emission.Value0 / 5, pars);
+
+		pE->m_pResponse.reset(new Treasury::Response);
+		uint64_t nIndex = 1;
+		verify_test(pE->m_pResponse->Create(pE->m_Request, *pKdf, nIndex));
+
+		Treasury::Data data;
+		data.m_sCustomMsg = "test treasury";
+		tres.Build(data);
+
+		beam::Serializer ser;
+		ser & data;
+
+		ser.swap_buf(g_Treasury);
+
+		ECC::Hash::Processor() << Blob(g_Treasury) >> Rules::get().TreasuryChecksum;
 	}
 
 	uint32_t CountTips(NodeDB& db, bool bFunctional, NodeDB::StateID* pLast = NULL)
@@ -215,27 +215,27 @@ namespace beam
 
 	struct StoragePts
 	{
-		ECC::Point::Storage m_pArr[18];
-
-		void Init()
-		{
-			for (size_t i = 0; i < _countof(m_pArr); i++)
-			{
-				m_pArr[i].m_X = i;
-			}
-		}
-
-		bool IsValid(size_t i0, size_t i1, uint32_t n0) const
-		{
-			for (; i0 < i1; i0++)
-			{
-				if (m_pArr[i0].m_X != ECC::uintBig(n0++))
-					return false;
-			}
-
-			return true;
-		}
-	};
+		ECC::Point::Storage m_pArr[18];
+
+		void Init()
+		{
+			for (size_t i = 0; i < _countof(m_pArr); i++)
+			{
+				m_pArr[i].m_X = i;
+			}
+		}
+
+		bool IsValid(size_t i0, size_t i1, uint32_t n0) const
+		{
+			for (; i0 < i1; i0++)
+			{
+				if (m_pArr[i0].m_X != ECC::uintBig(n0++))
+					return false;
+			}
+
+			return true;
+		}
+	};
 
 	void TestNodeDB(const char* sz)
 	{
@@ -391,16 +391,16 @@ namespace beam
 			sid.m_Row = pRows[sid.m_Height - Rules::HeightGenesis];
 			db.MoveFwd(sid);
 			
-			Merkle::Hash hv;
-			if (sid.m_Height < Rules::HeightGenesis + 50) // skip it for big heights, coz it's quadratic
-			{
+			Merkle::Hash hv;
+			if (sid.m_Height < Rules::HeightGenesis + 50) // skip it for big heights, coz it's quadratic
+			{
 				for (Height h = Rules::HeightGenesis; h < sid.m_Height; h++)
 				{
 					Merkle::ProofBuilderStd bld;
 					smmr.get_Proof(bld, smmr.H2I(h));
 
-					vStates[h - Rules::HeightGenesis].get_Hash(hv);
-					Merkle::Interpret(hv, bld.m_Proof);
+					vStates[h - Rules::HeightGenesis].get_Hash(hv);
+					Merkle::Interpret(hv, bld.m_Proof);
 					verify_test(hvRoot == hv);
 				}
 			}
@@ -408,7 +408,7 @@ namespace beam
 			const Block::SystemState::Full& sTop = vStates[sid.m_Height - Rules::HeightGenesis];
 
 			hv = hvRoot;
-			Merkle::Interpret(hv, hvZero, true);
+			Merkle::Interpret(hv, hvZero, true);
 			verify_test(hv == sTop.m_Definition);
 
 			sTop.get_Hash(hv);
@@ -518,194 +518,194 @@ namespace beam
 
 		verify_test(db.GetDummyHeight(kid) == MaxHeight);
 
-		db.InsertDummy(176, kid);
-
-		kid.m_Idx = 346;
-		db.InsertDummy(568, kid);
+		db.InsertDummy(176, kid);
+
+		kid.m_Idx = 346;
+		db.InsertDummy(568, kid);
 
-		kid.m_Idx = 345;
+		kid.m_Idx = 345;
 		verify_test(db.GetDummyHeight(kid) == 176);
-
-		Height h1 = db.GetLowestDummy(kid);
-		verify_test(h1 == 176);
-		verify_test(kid.m_Idx == 345U);
-
-		db.SetDummyHeight(kid, 1055);
-
-		h1 = db.GetLowestDummy(kid);
-		verify_test(h1 == 568);
-		verify_test(kid.m_Idx == 346U);
-		
-		db.DeleteDummy(kid);
-
-		h1 = db.GetLowestDummy(kid);
-		verify_test(h1 == 1055);
-		verify_test(kid.m_Idx == 345U);
-
-		db.DeleteDummy(kid);
-
-		verify_test(MaxHeight == db.GetLowestDummy(kid));
-
-		// Kernels
-		db.InsertKernel(bBodyP, 5);
-		db.InsertKernel(bBodyP, 5); // duplicate
-		db.InsertKernel(bBodyP, 7);
-		db.InsertKernel(bBodyP, 2);
-
-		verify_test(db.FindKernel(bBodyP) == 7);
-		verify_test(db.FindKernel(bBodyE) == 0);
-
-		db.DeleteKernel(bBodyP, 7);
-		verify_test(db.FindKernel(bBodyP) == 5);
-		db.DeleteKernel(bBodyP, 5);
-		verify_test(db.FindKernel(bBodyP) == 5);
-		db.DeleteKernel(bBodyP, 2);
-		verify_test(db.FindKernel(bBodyP) == 5);
-		db.DeleteKernel(bBodyP, 5);
-		verify_test(db.FindKernel(bBodyP) == 0);
-
-		// Shielded
-		TxoID nShielded = 16 * 1024 * 3 + 5;
-		db.ShieldedResize(nShielded, 0);
-
-		StoragePts pts;
-		pts.Init();
-
-		db.ShieldedWrite(16 * 1024 * 2 - 2, pts.m_pArr, _countof(pts.m_pArr));
-
-		ZeroObject(pts.m_pArr);
-
-		db.ShieldedRead(16 * 1024 * 3 + 5 - _countof(pts.m_pArr), pts.m_pArr, _countof(pts.m_pArr));
-		verify_test(memis0(pts.m_pArr, sizeof(pts.m_pArr)));
-
-		db.ShieldedRead(16 * 1024 * 2 -2, pts.m_pArr, _countof(pts.m_pArr));
-		verify_test(pts.IsValid(0, _countof(pts.m_pArr), 0));
-
-		db.ShieldedResize(1, nShielded);
-		db.ShieldedResize(0, 1);
-
-		ECC::uintBig k1 = 223U;
-		Blob val(nullptr, 0);
-
-		verify_test(db.UniqueInsertSafe(k1, &val));
-		db.UniqueDeleteStrict(k1);
-		verify_test(db.UniqueInsertSafe(k1, nullptr));
-		verify_test(!db.UniqueInsertSafe(k1, nullptr));
-
-
-		// Assets
-		Asset::Full ai1, ai2;
-		ZeroObject(ai1);
-
-		for (uint32_t i = 1; i <= 5; i++)
-		{
-			ai1.m_ID = 0;
-			db.AssetAdd(ai1);
-			verify_test(ai1.m_ID == i);
-		}
-
-		verify_test(db.AssetDelete(5) == 4); // should shrink
-		verify_test(db.AssetDelete(3) == 4); // should retain the same size
-
-		ai2.m_ID = 3;
-		verify_test(!db.AssetGetSafe(ai2));
-		ai2.m_ID = 2;
-		verify_test(db.AssetGetSafe(ai2));
-		verify_test(ai2.m_Owner == ai1.m_Owner);
-
-		ai1.m_Owner.Inc();
-		ai1.m_Owner.Negate();
-		ai1.m_ID = 0;
-		db.AssetAdd(ai1);
-		verify_test(ai1.m_ID == 3);
-
-		AmountBig::Type assetVal1, assetVal2 = 1U;
-		ai2.m_ID = 3;
-		verify_test(db.AssetGetSafe(ai2));
-		verify_test(ai2.m_Value == Zero);
-
-		assetVal2 = 334U;
-		db.AssetSetValue(3, assetVal2, 18);
-
-		verify_test(db.AssetGetSafe(ai2));
-		verify_test(ai2.m_Value == assetVal2);
-		verify_test(ai2.m_LockHeight == 18);
-
-		ai1.m_ID = db.AssetFindByOwner(ai1.m_Owner);
-		verify_test(ai1.m_ID == 3);
-		ai1.m_Value = Zero;
-		verify_test(db.AssetGetSafe(ai1));
-		verify_test(ai1.m_Value == assetVal2);
-
-		verify_test(db.AssetDelete(2) == 4);
-		verify_test(db.AssetDelete(3) == 4);
-		verify_test(db.AssetDelete(4) == 1);
-		verify_test(db.AssetDelete(1) == 0);
-
-		// StreamMmr, test cache
-		struct MyMmr
-			:public NodeDB::StreamMmr
-		{
-			using StreamMmr::StreamMmr;
-			uint32_t m_Total = 0;
-			uint32_t m_Miss = 0;
-
-			virtual void LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const override
-			{
-				Cast::NotConst(this)->m_Total++;
-				if (!CacheFind(hv, pos))
-				{
-					Cast::NotConst(this)->m_Miss++;
-					StreamMmr::LoadElement(hv, pos);
-				}
-			}
-		};
-
-		MyMmr myMmr(db, NodeDB::StreamType::ShieldedMmr, true);
-
-		for (uint32_t i = 0; i < 40; i++)
-		{
-			Merkle::Hash hv = i;
-			myMmr.Append(hv);
-			myMmr.get_Hash(hv);
-		}
-
-		// in a 'friendly' scenario, where we only add and calculate root - cache must be 100% effective
-		verify_test(!myMmr.m_Miss);
-
+
+		Height h1 = db.GetLowestDummy(kid);
+		verify_test(h1 == 176);
+		verify_test(kid.m_Idx == 345U);
+
+		db.SetDummyHeight(kid, 1055);
+
+		h1 = db.GetLowestDummy(kid);
+		verify_test(h1 == 568);
+		verify_test(kid.m_Idx == 346U);
+		
+		db.DeleteDummy(kid);
+
+		h1 = db.GetLowestDummy(kid);
+		verify_test(h1 == 1055);
+		verify_test(kid.m_Idx == 345U);
+
+		db.DeleteDummy(kid);
+
+		verify_test(MaxHeight == db.GetLowestDummy(kid));
+
+		// Kernels
+		db.InsertKernel(bBodyP, 5);
+		db.InsertKernel(bBodyP, 5); // duplicate
+		db.InsertKernel(bBodyP, 7);
+		db.InsertKernel(bBodyP, 2);
+
+		verify_test(db.FindKernel(bBodyP) == 7);
+		verify_test(db.FindKernel(bBodyE) == 0);
+
+		db.DeleteKernel(bBodyP, 7);
+		verify_test(db.FindKernel(bBodyP) == 5);
+		db.DeleteKernel(bBodyP, 5);
+		verify_test(db.FindKernel(bBodyP) == 5);
+		db.DeleteKernel(bBodyP, 2);
+		verify_test(db.FindKernel(bBodyP) == 5);
+		db.DeleteKernel(bBodyP, 5);
+		verify_test(db.FindKernel(bBodyP) == 0);
+
+		// Shielded
+		TxoID nShielded = 16 * 1024 * 3 + 5;
+		db.ShieldedResize(nShielded, 0);
+
+		StoragePts pts;
+		pts.Init();
+
+		db.ShieldedWrite(16 * 1024 * 2 - 2, pts.m_pArr, _countof(pts.m_pArr));
+
+		ZeroObject(pts.m_pArr);
+
+		db.ShieldedRead(16 * 1024 * 3 + 5 - _countof(pts.m_pArr), pts.m_pArr, _countof(pts.m_pArr));
+		verify_test(memis0(pts.m_pArr, sizeof(pts.m_pArr)));
+
+		db.ShieldedRead(16 * 1024 * 2 -2, pts.m_pArr, _countof(pts.m_pArr));
+		verify_test(pts.IsValid(0, _countof(pts.m_pArr), 0));
+
+		db.ShieldedResize(1, nShielded);
+		db.ShieldedResize(0, 1);
+
+		ECC::uintBig k1 = 223U;
+		Blob val(nullptr, 0);
+
+		verify_test(db.UniqueInsertSafe(k1, &val));
+		db.UniqueDeleteStrict(k1);
+		verify_test(db.UniqueInsertSafe(k1, nullptr));
+		verify_test(!db.UniqueInsertSafe(k1, nullptr));
+
+
+		// Assets
+		Asset::Full ai1, ai2;
+		ZeroObject(ai1);
+
+		for (uint32_t i = 1; i <= 5; i++)
+		{
+			ai1.m_ID = 0;
+			db.AssetAdd(ai1);
+			verify_test(ai1.m_ID == i);
+		}
+
+		verify_test(db.AssetDelete(5) == 4); // should shrink
+		verify_test(db.AssetDelete(3) == 4); // should retain the same size
+
+		ai2.m_ID = 3;
+		verify_test(!db.AssetGetSafe(ai2));
+		ai2.m_ID = 2;
+		verify_test(db.AssetGetSafe(ai2));
+		verify_test(ai2.m_Owner == ai1.m_Owner);
+
+		ai1.m_Owner.Inc();
+		ai1.m_Owner.Negate();
+		ai1.m_ID = 0;
+		db.AssetAdd(ai1);
+		verify_test(ai1.m_ID == 3);
+
+		AmountBig::Type assetVal1, assetVal2 = 1U;
+		ai2.m_ID = 3;
+		verify_test(db.AssetGetSafe(ai2));
+		verify_test(ai2.m_Value == Zero);
+
+		assetVal2 = 334U;
+		db.AssetSetValue(3, assetVal2, 18);
+
+		verify_test(db.AssetGetSafe(ai2));
+		verify_test(ai2.m_Value == assetVal2);
+		verify_test(ai2.m_LockHeight == 18);
+
+		ai1.m_ID = db.AssetFindByOwner(ai1.m_Owner);
+		verify_test(ai1.m_ID == 3);
+		ai1.m_Value = Zero;
+		verify_test(db.AssetGetSafe(ai1));
+		verify_test(ai1.m_Value == assetVal2);
+
+		verify_test(db.AssetDelete(2) == 4);
+		verify_test(db.AssetDelete(3) == 4);
+		verify_test(db.AssetDelete(4) == 1);
+		verify_test(db.AssetDelete(1) == 0);
+
+		// StreamMmr, test cache
+		struct MyMmr
+			:public NodeDB::StreamMmr
+		{
+			using StreamMmr::StreamMmr;
+			uint32_t m_Total = 0;
+			uint32_t m_Miss = 0;
+
+			virtual void LoadElement(Merkle::Hash& hv, const Merkle::Position& pos) const override
+			{
+				Cast::NotConst(this)->m_Total++;
+				if (!CacheFind(hv, pos))
+				{
+					Cast::NotConst(this)->m_Miss++;
+					StreamMmr::LoadElement(hv, pos);
+				}
+			}
+		};
+
+		MyMmr myMmr(db, NodeDB::StreamType::ShieldedMmr, true);
+
+		for (uint32_t i = 0; i < 40; i++)
+		{
+			Merkle::Hash hv = i;
+			myMmr.Append(hv);
+			myMmr.get_Hash(hv);
+		}
+
+		// in a 'friendly' scenario, where we only add and calculate root - cache must be 100% effective
+		verify_test(!myMmr.m_Miss);
+
 		tr.Commit();
 
-		// Contract data
-		NodeDB::Recordset rs;
-		Blob blob1;
-		ECC::Hash::Value hvKey = 234U, hvVal = 1232U, hvKey2;
-		verify_test(!db.ContractDataFind(hvKey, blob1, rs));
-
-		blob1 = hvKey;
-		verify_test(!db.ContractDataFindNext(blob1, rs));
-
-		db.ContractDataInsert(hvKey, hvVal);
-		verify_test(!db.ContractDataFindNext(blob1, rs));
-
-		hvVal.Inc();
-		db.ContractDataUpdate(hvKey, hvVal);
-
-		verify_test(db.ContractDataFind(hvKey, blob1, rs));
-		verify_test(Blob(hvVal) == blob1);
-
-		blob1 = hvKey2;
-		hvKey2 = hvKey;
-		hvKey2.Inc();
-		verify_test(!db.ContractDataFindNext(blob1, rs));
-
-		hvKey2 = hvKey;
-		hvKey2.Negate();
-		hvKey2 += ECC::Hash::Value(2U);
-		hvKey2.Negate();
-		verify_test(db.ContractDataFindNext(blob1, rs));
-		verify_test(Blob(hvKey) == blob1);
-
-		db.ContractDataDel(hvKey);
+		// Contract data
+		NodeDB::Recordset rs;
+		Blob blob1;
+		ECC::Hash::Value hvKey = 234U, hvVal = 1232U, hvKey2;
+		verify_test(!db.ContractDataFind(hvKey, blob1, rs));
+
+		blob1 = hvKey;
+		verify_test(!db.ContractDataFindNext(blob1, rs));
+
+		db.ContractDataInsert(hvKey, hvVal);
+		verify_test(!db.ContractDataFindNext(blob1, rs));
+
+		hvVal.Inc();
+		db.ContractDataUpdate(hvKey, hvVal);
+
+		verify_test(db.ContractDataFind(hvKey, blob1, rs));
+		verify_test(Blob(hvVal) == blob1);
+
+		blob1 = hvKey2;
+		hvKey2 = hvKey;
+		hvKey2.Inc();
+		verify_test(!db.ContractDataFindNext(blob1, rs));
+
+		hvKey2 = hvKey;
+		hvKey2.Negate();
+		hvKey2 += ECC::Hash::Value(2U);
+		hvKey2.Negate();
+		verify_test(db.ContractDataFindNext(blob1, rs));
+		verify_test(Blob(hvKey) == blob1);
+
+		db.ContractDataDel(hvKey);
 		verify_test(!db.ContractDataFind(hvKey, blob1, rs));
 	}
 
@@ -968,6 +968,7 @@ namespace beam
 
 		for (Height h = Rules::HeightGenesis; h < 96 + Rules::HeightGenesis; h++)
 		{
+			std::vector<Transaction::Ptr> vTxs;
 			while (true)
 			{
 				// Spend it in a transaction
@@ -980,6 +981,24 @@ namespace beam
 				uint32_t nBvmCharge = 0;
 				verify_test(proto::TxStatus::Ok == np.ValidateTxContextEx(*pTx, hr, false, nBvmCharge));
 
+				vTxs.push_back(std::move(pTx));
+			}
+
+			uint32_t nTxs = static_cast<uint32_t>(vTxs.size());
+			for (uint32_t i = 0; i < nTxs; i++)
+			{
+				if (i == nTxs / 2)
+				{
+					// the rest is added to the template incrementally
+					NodeProcessor::BlockContext bc(np.m_TxPool, 0, *np.m_Wallet.m_pKdf, *np.m_Wallet.m_pKdf);
+					verify_test(np.GenerateNewBlock(bc));
+					verify_test(np.m_TxPool.m_Template.m_bValid);
+					verify_test(np.m_TxPool.m_Template.m_lstFresh.empty());
+					verify_test(np.m_TxPool.m_Template.m_nCount == i);
+				}
+
+				Transaction::Ptr& pTx = vTxs[i];
+
 				Transaction::Context::Params pars;
 				Transaction::Context ctx(pars);
 				ctx.m_Height = np.m_Cursor.m_Sid.m_Height + 1;
@@ -993,6 +1012,18 @@ namespace beam
 
 			NodeProcessor::BlockContext bc(np.m_TxPool, 0, *np.m_Wallet.m_pKdf, *np.m_Wallet.m_pKdf);
 			verify_test(np.GenerateNewBlock(bc));
+			verify_test(np.m_TxPool.m_Template.m_nCount == nTxs);
+
+			{
+				// must be the same as the full selection
+				np.m_TxPool.m_Template.m_bValid = false;
+
+				NodeProcessor::BlockContext bc2(np.m_TxPool, 0, *np.m_Wallet.m_pKdf, *np.m_Wallet.m_pKdf);
+				verify_test(np.GenerateNewBlock(bc2));
+				verify_test(bc2.m_Fees == bc.m_Fees);
+				verify_test(bc2.m_Block.m_vKernels.size() == bc.m_Block.m_vKernels.size());
+				verify_test(bc2.m_Block.m_vInputs.size() == bc.m_Block.m_vInputs.size());
+			}
 
 			np.OnState(bc.m_Hdr, PeerID());
 
@@ -1182,27 +1213,27 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				verify_test(txvp.m_vInputs.empty()); // may contain only treasury, but we don't spend it in the test
-
-				if (!txvp.m_vOutputs.empty())
-				{
-					txvp.m_vOutputs.pop_back();
-
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-
-					bTampered = true;
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				verify_test(txvp.m_vInputs.empty()); // may contain only treasury, but we don't spend it in the test
+
+				if (!txvp.m_vOutputs.empty())
+				{
+					txvp.m_vOutputs.pop_back();
+
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+
+					bTampered = true;
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1229,22 +1260,22 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				bbb.m_Offset.m_Value.Inc();
-
-				Serializer ser;
-				ser & bbb;
-				ser & txvp;
-				ser.swap_buf(bbP);
-
-				bTampered = true;
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				bbb.m_Offset.m_Value.Inc();
+
+				Serializer ser;
+				ser & bbb;
+				ser & txvp;
+				ser.swap_buf(bbP);
+
+				bTampered = true;
 			}
 
 			Block::SystemState::ID id;
@@ -1270,32 +1301,32 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
-				{
-					Output& outp = *txvp.m_vOutputs[j];
-					if (outp.m_pConfidential)
-					{
-						outp.m_pConfidential->m_P_Tag.m_pCondensed[0].m_Value.Inc();
-						bTampered = true;
-						break;
-					}
-				}
-
-				if (bTampered)
-				{
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
+				{
+					Output& outp = *txvp.m_vOutputs[j];
+					if (outp.m_pConfidential)
+					{
+						outp.m_pConfidential->m_P_Tag.m_pCondensed[0].m_Value.Inc();
+						bTampered = true;
+						break;
+					}
+				}
+
+				if (bTampered)
+				{
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1330,33 +1361,33 @@ namespace beam
 
 			if (!bTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
-				{
-					Output& outp = *txvp.m_vOutputs[j];
-					if (outp.m_pConfidential || outp.m_pPublic)
-					{
-						outp.m_pConfidential.reset();
-						outp.m_pPublic.reset();
-						bTampered = true;
-						break;
-					}
-				}
-
-				if (bTampered)
-				{
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
+				{
+					Output& outp = *txvp.m_vOutputs[j];
+					if (outp.m_pConfidential || outp.m_pPublic)
+					{
+						outp.m_pConfidential.reset();
+						outp.m_pPublic.reset();
+						bTampered = true;
+						break;
+					}
+				}
+
+				if (bTampered)
+				{
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1392,33 +1423,33 @@ namespace beam
 
 			if (!hTampered)
 			{
-				Deserializer der;
-				der.reset(bbP);
-
-				Block::BodyBase bbb;
-				TxVectors::Perishable txvp;
-				der & bbb;
-				der & txvp;
-
-				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
-				{
-					Output& outp = *txvp.m_vOutputs[j];
-					if (outp.m_pConfidential || outp.m_pPublic)
-					{
-						outp.m_pConfidential.reset();
-						outp.m_pPublic.reset();
-						hTampered = h;
-						break;
-					}
-				}
-
-				if (hTampered)
-				{
-					Serializer ser;
-					ser & bbb;
-					ser & txvp;
-					ser.swap_buf(bbP);
-				}
+				Deserializer der;
+				der.reset(bbP);
+
+				Block::BodyBase bbb;
+				TxVectors::Perishable txvp;
+				der & bbb;
+				der & txvp;
+
+				for (size_t j = 0; j < txvp.m_vOutputs.size(); j++)
+				{
+					Output& outp = *txvp.m_vOutputs[j];
+					if (outp.m_pConfidential || outp.m_pPublic)
+					{
+						outp.m_pConfidential.reset();
+						outp.m_pPublic.reset();
+						hTampered = h;
+						break;
+					}
+				}
+
+				if (hTampered)
+				{
+					Serializer ser;
+					ser & bbb;
+					ser & txvp;
+					ser.swap_buf(bbP);
+				}
 			}
 
 			Block::SystemState::ID id;
@@ -1588,10 +1619,10 @@ namespace beam
 			Key::IPKdf::Ptr m_pOwner2;
 			uint32_t m_nUnrecognized = 0;
 
-			virtual bool OnUtxo(Height h, const Output& outp) override
-			{
-				verify_test(outp.m_RecoveryOnly);
-
+			virtual bool OnUtxo(Height h, const Output& outp) override
+			{
+				verify_test(outp.m_RecoveryOnly);
+
 				CoinID cid;
 				bool b1 = outp.Recover(h, *m_pOwner1, cid);
 				bool b2 = outp.Recover(h, *m_pOwner2, cid);
@@ -1601,9 +1632,9 @@ namespace beam
 					m_nUnrecognized++;
 					verify_test(m_nUnrecognized <= 1);
 				}
-
-				return true;
-			}
+
+				return true;
+			}
 		} parser;
 		parser.m_pOwner1 = node.m_Keys.m_pOwner;
 		parser.m_pOwner2 = node2.m_Keys.m_pOwner;
@@ -1824,7 +1855,7 @@ namespace beam
 				sdp.m_Output.m_Value -= fee;
 
 				m_Shielded.m_Cfg = Rules::get().Shielded.m_ProofMax;
-
+
 				assert(msgTx.m_Transaction);
 
 				{
@@ -1848,18 +1879,18 @@ namespace beam
 						// skip the voucher signature
 					}
 
-					pKrn->UpdateMsg();
-					ECC::Oracle oracle;
-					oracle << pKrn->m_Msg;
+					pKrn->UpdateMsg();
+					ECC::Oracle oracle;
+					oracle << pKrn->m_Msg;
 
 					// substitute the voucher
 					pKrn->m_Txo.m_Ticket = voucher.m_Ticket;
-					sdp.m_Ticket.m_SharedSecret = voucher.m_SharedSecret;
+					sdp.m_Ticket.m_SharedSecret = voucher.m_SharedSecret;
 
 					ZeroObject(sdp.m_Output.m_User);
-					sdp.m_Output.m_User.m_Sender = 165U;
-					sdp.m_Output.m_User.m_pMessage[0] = 243U;
-					sdp.m_Output.m_User.m_pMessage[1] = 2435U;
+					sdp.m_Output.m_User.m_Sender = 165U;
+					sdp.m_Output.m_User.m_pMessage[0] = 243U;
+					sdp.m_Output.m_User.m_pMessage[1] = 2435U;
 					sdp.GenerateOutp(pKrn->m_Txo, oracle);
 
 					pKrn->MsgToID();
@@ -1906,40 +1937,40 @@ namespace beam
 				msgTx.m_Transaction = std::make_shared<Transaction>();
 				msgTx.m_Transaction->m_Offset = Zero;
 
-				Height h = m_vStates.back().m_Height;
-
-				TxKernelShieldedInput::Ptr pKrn(new TxKernelShieldedInput);
-				pKrn->m_Height.m_Min = h + 1;
-				pKrn->m_WindowEnd = nWnd1;
-				pKrn->m_SpendProof.m_Cfg = m_Shielded.m_Cfg;
+				Height h = m_vStates.back().m_Height;
+
+				TxKernelShieldedInput::Ptr pKrn(new TxKernelShieldedInput);
+				pKrn->m_Height.m_Min = h + 1;
+				pKrn->m_WindowEnd = nWnd1;
+				pKrn->m_SpendProof.m_Cfg = m_Shielded.m_Cfg;
 
 				Lelantus::CmListVec lst;
 
 				assert(nWnd1 <= m_Shielded.m_Wnd0 + m_Shielded.m_N);
 				if (nWnd1 == m_Shielded.m_Wnd0 + m_Shielded.m_N)
-					lst.m_vec.swap(msg.m_Items);
-				else
-				{
-					// zero-pad from left
-					lst.m_vec.resize(m_Shielded.m_N);
-					for (size_t i = 0; i < m_Shielded.m_N - msg.m_Items.size(); i++)
-					{
-						ECC::Point::Storage& v = lst.m_vec[i];
-						v.m_X = Zero;
-						v.m_Y = Zero;
-					}
-					std::copy(msg.m_Items.begin(), msg.m_Items.end(), lst.m_vec.end() - msg.m_Items.size());
-				}
-
-				Lelantus::Prover p(lst, pKrn->m_SpendProof);
+					lst.m_vec.swap(msg.m_Items);
+				else
+				{
+					// zero-pad from left
+					lst.m_vec.resize(m_Shielded.m_N);
+					for (size_t i = 0; i < m_Shielded.m_N - msg.m_Items.size(); i++)
+					{
+						ECC::Point::Storage& v = lst.m_vec[i];
+						v.m_X = Zero;
+						v.m_Y = Zero;
+					}
+					std::copy(msg.m_Items.begin(), msg.m_Items.end(), lst.m_vec.end() - msg.m_Items.size());
+				}
+
+				Lelantus::Prover p(lst, pKrn->m_SpendProof);
 				p.m_Witness.m_L = static_cast<uint32_t>(m_Shielded.m_N - m_Shielded.m_Confirmed) - 1;
 				p.m_Witness.m_R = m_Shielded.m_Params.m_Ticket.m_pK[0] + m_Shielded.m_Params.m_Output.m_k; // total blinding factor of the shielded element
 				p.m_Witness.m_SpendSk = m_Shielded.m_skSpendKey;
 				p.m_Witness.m_V = m_Shielded.m_Params.m_Output.m_Value;
 
-				pKrn->UpdateMsg();
-
-				ECC::SetRandom(p.m_Witness.m_R_Output);
+				pKrn->UpdateMsg();
+
+				ECC::SetRandom(p.m_Witness.m_R_Output);
 
 				pKrn->Sign(p, 0, true); // hide asset, although it's beam
 
@@ -1948,7 +1979,7 @@ namespace beam
 				Amount fee = 100;
 				fee += Transaction::FeeSettings(h + 1).m_ShieldedInputTotal;
 
-				msgTx.m_Transaction->m_vKernels.push_back(std::move(pKrn));
+				msgTx.m_Transaction->m_vKernels.push_back(std::move(pKrn));
 				m_Wallet.UpdateOffset(*msgTx.m_Transaction, p.m_Witness.m_R_Output, false);
 
 				m_Wallet.MakeTxOutput(*msgTx.m_Transaction, h, 0, m_Shielded.m_Params.m_Output.m_Value, fee);
@@ -1958,12 +1989,12 @@ namespace beam
 				ctx.m_Height.m_Min = h + 1;
 				verify_test(msgTx.m_Transaction->IsValid(ctx));
 
-				for (size_t i = 0; i < msgTx.m_Transaction->m_vKernels.size(); i++)
-				{
-					const TxKernel& krn = *msgTx.m_Transaction->m_vKernels[i];
-					if (krn.get_Subtype() == TxKernel::Subtype::Std)
-						m_Shielded.m_SpendKernelID = krn.m_Internal.m_ID;
-				}
+				for (size_t i = 0; i < msgTx.m_Transaction->m_vKernels.size(); i++)
+				{
+					const TxKernel& krn = *msgTx.m_Transaction->m_vKernels[i];
+					if (krn.get_Subtype() == TxKernel::Subtype::Std)
+						m_Shielded.m_SpendKernelID = krn.m_Internal.m_ID;
+				}
 
 				msgTx.m_Fluff = true;
 				OnBeingSpent(msgTx);
@@ -2311,47 +2342,47 @@ namespace beam
 				{
 				}
 
-				void GenerateKernel(const bvm2::ContractID* pCid, uint32_t iMethod, const Blob& args, const Shaders::FundsChange* pFunds, uint32_t nFunds, const ECC::Hash::Value* pSig, uint32_t nSig, const char* szComment, Amount nFee) override
-				{
-					bvm2::ManagerStd::GenerateKernel(pCid, iMethod, args, pFunds, nFunds, pSig, nSig, szComment, nFee);
-
-					if (!iMethod)
-					{
-						assert(!m_vInvokeData.empty());
-						const auto& item = m_vInvokeData.back();
-
-						bvm2::get_Cid(m_This.m_Contract.m_Cid, item.m_Data, item.m_Args);
-					}
-				}
-
-				void OnDone(const std::exception* pExc) override
-				{
-					m_Done = true;
-					m_Err = !!pExc;
-
+				void GenerateKernel(const bvm2::ContractID* pCid, uint32_t iMethod, const Blob& args, const Shaders::FundsChange* pFunds, uint32_t nFunds, const ECC::Hash::Value* pSig, uint32_t nSig, const char* szComment, Amount nFee) override
+				{
+					bvm2::ManagerStd::GenerateKernel(pCid, iMethod, args, pFunds, nFunds, pSig, nSig, szComment, nFee);
+
+					if (!iMethod)
+					{
+						assert(!m_vInvokeData.empty());
+						const auto& item = m_vInvokeData.back();
+
+						bvm2::get_Cid(m_This.m_Contract.m_Cid, item.m_Data, item.m_Args);
+					}
+				}
+
+				void OnDone(const std::exception* pExc) override
+				{
+					m_Done = true;
+					m_Err = !!pExc;
+
 					m_This.m_Contract.m_Done++;
-
-					if (m_This.m_pMan)
-					{
-						if (!m_Err)
+
+					if (m_This.m_pMan)
+					{
+						if (!m_Err)
 							printf("manager shader: %s\n", m_Out.str().c_str());
-
-						//m_This.m_pMan.reset();
-					}
-				}
-
-				struct DelayedStart
-					:public io::IdleEvt
-				{
-					void OnSchedule() override
-					{
-						cancel();
-						get_ParentObj().StartRun(1);
-					}
-
-					IMPLEMENT_GET_PARENT_OBJ(MyManager, m_DelayedStart)
-
-				} m_DelayedStart;
+
+						//m_This.m_pMan.reset();
+					}
+				}
+
+				struct DelayedStart
+					:public io::IdleEvt
+				{
+					void OnSchedule() override
+					{
+						cancel();
+						get_ParentObj().StartRun(1);
+					}
+
+					IMPLEMENT_GET_PARENT_OBJ(MyManager, m_DelayedStart)
+
+				} m_DelayedStart;
 			};
 
 			std::unique_ptr<MyManager> m_pMan;
@@ -2362,55 +2393,55 @@ namespace beam
 				MyClient& m_This;
 				MyNetwork(MyClient& me) :m_This(me) {}
 
-				virtual void Connect() override {}
-				virtual void Disconnect() override {}
-				virtual void BbsSubscribe(BbsChannel, Timestamp, proto::FlyClient::IBbsReceiver*) override {}
+				virtual void Connect() override {}
+				virtual void Disconnect() override {}
+				virtual void BbsSubscribe(BbsChannel, Timestamp, proto::FlyClient::IBbsReceiver*) override {}
 
 				proto::FlyClient::Request::Ptr m_pReq;
 
-				virtual void PostRequestInternal(proto::FlyClient::Request& r) override
-				{
-					switch (r.get_Type())
-					{
-					case proto::FlyClient::Request::Type::ContractVars:
-						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVars>(r).m_Msg);
-						break;
-
-					case proto::FlyClient::Request::Type::ContractVar:
-						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVar>(r).m_Msg);
-						break;
-
-					default:
-						return;
-					}
-
-					m_pReq = &r;
-				}
-
-				void OnComplete2()
-				{
-					auto pHandler = m_pReq->m_pTrg;
-					m_pReq->m_pTrg = nullptr;
-					pHandler->OnComplete(*m_pReq);
-				}
-
+				virtual void PostRequestInternal(proto::FlyClient::Request& r) override
+				{
+					switch (r.get_Type())
+					{
+					case proto::FlyClient::Request::Type::ContractVars:
+						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVars>(r).m_Msg);
+						break;
+
+					case proto::FlyClient::Request::Type::ContractVar:
+						m_This.Send(Cast::Up<proto::FlyClient::RequestContractVar>(r).m_Msg);
+						break;
+
+					default:
+						return;
+					}
+
+					m_pReq = &r;
+				}
+
+				void OnComplete2()
+				{
+					auto pHandler = m_pReq->m_pTrg;
+					m_pReq->m_pTrg = nullptr;
+					pHandler->OnComplete(*m_pReq);
+				}
+
 				void OnMsg(proto::ContractVars&& msg)
 				{
-					if (m_pReq && m_pReq->m_pTrg)
-					{
-						auto& x = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pReq);
-						x.m_Res = std::move(msg);
-						OnComplete2();
+					if (m_pReq && m_pReq->m_pTrg)
+					{
+						auto& x = Cast::Up<proto::FlyClient::RequestContractVars>(*m_pReq);
+						x.m_Res = std::move(msg);
+						OnComplete2();
 					}
 				}
 
 				void OnMsg(proto::ContractVar&& msg)
 				{
-					if (m_pReq && m_pReq->m_pTrg)
-					{
-						auto& x = Cast::Up<proto::FlyClient::RequestContractVar>(*m_pReq);
-						x.m_Res = std::move(msg);
-						OnComplete2();
+					if (m_pReq && m_pReq->m_pTrg)
+					{
+						auto& x = Cast::Up<proto::FlyClient::RequestContractVar>(*m_pReq);
+						x.m_Res = std::move(msg);
+						OnComplete2();
 					}
 				}
 			};
@@ -2649,26 +2680,26 @@ namespace beam
 			{
 				if (!m_queProofsKrnExpected.empty())
 				{
-					const MiniWallet::MyKernel& mk = m_Wallet.m_MyKernels[m_queProofsKrnExpected.front()];
+					const MiniWallet::MyKernel& mk = m_Wallet.m_MyKernels[m_queProofsKrnExpected.front()];
 					m_queProofsKrnExpected.pop_front();
 
 					if (!msg.m_Proof.empty())
 					{
-						TxKernelStd krn;
-						mk.Export(krn);
-						verify_test(m_vStates.back().IsValidProofKernel(krn, msg.m_Proof));
-
-						if (!m_Shielded.m_SpendConfirmed && (krn.m_Internal.m_ID == m_Shielded.m_SpendKernelID))
-						{
-							m_Shielded.m_SpendConfirmed = true;
-
-							proto::GetProofShieldedInp msgOut;
-							msgOut.m_SpendPk = m_Shielded.m_Params.m_Ticket.m_SpendPk;
-							Send(msgOut);
-
+						TxKernelStd krn;
+						mk.Export(krn);
+						verify_test(m_vStates.back().IsValidProofKernel(krn, msg.m_Proof));
+
+						if (!m_Shielded.m_SpendConfirmed && (krn.m_Internal.m_ID == m_Shielded.m_SpendKernelID))
+						{
+							m_Shielded.m_SpendConfirmed = true;
+
+							proto::GetProofShieldedInp msgOut;
+							msgOut.m_SpendPk = m_Shielded.m_Params.m_Ticket.m_SpendPk;
+							Send(msgOut);
+
 							printf("Waiting for shielded input proof...\n");
-
-						}
+
+						}
 					}
 				}
 				else
@@ -2698,17 +2729,17 @@ namespace beam
 					MyClient& m_This;
 					MyParser(MyClient& x) :m_This(x) {}
 
-					virtual void OnEventBase(proto::Event::Base& evt) override
-					{
-						// log non-UTXO events
-						std::ostringstream os;
-						os << "Evt H=" << m_Height << ", ";
-						evt.Dump(os);
-						printf("%s\n", os.str().c_str());
-					}
-
-					virtual void OnEventType(proto::Event::Utxo& evt) override
-					{
+					virtual void OnEventBase(proto::Event::Base& evt) override
+					{
+						// log non-UTXO events
+						std::ostringstream os;
+						os << "Evt H=" << m_Height << ", ";
+						evt.Dump(os);
+						printf("%s\n", os.str().c_str());
+					}
+
+					virtual void OnEventType(proto::Event::Utxo& evt) override
+					{
 						ECC::Scalar::Native sk;
 						ECC::Point comm;
 						CoinID::Worker(evt.m_Cid).Create(sk, comm, *m_This.m_Wallet.m_pKdf);
@@ -2716,24 +2747,24 @@ namespace beam
 
 						if (evt.m_Cid.m_AssetID)
 						{
-							verify_test(evt.m_Cid.m_AssetID == m_This.m_Assets.m_ID);
-							if (!m_This.m_Assets.m_Recognized)
-							{
-								m_This.m_Assets.m_Recognized = true;
-								printf("Asset UTXO recognized\n");
-							}
+							verify_test(evt.m_Cid.m_AssetID == m_This.m_Assets.m_ID);
+							if (!m_This.m_Assets.m_Recognized)
+							{
+								m_This.m_Assets.m_Recognized = true;
+								printf("Asset UTXO recognized\n");
+							}
 						}
 						else
 						{
 							if (proto::Event::Flags::Add & evt.m_Flags)
 								m_This.m_Wallet.AddMyUtxo(evt.m_Cid, evt.m_Maturity);
 						}
-					}
-
-					virtual void OnEventType(proto::Event::Shielded& evt) override
-					{
-						OnEventBase(evt);
-
+					}
+
+					virtual void OnEventType(proto::Event::Shielded& evt) override
+					{
+						OnEventBase(evt);
+
 						// Restore all the relevent data
 						verify_test(evt.m_TxoID == 0);
 
@@ -2769,29 +2800,29 @@ namespace beam
 							m_This.m_Shielded.m_EvtAdd = true;
 						else
 							m_This.m_Shielded.m_EvtSpend = true;
-					}
-
-					virtual void OnEventType(proto::Event::AssetCtl& evt) override
-					{
-						OnEventBase(evt);
-
-						if (m_This.m_Assets.m_ID) {
-							// creation event may come before the client got proof for its asset
-							verify_test(evt.m_Info.m_ID == m_This.m_Assets.m_ID);
-						}
-						verify_test(evt.m_Info.m_Metadata.m_Value == m_This.m_Assets.m_Metadata.m_Value);
-						verify_test(evt.m_Info.m_Owner == m_This.m_Assets.m_Owner);
-
-						if (proto::Event::Flags::Add & evt.m_Flags)
-						{
-							verify_test(!m_This.m_Assets.m_EvtCreated);
-							m_This.m_Assets.m_EvtCreated = true;
-						}
-
-						if (evt.m_EmissionChange)
-							m_This.m_Assets.m_EvtEmitted = true;
-					}
-
+					}
+
+					virtual void OnEventType(proto::Event::AssetCtl& evt) override
+					{
+						OnEventBase(evt);
+
+						if (m_This.m_Assets.m_ID) {
+							// creation event may come before the client got proof for its asset
+							verify_test(evt.m_Info.m_ID == m_This.m_Assets.m_ID);
+						}
+						verify_test(evt.m_Info.m_Metadata.m_Value == m_This.m_Assets.m_Metadata.m_Value);
+						verify_test(evt.m_Info.m_Owner == m_This.m_Assets.m_Owner);
+
+						if (proto::Event::Flags::Add & evt.m_Flags)
+						{
+							verify_test(!m_This.m_Assets.m_EvtCreated);
+							m_This.m_Assets.m_EvtCreated = true;
+						}
+
+						if (evt.m_EmissionChange)
+							m_This.m_Assets.m_EvtEmitted = true;
+					}
+
 				} p(*this);
 
 				uint32_t nCount = p.Proceed(msg.m_Events);
@@ -2839,8 +2870,8 @@ namespace beam
 		{
 			MyClient* m_pOtherClient;
 
-			virtual void OnConnectedSecure() override
-			{
+			virtual void OnConnectedSecure() override
+			{
 				SendLogin();
 			}
 
@@ -2905,22 +2936,22 @@ namespace beam
 
 		cl.TestAllDone(true);
 
-		struct TxoRecover
-			:public NodeProcessor::ITxoRecover
-		{
-			uint32_t m_Recovered = 0;
-
-			TxoRecover(Key::IPKdf& key) :NodeProcessor::ITxoRecover(key) {}
-
+		struct TxoRecover
+			:public NodeProcessor::ITxoRecover
+		{
+			uint32_t m_Recovered = 0;
+
+			TxoRecover(Key::IPKdf& key) :NodeProcessor::ITxoRecover(key) {}
+
 			virtual bool OnTxo(const NodeDB::WalkerTxo&, Height hCreate, Output&, const CoinID&, const Output::User&) override
 			{
 				m_Recovered++;
 				return true;
 			}
-		};
-
-		TxoRecover wlk(*node.m_Keys.m_pOwner);
-		node2.get_Processor().EnumTxos(wlk);
+		};
+
+		TxoRecover wlk(*node.m_Keys.m_pOwner);
+		node2.get_Processor().EnumTxos(wlk);
 
 		node.get_Processor().RescanOwnedTxos();
 
@@ -2939,32 +2970,32 @@ namespace beam
 			typedef std::set<ECC::Point> PkSet;
 			PkSet m_SpendKeys;
 
-			virtual bool OnUtxoRecognized(Height, const Output&, CoinID&, const Output::User&) override
-			{
-				m_Utxos++;
-				return true;
-			}
-
-			virtual bool OnShieldedOutRecognized(const ShieldedTxo::DescriptionOutp& dout, const ShieldedTxo::DataParams& pars, Key::Index) override
-			{
-				verify_test(m_SpendKeys.end() == m_SpendKeys.find(pars.m_Ticket.m_SpendPk));
-				m_SpendKeys.insert(pars.m_Ticket.m_SpendPk);
-				return true;
-			}
-
-			virtual bool OnShieldedIn(const ShieldedTxo::DescriptionInp& din) override
-			{
-				if (m_SpendKeys.end() != m_SpendKeys.find(din.m_SpendPk))
-					m_Spent++;
-				return true;
-			}
-
-			virtual bool OnAssetRecognized(Asset::Full&) override
-			{
-				m_Assets++;
-				return true;
-			}
-
+			virtual bool OnUtxoRecognized(Height, const Output&, CoinID&, const Output::User&) override
+			{
+				m_Utxos++;
+				return true;
+			}
+
+			virtual bool OnShieldedOutRecognized(const ShieldedTxo::DescriptionOutp& dout, const ShieldedTxo::DataParams& pars, Key::Index) override
+			{
+				verify_test(m_SpendKeys.end() == m_SpendKeys.find(pars.m_Ticket.m_SpendPk));
+				m_SpendKeys.insert(pars.m_Ticket.m_SpendPk);
+				return true;
+			}
+
+			virtual bool OnShieldedIn(const ShieldedTxo::DescriptionInp& din) override
+			{
+				if (m_SpendKeys.end() != m_SpendKeys.find(din.m_SpendPk))
+					m_Spent++;
+				return true;
+			}
+
+			virtual bool OnAssetRecognized(Asset::Full&) override
+			{
+				m_Assets++;
+				return true;
+			}
+
 		};
 
 		MyParser p;
@@ -2973,6 +3004,19 @@ namespace beam
 
 		verify_test((p.m_SpendKeys.size() == 1) && (p.m_Spent == 1) && p.m_Utxos && p.m_Assets);
 
+		{
+			// same with utxos recognized in parallel
+			beam::ExecutorMT_R ex;
+			ex.set_Threads(4);
+			beam::Executor::Scope scopeEx(ex);
+
+			MyParser p2;
+			p2.Init(cl.m_Wallet.m_pKdf);
+			p2.Proceed(beam::g_sz3);
+
+			verify_test((p2.m_SpendKeys.size() == 1) && (p2.m_Spent == 1) && (p2.m_Utxos == p.m_Utxos) && (p2.m_Assets == p.m_Assets));
+		}
+
 		auto logger = beam::Logger::create(LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG);
 		node.PrintTxos();
 
@@ -3077,6 +3121,10 @@ namespace beam
 			bool m_bBbsReceived;
 			Block::SystemState::HistoryMap m_Hist;
 
+			// existing utxos and kernels, their proofs are batched
+			std::vector<ECC::Point> m_vUtxos;
+			std::vector<Merkle::Hash> m_vKrnIDs;
+
 			MyFlyClient()
 			{
 				m_pTimer = io::Timer::create(io::Reactor::get_Current());
@@ -3176,6 +3224,26 @@ namespace beam
 					m_nProofsExpected++;
 				}
 
+				std::vector<RequestUtxo::Ptr> vUtxo;
+				for (const auto& pt : m_vUtxos)
+				{
+					RequestUtxo::Ptr pUtxo(new RequestUtxo);
+					pUtxo->m_Msg.m_Utxo = pt;
+					net.PostRequest(*pUtxo, *this);
+					m_nProofsExpected++;
+					vUtxo.push_back(std::move(pUtxo));
+				}
+
+				std::vector<RequestKernel::Ptr> vKrnl;
+				for (const auto& hv : m_vKrnIDs)
+				{
+					RequestKernel::Ptr pKrnl(new RequestKernel);
+					pKrnl->m_Msg.m_ID = hv;
+					net.PostRequest(*pKrnl, *this);
+					m_nProofsExpected++;
+					vKrnl.push_back(std::move(pKrnl));
+				}
+
 				net.BbsSubscribe(m_LastBbsChannel, 0, this);
 
 				RequestEnumHdrs::Ptr pHdrs(new RequestEnumHdrs);
@@ -3191,6 +3259,11 @@ namespace beam
 				KillTimer();
 
 				verify_test(!pHdrs->m_vStates.empty());
+
+				for (const auto& pUtxo : vUtxo)
+					verify_test(!pUtxo->m_Res.m_Proofs.empty());
+				for (const auto& pKrnl : vKrnl)
+					verify_test(!pKrnl->m_Res.m_Proof.empty());
 			}
 		};
 
@@ -3199,6 +3272,42 @@ namespace beam
 
 
 		MyFlyClient fc;
+
+		{
+			struct Traveler :public UtxoTree::ITraveler
+			{
+				std::vector<ECC::Point>& m_vRes;
+				Traveler(std::vector<ECC::Point>& v) :m_vRes(v) {}
+
+				virtual bool OnLeaf(const RadixTree::Leaf& x) override {
+					UtxoTree::Key::Data d;
+					d = Cast::Up<UtxoTree::MyLeaf>(x).m_Key;
+					m_vRes.push_back(d.m_Commitment);
+					return m_vRes.size() < 5;
+				}
+			} t(fc.m_vUtxos);
+
+			UtxoTree::Cursor cu;
+			t.m_pCu = &cu;
+			node.get_Processor().get_Utxos().Traverse(t);
+			verify_test(!fc.m_vUtxos.empty());
+
+			for (Height h = 100; h < 105; h++)
+			{
+				NodeProcessor& np = node.get_Processor();
+				ByteBuffer bbE;
+				np.get_DB().GetStateBlock(np.FindActiveAtStrict(h), nullptr, &bbE, nullptr);
+
+				TxVectors::Eternal txve;
+				Deserializer der;
+				der.reset(bbE);
+				der & txve;
+
+				for (const auto& pKrn : txve.m_vKernels)
+					fc.m_vKrnIDs.push_back(pKrn->m_Internal.m_ID);
+			}
+			verify_test(!fc.m_vKrnIDs.empty());
+		}
 		// simple case
 		fc.SyncSync();
 
@@ -3242,6 +3351,253 @@ namespace beam
 		verify_test(!fc.m_Hist.m_Map.empty() && fc.m_Hist.m_Map.rbegin()->second.m_Height == hThrd2);
 	}
 
+	uint32_t CountEvents(NodeDB& db, uint32_t iOwner)
+	{
+		uint32_t nCount = 0;
+		NodeDB::WalkerEvent wlk;
+		for (db.EnumEvents(wlk, 0, iOwner); wlk.MoveNext(); )
+			nCount++;
+		return nCount;
+	}
+
+	void TestMultiOwner()
+	{
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		Key::IKdf::Ptr pA, pB, pC;
+		{
+			ECC::Hash::Value hv;
+			ECC::GenRandom(hv);
+			ECC::HKdf::Create(pA, hv);
+			ECC::GenRandom(hv);
+			ECC::HKdf::Create(pB, hv);
+			ECC::GenRandom(hv);
+			ECC::HKdf::Create(pC, hv);
+		}
+
+		uint32_t nEvts0;
+		{
+			Node node;
+			node.m_Cfg.m_sPathLocal = g_sz;
+			node.m_Cfg.m_MiningThreads = 0;
+			node.m_Cfg.m_Treasury = g_Treasury;
+			node.m_Keys.SetSingleKey(pA);
+			node.Initialize();
+
+			RaiseHeightTo(node, 20);
+
+			nEvts0 = CountEvents(node.get_Processor().get_DB(), 0);
+			verify_test(nEvts0);
+		}
+
+		// reopen with another main owner, the former one becomes the 2nd extra owner. Should rescan
+		Node node;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_MiningThreads = 0;
+		node.m_Cfg.m_Treasury = g_Treasury;
+		node.m_Keys.SetSingleKey(pB);
+		node.m_Keys.m_vOwnersExtra.push_back(pC);
+		node.m_Keys.m_vOwnersExtra.push_back(pA);
+		node.Initialize();
+
+		NodeDB& db = node.get_Processor().get_DB();
+		verify_test(!CountEvents(db, 0));
+		verify_test(!CountEvents(db, 1));
+		verify_test(CountEvents(db, 2) == nEvts0);
+
+		// new blocks with outputs of the extra owner
+		TxPool::Fluff txPool;
+		while (node.get_Processor().m_Cursor.m_ID.m_Height < 25)
+		{
+			NodeProcessor::BlockContext bc(txPool, 0, *pA, *pA);
+			verify_test(node.get_Processor().GenerateNewBlock(bc));
+			node.get_Processor().OnState(bc.m_Hdr, PeerID());
+
+			Block::SystemState::ID id;
+			bc.m_Hdr.get_ID(id);
+			node.get_Processor().OnBlock(id, bc.m_BodyP, bc.m_BodyE, PeerID());
+			node.get_Processor().TryGoUp();
+		}
+
+		uint32_t nEvtsA = CountEvents(db, 2);
+		verify_test(nEvtsA > nEvts0);
+
+		// each owner gets only its own events
+		struct MyClient
+			:public proto::NodeConnection
+		{
+			Key::IKdf::Ptr m_pKdf;
+			uint32_t m_nEvents = 0;
+			bool m_bViewer = false;
+			bool m_bDone = false;
+			io::Timer::Ptr m_pTimer;
+
+			virtual void OnConnectedSecure() override
+			{
+				SendLogin();
+			}
+
+			virtual void OnMsg(proto::Authentication&& msg) override
+			{
+				proto::NodeConnection::OnMsg(std::move(msg));
+
+				switch (msg.m_IDType)
+				{
+				case proto::IDType::Node:
+					ProveKdfObscured(*m_pKdf, proto::IDType::Owner);
+					Send(proto::GetEvents(Zero));
+					break;
+
+				case proto::IDType::Viewer:
+					verify_test(IsPKdfObscured(*m_pKdf, msg.m_ID));
+					m_bViewer = true;
+					break;
+
+				default: // suppress warning
+					break;
+				}
+			}
+
+			virtual void OnMsg(proto::Events&& msg) override
+			{
+				struct MyParser :public proto::Event::IGroupParser {
+				} p;
+
+				m_nEvents = p.Proceed(msg.m_Events);
+				m_bDone = true;
+				io::Reactor::get_Current().stop();
+			}
+
+			virtual void OnDisconnect(const DisconnectReason&) override {
+				fail_test("OnDisconnect");
+				io::Reactor::get_Current().stop();
+			}
+		};
+
+		const std::pair<Key::IKdf::Ptr, uint32_t> pOwners[] = {
+			{ pA, nEvtsA },
+			{ pB, CountEvents(db, 0) },
+			{ pC, 0 },
+		};
+
+		for (const auto& x : pOwners)
+		{
+			MyClient cl;
+			cl.m_pKdf = x.first;
+
+			io::Address addr;
+			addr.resolve("127.0.0.1");
+			addr.port(g_Port);
+			cl.Connect(addr);
+
+			cl.m_pTimer = io::Timer::create(*pReactor);
+			cl.m_pTimer->start(10 * 1000, false, []() { io::Reactor::get_Current().stop(); });
+
+			pReactor->run();
+
+			verify_test(cl.m_bDone && cl.m_bViewer);
+			verify_test(cl.m_nEvents == x.second);
+		}
+	}
+
+	void TestSnapshot()
+	{
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		Block::SystemState::ID id40, id35;
+		{
+			Node node;
+			node.m_Cfg.m_sPathLocal = g_sz;
+			node.m_Cfg.m_MiningThreads = 0;
+			node.m_Cfg.m_Treasury = g_Treasury;
+			ECC::SetRandom(node);
+			node.Initialize();
+
+			RaiseHeightTo(node, 40);
+
+			NodeProcessor& np = node.get_Processor();
+			id40 = np.m_Cursor.m_ID;
+			NodeDB::StateID sid;
+			sid.m_Height = 35;
+			sid.m_Row = np.FindActiveAtStrict(sid.m_Height);
+			np.get_DB().get_StateID(sid, id35);
+
+			np.ExportSnapshot(g_sz2);
+			verify_test(np.m_Cursor.m_ID == id40); // intact
+
+			bool bThrown = false;
+			try {
+				NodeProcessor::ImportSnapshot(g_sz2, g_sz); // already exists
+			} catch (const std::exception&) {
+				bThrown = true;
+			}
+			verify_test(bThrown);
+		}
+
+		DeleteFile(g_sz);
+		NodeProcessor::ImportSnapshot(g_sz2, g_sz);
+		{
+			NodeProcessor np;
+			np.Initialize(g_sz);
+			verify_test(np.m_Cursor.m_ID == id40);
+			verify_test(np.m_Extra.m_Fossil == 40 - Rules::get().MaxRollback);
+
+			// below the fossil height
+			bool bThrown = false;
+			try {
+				np.ExportSnapshot(g_sz2, 20);
+			} catch (const std::exception&) {
+				bThrown = true;
+			}
+			verify_test(bThrown);
+
+			DeleteFile(g_sz2);
+			np.ExportSnapshot(g_sz2, 35);
+		}
+
+		DeleteFile(g_sz);
+		NodeProcessor::ImportSnapshot(g_sz2, g_sz);
+		{
+			NodeProcessor np;
+			np.Initialize(g_sz);
+			verify_test(np.m_Cursor.m_ID == id35);
+		}
+
+		// tamper the snapshot: the rebuilt utxo set won't match the definition
+		{
+			NodeDB db;
+			db.Open(g_sz2);
+
+			NodeDB::WalkerTxo wlk;
+			for (db.EnumTxos(wlk, 0); wlk.MoveNext(); )
+			{
+				if (MaxHeight == wlk.m_SpendHeight)
+				{
+					db.TxoSetSpent(wlk.m_ID, Rules::HeightGenesis);
+					break;
+				}
+			}
+		}
+
+		DeleteFile(g_sz);
+		bool bThrown = false;
+		try {
+			NodeProcessor::ImportSnapshot(g_sz2, g_sz);
+		} catch (const CorruptionException&) {
+			bThrown = true;
+		}
+		verify_test(bThrown);
+
+		std::FStream fs;
+		verify_test(!fs.Open(g_sz, true)); // removed
+
+		DeleteFile(g_sz2);
+	}
+
 	void TestHalving()
 	{
 		HeightRange hr;
@@ -3269,6 +3625,115 @@ namespace beam
 		}
 	}
 
+	void TestStemAggregation()
+	{
+		struct MyStem
+			:public TxPool::Stem
+		{
+			Merkle::Hash m_hvTip = Zero;
+			uint32_t m_FullValidations = 0;
+
+			virtual bool ValidateTxContext(const Transaction&, const HeightRange&, const AmountBig::Type&, Amount& feeReserve, bool bPartsValid) override
+			{
+				if (!bPartsValid)
+					m_FullValidations++;
+				feeReserve = 0;
+				return true;
+			}
+
+			virtual const Merkle::Hash& get_Tip() override { return m_hvTip; }
+			virtual void OnTimedOut(Element&) override {}
+
+			Element& Add(uint32_t nOuts, Amount fee, const Input* pInp = nullptr)
+			{
+				Transaction::Ptr pTx = std::make_shared<Transaction>();
+				for (uint32_t i = 0; i < nOuts; i++)
+				{
+					pTx->m_vOutputs.emplace_back(new Output);
+					ECC::GenRandom(pTx->m_vOutputs.back()->m_Commitment.m_X);
+				}
+
+				if (pInp)
+				{
+					pTx->m_vInputs.emplace_back(new Input);
+					pTx->m_vInputs.back()->m_Commitment = pInp->m_Commitment;
+				}
+
+				std::unique_ptr<TxKernelStd> pKrn(new TxKernelStd);
+				ECC::GenRandom(pKrn->m_Commitment.m_X);
+				ECC::GenRandom(pKrn->m_Internal.m_ID);
+				pKrn->m_Fee = fee;
+				pTx->m_vKernels.push_back(std::move(pKrn));
+				pTx->Normalize();
+
+				Element* p = new Element;
+				p->m_bAggregating = false;
+				p->m_Time.m_Value = 0;
+				p->m_Profit.m_Fee = fee;
+				p->m_Profit.SetSize(*pTx, 0);
+				p->m_pValue = std::move(pTx);
+				p->m_Height.Reset();
+				p->m_FeeReserve = 0;
+				p->m_Tip = m_hvTip;
+
+				InsertKrn(*p);
+				InsertAggr(*p);
+				return *p;
+			}
+		};
+
+		MyStem stem;
+
+		MyStem::Element& x10 = stem.Add(10, 100);
+		MyStem::Element& x7a = stem.Add(7, 100);
+		MyStem::Element& x7b = stem.Add(7, 1000);
+		MyStem::Element& x3 = stem.Add(3, 100);
+
+		// the one with the most outputs that fits
+		MyStem::Element& y = stem.Add(2, 100);
+		stem.Aggregate(y, 12);
+		verify_test(y.m_pValue->m_vOutputs.size() == 12);
+		verify_test(stem.m_setOutputs.size() == 4);
+
+		// the more profitable of the equal ones, then the remaining room is filled
+		MyStem::Element& z = stem.Add(1, 100);
+		stem.Aggregate(z, 12);
+		verify_test(z.m_pValue->m_vOutputs.size() == 11);
+		verify_test(stem.m_setOutputs.size() == 3);
+		verify_test(stem.m_setOutputs.end() != stem.m_setOutputs.find(x7a.m_Outputs));
+
+		verify_test(z.m_Profit.m_Fee == AmountBig::Type(Amount(1200)));
+		verify_test(z.m_Outputs.m_Count == 11);
+		verify_test(!stem.m_FullValidations);
+		verify_test(stem.m_Stats.m_Merged == 3);
+		verify_test(stem.m_Stats.m_MergedIncremental == 3);
+
+		// common inputs, or an outdated context - must be fully validated
+		stem.FinishAggr(y);
+		stem.FinishAggr(z);
+		verify_test(stem.m_Stats.m_Aggregated == 2);
+		verify_test(stem.m_setOutputs.size() == 1);
+
+		Input inp;
+		ECC::GenRandom(inp.m_Commitment.m_X);
+		MyStem::Element& u = stem.Add(1, 100, &inp);
+		MyStem::Element& v = stem.Add(1, 100, &inp);
+		stem.Aggregate(u, 2);
+		verify_test(stem.m_FullValidations == 1);
+
+		stem.m_hvTip.Inc();
+		MyStem::Element& w = stem.Add(1, 100);
+		stem.Aggregate(w, 3);
+		verify_test(stem.m_FullValidations == 2);
+		verify_test(stem.m_Stats.m_Merged == 5);
+		verify_test(stem.m_Stats.m_MergedIncremental == 3);
+
+		(void) x10;
+		(void) x7b;
+		(void) x3;
+		(void) v;
+	}
+
 }
 
 void TestAll()
@@ -3299,6 +3764,7 @@ void TestAll()
 	if (!bClientProtoOnly)
 	{
 		beam::TestHalving();
+		beam::TestStemAggregation();
 		beam::TestChainworkProof();
 	}
 
@@ -3393,6 +3859,18 @@ void TestAll()
 
 	beam::TestFlyClient();
 	beam::DeleteFile(beam::g_sz);
+
+	printf("Node multi-owner test...\n");
+	fflush(stdout);
+
+	beam::TestMultiOwner();
+	beam::DeleteFile(beam::g_sz);
+
+	printf("Node snapshot test...\n");
+	fflush(stdout);
+
+	beam::TestSnapshot();
+	beam::DeleteFile(beam::g_sz);
 }
 
 int main()
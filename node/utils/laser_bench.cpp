@@ -0,0 +1,603 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Laser scale benchmark: 2 clients open N channels to each other via a local node, then the cost of keeping
+// the idle channels up-to-date w.r.t. the blockchain is measured. Once with all the channels updated on each
+// block, and once with the channels kept in a deadline heap (as the laser mediator does).
+//
+// usage: laser_bench [channels=100] [blocks=40] [lock time=40]
+
+#include "../node.h"
+#include "../../core/fly_client.h"
+#include "../../core/treasury.h"
+#include "../../core/lightning.h"
+#include <chrono>
+#include <queue>
+
+#define LOG_VERBOSE_ENABLED 0
+#include "utility/logger.h"
+
+namespace beam {
+namespace Lightning {
+
+#ifdef WIN32
+const char* g_sz = "laser_bench.db";
+#else // WIN32
+const char* g_sz = "/tmp/laser_bench.db";
+#endif // WIN32
+
+uint32_t g_Channels = 100;
+uint32_t g_Blocks = 40;
+Height g_LockTime = 40;
+
+const Amount g_CoinValue = 1000000;
+
+void CreateTestKdf(Key::IKdf::Ptr& pKdf, size_t iWallet)
+{
+	ECC::Hash::Value hv;
+	ECC::Hash::Processor()
+		<< "bench-wallet"
+		<< iWallet
+		>> hv;
+
+	ECC::HKdf::Create(pKdf, hv);
+}
+
+struct Client
+{
+	struct WalletID
+	{
+		uintBigFor<BbsChannel>::Type m_Channel;
+		PeerID m_Pk;
+
+		template <typename Archive>
+		void serialize(Archive& ar)
+		{
+			ar
+				& m_Channel
+				& m_Pk;
+		}
+	};
+
+	typedef uintBig_t<16> ChannelID;
+	typedef std::map<uint32_t, ByteBuffer> FieldMap;
+	typedef std::map<CoinID, Height> CoinMap;
+
+	struct Codes
+	{
+		static const uint32_t MyWid = (1024 << 16) + 31;
+	};
+
+	Key::IKdf::Ptr m_pKdf;
+	Block::SystemState::HistoryMap m_Hdrs;
+	WalletID m_Wid;
+	ECC::Scalar::Native m_skBbs;
+	CoinMap m_Coins;
+	uint64_t m_nNextCoinID = 100500;
+
+	bool m_Deadline = false;
+
+	struct Stats
+	{
+		uint64_t m_Updates = 0;
+		uint64_t m_Requests = 0;
+		uint64_t m_Time_us = 0;
+	} m_Stats;
+
+	Height get_TipHeight() const
+	{
+		return m_Hdrs.m_Map.empty() ? 0 : m_Hdrs.m_Map.rbegin()->first;
+	}
+
+	struct Channel
+		:public Lightning::Channel
+	{
+		Client& m_This;
+		ChannelID m_ID;
+		WalletID m_widTrg;
+		bool m_SendMyWid = true;
+		Height m_hScheduled = MaxHeight;
+
+		Channel(Client& x) :m_This(x) {}
+
+		virtual Height get_Tip() const override { return m_This.get_TipHeight(); }
+		virtual proto::FlyClient::INetwork& get_Net() override { return m_This.m_Conn; }
+		virtual void get_Kdf(ECC::Key::IKdf::Ptr& pKdf) override { pKdf = m_This.m_pKdf; }
+
+		virtual void AllocTxoID(CoinID& cid) override
+		{
+			cid.set_Subkey(0);
+			cid.m_Idx = m_This.m_nNextCoinID++;
+		}
+
+		virtual Amount SelectInputs(std::vector<CoinID>& vInp, Amount valRequired, Asset::ID nAssetID) override
+		{
+			assert(!nAssetID);
+			Height h = m_This.get_TipHeight();
+			Amount nDone = 0;
+
+			for (CoinMap::iterator it = m_This.m_Coins.begin(); (nDone < valRequired) && (m_This.m_Coins.end() != it); it++)
+			{
+				if (it->second <= h)
+				{
+					nDone += it->first.m_Value;
+					vInp.push_back(it->first);
+				}
+			}
+
+			return nDone;
+		}
+
+		virtual void SendPeer(Storage::Map&& dataOut) override
+		{
+			if (m_SendMyWid)
+			{
+				m_SendMyWid = false;
+				dataOut.Set(m_This.m_Wid, Codes::MyWid);
+			}
+
+			Serializer ser;
+			ser & m_ID;
+			ser & Cast::Down<FieldMap>(dataOut);
+
+			m_This.Send(*this, ser);
+		}
+
+		virtual void OnCoin(const CoinID& cid, Height h, CoinState eState, bool bReverse) override
+		{
+			bool bAdd = (CoinState::Confirmed == eState) ? !bReverse : bReverse;
+			if (bAdd)
+				m_This.m_Coins[cid] = h;
+			else
+				m_This.m_Coins.erase(cid);
+		}
+	};
+
+	std::map<ChannelID, std::unique_ptr<Channel> > m_Channels;
+
+	typedef std::pair<Height, ChannelID> ScheduledUpdate;
+	std::priority_queue<ScheduledUpdate, std::vector<ScheduledUpdate>, std::greater<ScheduledUpdate> > m_Queue;
+
+	void Schedule(Channel& c, Height h)
+	{
+		if (c.m_hScheduled <= h)
+			return;
+
+		c.m_hScheduled = h;
+		m_Queue.push(ScheduledUpdate(h, c.m_ID));
+	}
+
+	Channel& AddChannel(const ChannelID& id)
+	{
+		std::unique_ptr<Channel>& pCh = m_Channels[id];
+		pCh.reset(new Channel(*this));
+		pCh->m_ID = id;
+		Schedule(*pCh, 0);
+		return *pCh;
+	}
+
+	struct NodeEvts
+		:public proto::FlyClient
+		,public proto::FlyClient::Request::IHandler
+		,public proto::FlyClient::IBbsReceiver
+	{
+		// proto::FlyClient
+		virtual void OnNewTip() override { get_ParentObj().OnNewTip(); }
+		virtual void OnRolledBack() override;
+		virtual Block::SystemState::IHistory& get_History() override { return get_ParentObj().m_Hdrs; }
+		virtual void OnOwnedNode(const PeerID&, bool bUp) override {}
+		// proto::FlyClient::Request::IHandler
+		virtual void OnComplete(Request&) override {}
+		// proto::FlyClient::IBbsReceiver
+		virtual void OnMsg(proto::BbsMsg&&) override;
+
+		IMPLEMENT_GET_PARENT_OBJ(Client, m_NodeEvts)
+	} m_NodeEvts;
+
+	struct MyNetwork
+		:public proto::FlyClient::NetworkStd
+	{
+		using proto::FlyClient::NetworkStd::NetworkStd;
+
+		virtual void PostRequestInternal(proto::FlyClient::Request& r) override
+		{
+			get_ParentObj().m_Stats.m_Requests++;
+			proto::FlyClient::NetworkStd::PostRequestInternal(r);
+		}
+
+		IMPLEMENT_GET_PARENT_OBJ(Client, m_Conn)
+	} m_Conn;
+
+	Client()
+		:m_Conn(m_NodeEvts)
+	{
+	}
+
+	void OnNewTip();
+	void UpdateChannel(Channel&, Height hTip);
+	void OnMsg(Blob&&);
+	void Send(Channel&, Serializer&);
+	void Initialize();
+	bool OpenChannel(const WalletID& widTrg, Amount nMy, Amount nTrg);
+	uint32_t get_OpenCount() const;
+};
+
+void Client::OnNewTip()
+{
+	auto t0 = std::chrono::steady_clock::now();
+	Height hTip = get_TipHeight();
+
+	if (m_Deadline)
+	{
+		std::vector<ChannelID> vDue;
+		while (!m_Queue.empty() && (m_Queue.top().first <= hTip))
+		{
+			ScheduledUpdate su = m_Queue.top();
+			m_Queue.pop();
+
+			auto it = m_Channels.find(su.second);
+			if ((m_Channels.end() == it) || (it->second->m_hScheduled != su.first))
+				continue; // rescheduled
+
+			it->second->m_hScheduled = MaxHeight;
+			vDue.push_back(su.second);
+		}
+
+		for (const auto& id : vDue)
+			UpdateChannel(*m_Channels[id], hTip);
+	}
+	else
+	{
+		for (auto& x : m_Channels)
+			UpdateChannel(*x.second, hTip);
+	}
+
+	m_Stats.m_Time_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void Client::UpdateChannel(Channel& c, Height hTip)
+{
+	if (!m_Deadline || (c.get_NextUpdate() <= hTip))
+	{
+		c.Update();
+		m_Stats.m_Updates++;
+	}
+
+	if (m_Deadline)
+		Schedule(c, std::max(c.get_NextUpdate(), hTip + 1));
+}
+
+void Client::NodeEvts::OnRolledBack()
+{
+	for (auto& x : get_ParentObj().m_Channels)
+	{
+		x.second->OnRolledBack();
+		get_ParentObj().Schedule(*x.second, 0);
+	}
+}
+
+void Client::NodeEvts::OnMsg(proto::BbsMsg&& msg)
+{
+	if (msg.m_Message.empty())
+		return;
+
+	Blob blob;
+
+	uint8_t* pMsg = &msg.m_Message.front();
+	blob.n = static_cast<uint32_t>(msg.m_Message.size());
+
+	if (!proto::Bbs::Decrypt(pMsg, blob.n, get_ParentObj().m_skBbs))
+		return;
+
+	blob.p = pMsg;
+	get_ParentObj().OnMsg(std::move(blob));
+}
+
+void Client::OnMsg(Blob&& blob)
+{
+	ChannelID id;
+	Storage::Map dataIn;
+
+	try {
+		Deserializer der;
+		der.reset(blob.p, blob.n);
+
+		der & id;
+		der & Cast::Down<FieldMap>(dataIn);
+	}
+	catch (const std::exception&) {
+		return;
+	}
+
+	auto it = m_Channels.find(id);
+	Channel* pCh = nullptr;
+	if (m_Channels.end() == it)
+	{
+		WalletID wid;
+		if (!dataIn.Get(wid, Codes::MyWid))
+			return;
+
+		pCh = &AddChannel(id);
+		pCh->m_widTrg = wid;
+	}
+	else
+		pCh = it->second.get();
+
+	pCh->OnPeerData(dataIn);
+	Schedule(*pCh, 0);
+}
+
+void Client::Send(Channel& c, Serializer& ser)
+{
+	proto::FlyClient::RequestBbsMsg::Ptr pReq(new proto::FlyClient::RequestBbsMsg);
+	c.m_widTrg.m_Channel.Export(pReq->m_Msg.m_Channel);
+
+	ECC::NoLeak<ECC::Hash::Value> hvRandom;
+	ECC::GenRandom(hvRandom.V);
+
+	ECC::Scalar::Native nonce;
+	m_pKdf->DeriveKey(nonce, hvRandom.V);
+
+	if (proto::Bbs::Encrypt(pReq->m_Msg.m_Message, c.m_widTrg.m_Pk, nonce, ser.buffer().first, static_cast<uint32_t>(ser.buffer().second)))
+	{
+		pReq->m_Msg.m_TimePosted = getTimestamp();
+		m_Conn.PostRequest(*pReq, m_NodeEvts);
+	}
+}
+
+void Client::Initialize()
+{
+	m_Conn.Connect();
+
+	Key::ID kid;
+	kid.m_Type = Key::Type::Bbs;
+
+	uintBigFor<uint64_t>::Type val;
+	ECC::GenRandom(val);
+	val.Export(kid.m_Idx);
+
+	m_pKdf->DeriveKey(m_skBbs, kid);
+	m_Wid.m_Pk.FromSk(m_skBbs);
+
+	BbsChannel ch;
+	m_Wid.m_Pk.ExportWord<0>(ch);
+	ch %= proto::Bbs::s_MaxWalletChannels;
+	m_Wid.m_Channel = ch;
+
+	m_Conn.BbsSubscribe(ch, getTimestamp(), &m_NodeEvts);
+}
+
+bool Client::OpenChannel(const WalletID& widTrg, Amount nMy, Amount nTrg)
+{
+	ChannelID id;
+	ECC::GenRandom(id);
+
+	Channel& c = AddChannel(id);
+	c.m_widTrg = widTrg;
+
+	c.m_Params.m_hRevisionMaxLifeTime = 1440;
+	c.m_Params.m_hLockTime = g_LockTime;
+	c.m_Params.m_hPostLockReserve = 10;
+	c.m_Params.m_Fee = 101;
+
+	return c.Open(nMy, nTrg, 20);
+}
+
+uint32_t Client::get_OpenCount() const
+{
+	uint32_t nCount = 0;
+	for (const auto& x : m_Channels)
+		if (Channel::State::Open == x.second->get_State())
+			nCount++;
+	return nCount;
+}
+
+struct Bench
+	:public Node::IObserver
+{
+	Client m_pC[2];
+	Node m_Node;
+
+	bool m_Deadline;
+	Height m_hMeasureFrom = 0;
+
+	Bench(bool bDeadline) :m_Deadline(bDeadline) {}
+
+	virtual void OnSyncProgress() override {}
+	virtual void OnRolledBack(const Block::SystemState::ID& id) override {}
+
+	virtual void OnStateChanged() override
+	{
+		Height h = m_Node.get_Processor().m_Cursor.m_ID.m_Height;
+
+		if (3 == h)
+		{
+			std::cout << "Opening " << g_Channels << " channels..." << std::endl;
+			for (uint32_t i = 0; i < g_Channels; i++)
+				if (!m_pC[0].OpenChannel(m_pC[1].m_Wid, 25000, 34000))
+					std::cout << "Failed to open channel " << i << std::endl;
+		}
+
+		if (!m_hMeasureFrom)
+		{
+			if ((h > 3) && (m_pC[0].get_OpenCount() == g_Channels) && (m_pC[1].get_OpenCount() == g_Channels))
+			{
+				std::cout << "H=" << h << " All channels are open, measuring..." << std::endl;
+				m_hMeasureFrom = h;
+				for (size_t i = 0; i < _countof(m_pC); i++)
+					ZeroObject(m_pC[i].m_Stats);
+			}
+			else if (h > 60)
+			{
+				std::cout << "H=" << h << " Channels not opened: " << m_pC[0].get_OpenCount() << ", " << m_pC[1].get_OpenCount() << std::endl;
+				io::Reactor::get_Current().stop();
+			}
+		}
+		else if (h >= m_hMeasureFrom + g_Blocks)
+			io::Reactor::get_Current().stop();
+	}
+
+	void MakeTreasury();
+	void Run();
+	void Report(std::ostream&) const;
+};
+
+void Bench::MakeTreasury()
+{
+	Treasury tres;
+	Treasury::Parameters pars;
+	pars.m_Bursts = g_Channels + 1;
+	pars.m_Maturity0 = 1;
+	pars.m_MaturityStep = 0;
+
+	for (size_t i = 0; i < _countof(m_pC); i++)
+	{
+		CreateTestKdf(m_pC[i].m_pKdf, i);
+
+		PeerID pid;
+		ECC::Scalar::Native sk;
+		Treasury::get_ID(*m_pC[i].m_pKdf, pid, sk);
+
+		Treasury::Entry* pE = tres.CreatePlan(pid, 0, pars);
+		for (auto& g : pE->m_Request.m_vGroups)
+			for (auto& c : g.m_vCoins)
+				c.m_Value = g_CoinValue;
+
+		pE->m_pResponse.reset(new Treasury::Response);
+		uint64_t nIndex = 1;
+		pE->m_pResponse->Create(pE->m_Request, *m_pC[i].m_pKdf, nIndex);
+
+		for (const auto& g : pE->m_pResponse->m_vGroups)
+		{
+			for (const auto& coin : g.m_vCoins)
+			{
+				CoinID cid;
+				if (coin.m_pOutput->Recover(0, *m_pC[i].m_pKdf, cid))
+					m_pC[i].m_Coins[cid] = coin.m_pOutput->m_Incubation;
+			}
+		}
+	}
+
+	Treasury::Data data;
+	data.m_sCustomMsg = "LN";
+	tres.Build(data);
+
+	Serializer ser;
+	ser & data;
+
+	ser.swap_buf(m_Node.m_Cfg.m_Treasury);
+
+	ECC::Hash::Processor() << Blob(m_Node.m_Cfg.m_Treasury) >> Rules::get().TreasuryChecksum;
+}
+
+void Bench::Run()
+{
+	MakeTreasury();
+
+	io::Reactor::Ptr pReactor(io::Reactor::create());
+	io::Reactor::Scope scope(*pReactor);
+
+	DeleteFile(g_sz);
+	m_Node.m_Cfg.m_sPathLocal = g_sz;
+	m_Node.m_Cfg.m_Listen.port(25005);
+	m_Node.m_Cfg.m_Listen.ip(INADDR_ANY);
+	m_Node.m_Cfg.m_MiningThreads = 1;
+	m_Node.m_Cfg.m_TestMode.m_FakePowSolveTime_ms = 500;
+
+	m_Node.m_Cfg.m_Dandelion.m_AggregationTime_ms = 0;
+	m_Node.m_Cfg.m_Dandelion.m_OutputsMin = 0;
+
+	{
+		ECC::uintBig seed = 345U;
+		m_Node.m_Keys.InitSingleKey(seed);
+	}
+
+	m_Node.m_Cfg.m_Observer = this;
+
+	m_Node.Initialize();
+	m_Node.m_PostStartSynced = true;
+
+	for (size_t i = 0; i < _countof(m_pC); i++)
+	{
+		m_pC[i].m_Deadline = m_Deadline;
+		m_pC[i].m_Conn.m_Cfg.m_vNodes.push_back(m_Node.m_Cfg.m_Listen);
+		m_pC[i].Initialize();
+	}
+
+	pReactor->run();
+
+	for (size_t i = 0; i < _countof(m_pC); i++)
+		m_pC[i].m_Channels.clear();
+}
+
+void Bench::Report(std::ostream& os) const
+{
+	if (!m_hMeasureFrom)
+		return;
+
+	Client::Stats s;
+	for (size_t i = 0; i < _countof(m_pC); i++)
+	{
+		s.m_Updates += m_pC[i].m_Stats.m_Updates;
+		s.m_Requests += m_pC[i].m_Stats.m_Requests;
+		s.m_Time_us += m_pC[i].m_Stats.m_Time_us;
+	}
+
+	os
+		<< (m_Deadline ? "deadline heap: " : "update all:    ")
+		<< "channels=" << g_Channels << "x2 blocks=" << g_Blocks
+		<< " updates/block=" << s.m_Updates / g_Blocks
+		<< " requests/block=" << s.m_Requests / g_Blocks
+		<< " tip processing/block=" << s.m_Time_us / g_Blocks << "us"
+		<< std::endl;
+}
+
+void Test()
+{
+	Rules::get().pForks[1].m_Height = 1;
+	Rules::get().pForks[2].m_Height = 1;
+	Rules::get().FakePoW = true;
+	Rules::get().MaxRollback = 5;
+	Rules::get().UpdateChecksum();
+
+	std::ostringstream os;
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		Bench b(!!i);
+		b.Run();
+		b.Report(os);
+	}
+
+	std::cout << os.str();
+}
+
+} // namespace Lightning
+} // namespace beam
+
+int main(int argc, char* argv[])
+{
+	using namespace beam::Lightning;
+
+	if (argc > 1)
+		g_Channels = std::stoul(argv[1]);
+	if (argc > 2)
+		g_Blocks = std::stoul(argv[2]);
+	if (argc > 3)
+		g_LockTime = std::stoul(argv[3]);
+
+	Test();
+	beam::DeleteFile(g_sz);
+	return 0;
+}
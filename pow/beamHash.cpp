@@ -1,115 +1,124 @@
-// Copyright 2018 The Beam Team
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-//    http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-
-#include "core/block_crypt.h"
-#include "crypto/equihashR.h"
-#include "crypto/beamHashIII.h"
-#include "uint256.h"
-#include "arith_uint256.h"
-#include <utility>
-#include "utility/logger.h"
-#include <mutex>
-
-namespace beam
-{
-
-struct Block::PoW::Helper
-{
-	blake2b_state m_Blake;
-
-	EquihashR<150,5,0> BeamHashI;
-	EquihashR<150,5,3> BeamHashII;
-	BeamHash_III       BeamHashIII;
-
-	PoWScheme* getCurrentPoW(Height h) {
-		if (h < Rules::get().pForks[1].m_Height) {
-			return &BeamHashI;
-		} else if (h < Rules::get().pForks[2].m_Height) {
-			return &BeamHashII;
-		} else {
-			return &BeamHashIII;
-		}
-	}
-
-	void Reset(const void* pInput, uint32_t nSizeInput, const NonceType& nonce, Height h)
-	{
-		getCurrentPoW(h)->InitialiseState(m_Blake);
-
-		// H(I||...
-		blake2b_update(&m_Blake, (uint8_t*) pInput, nSizeInput);
-		blake2b_update(&m_Blake, nonce.m_pData, nonce.nBytes);
-	}
-
-	bool TestDifficulty(const uint8_t* pSol, uint32_t nSol, Difficulty d) const
-	{
-		ECC::Hash::Value hv;
-		ECC::Hash::Processor() << Blob(pSol, nSol) >> hv;
-
-		return d.IsTargetReached(hv);
-	}
-};
-
-bool Block::PoW::Solve(const void* pInput, uint32_t nSizeInput, Height h, const Cancel& fnCancel)
-{
-	Helper hlp;
-
-	std::function<bool(const beam::ByteBuffer&)> fnValid = [this, &hlp](const beam::ByteBuffer& solution)
-		{
-    		if (!hlp.TestDifficulty(&solution.front(), (uint32_t) solution.size(), m_Difficulty))
-				return false;
-			assert(solution.size() == m_Indices.size());
-            std::copy(solution.begin(), solution.end(), m_Indices.begin());
-            return true;
-        };
-
-
-    std::function<bool(SolverCancelCheck)> fnCancelInternal = [fnCancel](SolverCancelCheck pos) {
-        return fnCancel(false);
-    };
-
-    while (true)
-    {
-		hlp.Reset(pInput, nSizeInput, m_Nonce, h);
-
-		try {
-
-			if (hlp.getCurrentPoW(h)->OptimisedSolve(hlp.m_Blake, fnValid, fnCancelInternal))
-				break;
-
-		} catch (const SolverCancelledException&) {
-			return false;
-		}
-
-		if (fnCancel(true))
-			return false; // retry not allowed
-
-        m_Nonce.Inc();
-    }
-
-    return true;
-}
-
-bool Block::PoW::IsValid(const void* pInput, uint32_t nSizeInput, Height h) const
-{
-	Helper hlp;
-	hlp.Reset(pInput, nSizeInput, m_Nonce, h);
-
-	std::vector<uint8_t> v(m_Indices.begin(), m_Indices.end());
-    return
-		hlp.getCurrentPoW(h)->IsValidSolution(hlp.m_Blake, v) &&
-		hlp.TestDifficulty(&m_Indices.front(), (uint32_t) m_Indices.size(), m_Difficulty);
-}
-
-} // namespace beam
-
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/block_crypt.h"
+#include "crypto/equihashR.h"
+#include "crypto/beamHashIII.h"
+#include "uint256.h"
+#include "arith_uint256.h"
+#include <utility>
+#include "utility/logger.h"
+#include <mutex>
+
+namespace beam
+{
+
+struct Block::PoW::Helper
+{
+	blake2b_state m_Blake;
+
+	EquihashR<150,5,0> BeamHashI;
+	EquihashR<150,5,3> BeamHashII;
+	BeamHash_III       BeamHashIII;
+
+	PoWScheme* getCurrentPoW(Height h) {
+		if (h < Rules::get().pForks[1].m_Height) {
+			return &BeamHashI;
+		} else if (h < Rules::get().pForks[2].m_Height) {
+			return &BeamHashII;
+		} else {
+			return &BeamHashIII;
+		}
+	}
+
+	void Reset(const void* pInput, uint32_t nSizeInput, const NonceType& nonce, Height h)
+	{
+		getCurrentPoW(h)->InitialiseState(m_Blake);
+
+		// H(I||...
+		blake2b_update(&m_Blake, (uint8_t*) pInput, nSizeInput);
+		blake2b_update(&m_Blake, nonce.m_pData, nonce.nBytes);
+	}
+
+	static bool TestDifficulty(const uint8_t* pSol, uint32_t nSol, Difficulty d)
+	{
+		ECC::Hash::Value hv;
+		ECC::Hash::Processor() << Blob(pSol, nSol) >> hv;
+
+		return d.IsTargetReached(hv);
+	}
+};
+
+bool Block::PoW::Solve(const void* pInput, uint32_t nSizeInput, Height h, const Cancel& fnCancel)
+{
+	Helper hlp;
+
+	std::function<bool(const beam::ByteBuffer&)> fnValid = [this, &hlp](const beam::ByteBuffer& solution)
+		{
+    		if (!hlp.TestDifficulty(&solution.front(), (uint32_t) solution.size(), m_Difficulty))
+				return false;
+			assert(solution.size() == m_Indices.size());
+            std::copy(solution.begin(), solution.end(), m_Indices.begin());
+            return true;
+        };
+
+
+    std::function<bool(SolverCancelCheck)> fnCancelInternal = [fnCancel](SolverCancelCheck pos) {
+        return fnCancel(false);
+    };
+
+    while (true)
+    {
+		hlp.Reset(pInput, nSizeInput, m_Nonce, h);
+
+		try {
+
+			if (hlp.getCurrentPoW(h)->OptimisedSolve(hlp.m_Blake, fnValid, fnCancelInternal))
+				break;
+
+		} catch (const SolverCancelledException&) {
+			return false;
+		}
+
+		if (fnCancel(true))
+			return false; // retry not allowed
+
+        m_Nonce.Inc();
+    }
+
+    return true;
+}
+
+bool Block::PoW::IsValid(const void* pInput, uint32_t nSizeInput, Height h) const
+{
+	// the difficulty test is much cheaper than the solution verification, do it first
+	if (!Helper::TestDifficulty(&m_Indices.front(), (uint32_t) m_Indices.size(), m_Difficulty))
+		return false;
+
+	Helper hlp;
+	hlp.Reset(pInput, nSizeInput, m_Nonce, h);
+
+	PoWScheme* pScheme = hlp.getCurrentPoW(h);
+	return (pScheme == &hlp.BeamHashIII) ?
+		BeamHash_III::IsValidSolution(hlp.m_Blake, &m_Indices.front(), m_Indices.size()) :
+		pScheme->IsValidSolution(hlp.m_Blake, std::vector<uint8_t>(m_Indices.begin(), m_Indices.end()));
+}
+
+bool Block::PoW::TestDifficulty(Difficulty d) const
+{
+	return Helper::TestDifficulty(&m_Indices.front(), (uint32_t) m_Indices.size(), d);
+}
+
+} // namespace beam
+
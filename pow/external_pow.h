@@ -41,6 +41,17 @@ public:
         std::string apiKeysFile;
         std::string certFile;
         std::string privKeyFile;
+        unsigned threads = 0; // extra threads accepting and serving the connections, 0 - serve them on the caller's reactor
+        unsigned shareInterval = 0; // vardiff: desired seconds between the shares of a miner, 0 - miners get the block difficulty
+    };
+
+    struct WorkerStats {
+        io::Address address;
+        Difficulty shareDifficulty;
+        uint64_t sharesAccepted = 0;
+        uint64_t sharesRejected = 0;
+        uint64_t sharesExpired = 0;
+        double rate = 0; // accepted work per second, in the solutions of the minimal difficulty
     };
 
     // creates stratum server
@@ -68,6 +79,9 @@ public:
     virtual void stop_current() = 0;
 
     virtual void stop() = 0;
+
+    // currently connected miners
+    virtual void get_worker_stats(std::vector<WorkerStats>& v) { v.clear(); }
 };
 
 } //namespace
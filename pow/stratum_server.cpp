@@ -36,8 +36,16 @@ namespace stratum {
 
 static const uint64_t SERVER_RESTART_TIMER = 1;
 static const uint64_t ACL_REFRESH_TIMER = 2;
+static const uint64_t VARDIFF_TIMER = 3;
+static const uint64_t STATS_TIMER = 4;
 static const unsigned SERVER_RESTART_INTERVAL = 1000;
 static const unsigned ACL_REFRESH_INTERVAL = 5000;
+static const unsigned STATS_INTERVAL = 60000;
+
+// vardiff: the share difficulty is recalculated after this number of shares, or after the time these shares were
+// expected to take. Each step changes it by at most VARDIFF_MAX_STEP times
+static const uint32_t VARDIFF_WINDOW_SHARES = 16;
+static const uint32_t VARDIFF_MAX_STEP = 4;
 
 static const char STS[] = "stratum server ";
 
@@ -52,53 +60,329 @@ Server::Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address
     _prefixSeed(0)
 {
     assert(_prefixDigits <= 6);
-    _timers.set_timer(SERVER_RESTART_TIMER, 0, BIND_THIS_MEMFN(start_server));
     if (!o.apiKeysFile.empty()) {
         _timers.set_timer(ACL_REFRESH_TIMER, 0, BIND_THIS_MEMFN(refresh_acl));
     }
     if (_prefixDigits > 0) {
         ECC::GenRandom(&_prefixSeed, 8);
     }
+    if (o.shareInterval) {
+        LOG_INFO() << STS << "vardiff is on, share interval " << o.shareInterval << " sec";
+        _timers.set_timer(STATS_TIMER, STATS_INTERVAL, BIND_THIS_MEMFN(log_stats));
+    }
+
+    unsigned threads = o.threads;
+#ifdef WIN32
+    if (threads) {
+        // the listening port cannot be shared by the threads
+        LOG_WARNING() << STS << "serving connections on the main thread only";
+        threads = 0;
+    }
+#endif // WIN32
+
+    if (!threads) {
+        _shard = std::make_unique<Shard>(*this, reactor, nullptr);
+        return;
+    }
+
+    _solutionsEvent = io::AsyncEvent::create(reactor, BIND_THIS_MEMFN(on_solutions_posted));
+
+    _workers.resize(threads);
+    for (auto& pw : _workers) {
+        pw = std::make_unique<Worker>();
+        Worker& w = *pw;
+        w._reactor = io::Reactor::create();
+        w._shard = std::make_unique<Shard>(*this, *w._reactor, &w);
+        w._event = io::AsyncEvent::create(*w._reactor, [&w]() { w.on_event(); });
+        w._thread = std::thread(
+            [](const io::Reactor::Ptr& pReactor, const Rules& r) {
+                Rules::Scope scopeRules(r);
+                pReactor->run();
+            },
+            w._reactor,
+            Rules::get()
+        );
+    }
+
+    LOG_INFO() << STS << "serving connections on " << threads << " threads";
+}
+
+Server::~Server() {
+    for (auto& pw : _workers) {
+        {
+            std::unique_lock<std::mutex> lock(pw->_mutex);
+            pw->_shutdown = true;
+        }
+        pw->_event->post();
+    }
+
+    for (auto& pw : _workers) {
+        if (pw->_thread.joinable()) {
+            pw->_thread.join();
+        }
+    }
+}
+
+void Server::refresh_acl() {
+    _acl.refresh();
+    _timers.set_timer(ACL_REFRESH_TIMER, ACL_REFRESH_INTERVAL, BIND_THIS_MEMFN(refresh_acl));
+}
+
+std::string Server::gen_nonceprefix(uint64_t connId) {
+    std::string x;
+    if (_prefixDigits > 0) {
+        ECC::Hash::Processor p;
+        ECC::Hash::Value v;
+        p << _prefixSeed << connId;
+        p >> v;
+        x = to_hex(v.m_pData, 3);
+        x = x.substr(0, _prefixDigits);
+    }
+    return x;
+}
+
+Result Server::process_solution(const Solution& sol) {
+	_recentResult.id = sol.id;
+    sol.fill_pow(_recentResult.pow);
+
+	IExternalPOW::BlockFoundResult result = _recentResult.onBlockFound();
+    stratum::ResultCode stratumCode = stratum::solution_rejected;
+    if (result == IExternalPOW::solution_accepted) {
+        stratumCode = stratum::solution_accepted;
+    } else if (result == IExternalPOW::solution_expired) {
+        stratumCode = stratum::solution_expired;
+    }
+    Result res(sol.id, stratumCode);
+    if (result == IExternalPOW::solution_accepted) {
+        res.blockhash = result._blockhash;
+    }
+    return res;
+}
+
+void Server::post_solution(Worker& worker, uint64_t from, const Solution& sol) {
+    {
+        std::unique_lock<std::mutex> lock(_solutionsMutex);
+        _solutions.push_back({ &worker, from, sol });
+    }
+    _solutionsEvent->post();
+}
+
+void Server::on_solutions_posted() {
+    std::vector<PostedSolution> v;
+    {
+        std::unique_lock<std::mutex> lock(_solutionsMutex);
+        v.swap(_solutions);
+    }
+
+    for (const auto& x : v) {
+        LOG_INFO() << STS << "solution to " << x.solution.id << " from " << io::Address::from_u64(x.from);
+
+        append_json_msg(_fw, process_solution(x.solution));
+        {
+            std::unique_lock<std::mutex> lock(x.worker->_mutex);
+            x.worker->_results.emplace_back(x.from, std::move(_currentMsg));
+        }
+        _currentMsg.clear();
+        x.worker->_event->post();
+    }
+}
+
+void Server::new_job(
+    const std::string& id,
+    const Merkle::Hash& input,
+    const Block::PoW& pow,
+    const Height& height,
+    const BlockFound& callback,
+    const CancelCallback& /* cancelCallback */
+) {
+    _recentJob.id = id;
+    _recentResult.onBlockFound = callback;
+    _recentResult.height = height;	
+
+    LOG_INFO() << STS << "new job " << id;
+
+    auto params = std::make_shared<JobParams>();
+    params->id = id;
+    params->input = input;
+    params->pow = pow;
+    params->height = height;
+
+    // serialized once, the buffers are shared by all the connections that mine with the block difficulty
+    Job jobMsg(id, input, pow, height);
+    append_json_msg(_fw, jobMsg);
+	params->msg.swap(_currentMsg);
+    _currentMsg.clear();
+
+    _recentJob.params = std::move(params);
+
+    if (_shard) {
+        _shard->set_job(_recentJob.params);
+    }
+
+    for (auto& pw : _workers) {
+        {
+            std::unique_lock<std::mutex> lock(pw->_mutex);
+            pw->_job = _recentJob.params;
+        }
+        pw->_event->post();
+    }
+
+    // TODO job cancel policy - timer
+}
+
+void Server::get_last_found_block(std::string& jobID, Height& jobHeight, Block::PoW& pow) {
+    jobID = _recentResult.id;
+    jobHeight = _recentResult.height;	
+    pow = _recentResult.pow;
+}
+
+void Server::stop_current() {
+    _recentJob.id.clear();
+}
+
+void Server::stop() {
+    stop_current();
+
+    if (_shard) {
+        _shard->stop_listening();
+    }
+
+    for (auto& pw : _workers) {
+        {
+            std::unique_lock<std::mutex> lock(pw->_mutex);
+            pw->_stopListening = true;
+        }
+        pw->_event->post();
+    }
+}
+
+void Server::get_worker_stats(std::vector<WorkerStats>& v) {
+    v.clear();
+    std::unique_lock<std::mutex> lock(_statsMutex);
+    v.reserve(_workerStats.size());
+    for (const auto& x : _workerStats) {
+        v.push_back(x.second);
+    }
+}
+
+void Server::log_stats() {
+    std::vector<WorkerStats> v;
+    get_worker_stats(v);
+
+    uint64_t accepted = 0, rejected = 0, expired = 0;
+    double rate = 0;
+    for (const auto& x : v) {
+        accepted += x.sharesAccepted;
+        rejected += x.sharesRejected;
+        expired += x.sharesExpired;
+        rate += x.rate;
+    }
+
+    LOG_INFO() << STS << "miners=" << v.size() << " shares accepted=" << accepted << " rejected=" << rejected
+        << " expired=" << expired << " rate=" << rate << " sol/s";
+
+    _timers.set_timer(STATS_TIMER, STATS_INTERVAL, BIND_THIS_MEMFN(log_stats));
+}
+
+void Server::Worker::on_event() {
+    bool stopListening, shutdown;
+    JobPtr job;
+    std::vector<std::pair<uint64_t, io::SerializedMsg> > results;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        job.swap(_job);
+        results.swap(_results);
+        stopListening = _stopListening;
+        shutdown = _shutdown;
+    }
+
+    if (!_shard) {
+        return;
+    }
+
+    if (shutdown) {
+        _shard.reset();
+        _reactor->stop();
+        return;
+    }
+
+    for (const auto& x : results) {
+        _shard->send_result(x.first, x.second);
+    }
+
+    if (job) {
+        _shard->set_job(job);
+    }
+
+    if (stopListening) {
+        _shard->stop_listening();
+    }
+}
+
+Server::Shard::Shard(Server& owner, io::Reactor& reactor, Worker* worker) :
+    _owner(owner),
+    _reactor(reactor),
+    _worker(worker),
+    _timers(reactor, 100),
+    _fw(4096, 0, [this](io::SharedBuffer&& buf){ _currentMsg.push_back(buf); }),
+    _stopped(false)
+{
+    _timers.set_timer(SERVER_RESTART_TIMER, 0, BIND_THIS_MEMFN(start_server));
+    if (_owner._options.shareInterval) {
+        _timers.set_timer(VARDIFF_TIMER, _owner._options.shareInterval * 1000, BIND_THIS_MEMFN(on_vardiff_timer));
+    }
 }
 
-void Server::start_server() {
+void Server::Shard::start_server() {
+    if (_stopped) return;
+
+    const Options& o = _owner._options;
+    bool reusePort = !_owner._workers.empty();
+
     try {
-        if (_options.privKeyFile.empty() || _options.certFile.empty()) {
-            LOG_WARNING() << STS << "TLS disabled!";
+        if (o.privKeyFile.empty() || o.certFile.empty()) {
+            if (!_worker || _worker == _owner._workers.front().get()) {
+                LOG_WARNING() << STS << "TLS disabled!";
+            }
             _server = io::TcpServer::create(
                 _reactor,
-                _bindAddress,
-                BIND_THIS_MEMFN(on_stream_accepted)
+                _owner._bindAddress,
+                BIND_THIS_MEMFN(on_stream_accepted),
+                reusePort
             );
         } else {
             _server = io::SslServer::create(
                 _reactor,
-                _bindAddress,
+                _owner._bindAddress,
                 BIND_THIS_MEMFN(on_stream_accepted),
-                _options.certFile.c_str(),
-                _options.privKeyFile.c_str()
+                o.certFile.c_str(),
+                o.privKeyFile.c_str(),
+                false,
+                false,
+                reusePort
             );
         }
-        LOG_INFO() << STS << "listens to " << _bindAddress;
+        LOG_INFO() << STS << "listens to " << _owner._bindAddress;
     } catch (const std::exception& e) {
         LOG_ERROR() << STS << "cannot start server: " << e.what() << " restarting in  " << SERVER_RESTART_INTERVAL << " msec";
         _timers.set_timer(SERVER_RESTART_TIMER, SERVER_RESTART_INTERVAL, BIND_THIS_MEMFN(start_server));
     }
 }
 
-void Server::refresh_acl() {
-    _acl.refresh();
-    _timers.set_timer(ACL_REFRESH_TIMER, ACL_REFRESH_INTERVAL, BIND_THIS_MEMFN(refresh_acl));
+void Server::Shard::stop_listening() {
+    _stopped = true;
+    _timers.cancel(SERVER_RESTART_TIMER);
+    _server.reset();
 }
 
-void Server::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
+void Server::Shard::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
     if (errorCode == 0) {
         auto peer = newStream->peer_address();
         LOG_DEBUG() << STS << "+peer " << peer;
         _connections[peer.u64()] = std::make_unique<Connection>(
             *this,
             peer.u64(),
-            gen_nonceprefix(peer.u64()),
+            _owner.gen_nonceprefix(peer.u64()),
             std::move(newStream)
         );
     } else {
@@ -107,25 +391,12 @@ void Server::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode er
     }
 }
 
-std::string Server::gen_nonceprefix(uint64_t connId) {
-    std::string x;
-    if (_prefixDigits > 0) {
-        ECC::Hash::Processor p;
-        ECC::Hash::Value v;
-        p << _prefixSeed << connId;
-        p >> v;
-        x = to_hex(v.m_pData, 3);
-        x = x.substr(0, _prefixDigits);
-    }
-    return x;
-}
-
-bool Server::on_login(uint64_t from, const Login& login) {
+bool Server::Shard::on_login(uint64_t from, const Login& login) {
     assert(_connections.count(from) > 0);
 
     auto& conn = _connections[from];
     bool loginSuccess = false;
-    if (_acl.check(login.api_key)) {
+    if (_owner._acl.check(login.api_key)) {
         conn->set_logged_in();
         loginSuccess = true;
     } else {
@@ -136,7 +407,6 @@ bool Server::on_login(uint64_t from, const Login& login) {
     res.nonceprefix = conn->get_nonceprefix();
     res.forkheight = Rules::get().pForks[1].m_Height;
     res.forkheight2 = Rules::get().pForks[2].m_Height;
-    std::cout << "Fork Heights: " << Rules::get().pForks[1].m_Height << " " <<  Rules::get().pForks[2].m_Height << std::endl;
     append_json_msg(_fw, res);
     bool sent = conn->send_msg(_currentMsg, false, !loginSuccess);
     _currentMsg.clear();
@@ -144,17 +414,36 @@ bool Server::on_login(uint64_t from, const Login& login) {
     if (!sent || !loginSuccess)
         return false;
 
-    return _connections[from]->send_msg(_recentJob.msg, true);
+    Difficulty d;
+    if (_owner._options.shareInterval) {
+        uint32_t now = GetTime_ms();
+        Miner& miner = _miners[from];
+        miner.target = Difficulty(0); // the lowest one, vardiff raises it in a few steps
+        miner.windowStart_ms = now;
+        miner.windowShares = 0;
+        miner.connected_ms = now;
+        miner.work = 0;
+        if (_job && miner.target.m_Packed > _job->pow.m_Difficulty.m_Packed) {
+            miner.target = _job->pow.m_Difficulty;
+        }
+        update_stats(from, miner, stratum::no_error);
+        d = miner.target;
+    } else if (_job) {
+        d = _job->pow.m_Difficulty;
+    }
+
+    return !_job || conn->send_msg(get_job_msg(d), true);
 }
 
-bool Server::on_solution(uint64_t from, const Solution& sol) {
+bool Server::Shard::on_solution(uint64_t from, const Solution& sol) {
 	LOG_DEBUG() << TRACE(sol.nonce) << TRACE(sol.output);
 
-	if (_prefixDigits > 0) {
+    unsigned prefixDigits = _owner._prefixDigits;
+	if (prefixDigits > 0) {
 	    const std::string& nonceprefix = _connections[from]->get_nonceprefix();
 	    if (
-	        sol.nonce.size() < _prefixDigits ||
-	        memcmp(sol.nonce.c_str(), nonceprefix.c_str(), _prefixDigits) != 0
+	        sol.nonce.size() < prefixDigits ||
+	        memcmp(sol.nonce.c_str(), nonceprefix.c_str(), prefixDigits) != 0
 	    ) {
             Result res(sol.id, stratum::solution_rejected);
             //res.nonceprefix = nonceprefix;
@@ -165,78 +454,195 @@ bool Server::on_solution(uint64_t from, const Solution& sol) {
 	    }
 	}
 
-	_recentResult.id = sol.id;
-    sol.fill_pow(_recentResult.pow);
+    if (_owner._options.shareInterval) {
+        auto it = _miners.find(from);
+        return (it == _miners.end()) || on_share(from, it->second, sol); // ignored if not logged in
+    }
+
+    return on_block_solution(from, sol);
+}
+
+bool Server::Shard::on_block_solution(uint64_t from, const Solution& sol) {
+    if (_worker) {
+        // the result will be sent after the owner processes it
+        _owner.post_solution(*_worker, from, sol);
+        return true;
+    }
 
     LOG_INFO() << STS << "solution to " << sol.id << " from " << io::Address::from_u64(from);
-	IExternalPOW::BlockFoundResult result = _recentResult.onBlockFound();
-    stratum::ResultCode stratumCode = stratum::solution_rejected;
-    if (result == IExternalPOW::solution_accepted) {
-        stratumCode = stratum::solution_accepted;
-    } else if (result == IExternalPOW::solution_expired) {
-        stratumCode = stratum::solution_expired;
+    append_json_msg(_fw, _owner.process_solution(sol));
+    bool sent = _connections[from]->send_msg(_currentMsg, true);
+    _currentMsg.clear();
+    return sent;
+}
+
+bool Server::Shard::on_share(uint64_t from, Miner& miner, const Solution& sol) {
+    if (!_job || sol.id != _job->id) {
+        update_stats(from, miner, stratum::solution_expired);
+        return send_share_result(from, sol.id, stratum::solution_expired);
     }
-    Result res(sol.id, stratumCode);
-    if (result == IExternalPOW::solution_accepted) {
-        res.blockhash = result._blockhash;
+
+    Block::PoW pow = _job->pow;
+    pow.m_Difficulty = miner.target;
+
+    // IsValid tests the difficulty before running the BeamHash verifier, so that junk shares are cheap to reject
+    if (!sol.fill_pow(pow) || !pow.IsValid(_job->input.m_pData, _job->input.nBytes, _job->height)) {
+        LOG_DEBUG() << STS << "invalid share from " << io::Address::from_u64(from);
+        update_stats(from, miner, stratum::solution_rejected);
+        return send_share_result(from, sol.id, stratum::solution_rejected);
     }
-    append_json_msg(_fw, res);
+
+    miner.work += miner.target.ToFloat();
+    miner.windowShares++;
+    update_stats(from, miner, stratum::solution_accepted);
+
+    bool ok = pow.TestDifficulty(_job->pow.m_Difficulty) ?
+        on_block_solution(from, sol) :
+        send_share_result(from, sol.id, stratum::solution_accepted);
+
+    if (ok && miner.windowShares >= VARDIFF_WINDOW_SHARES) {
+        ok = retarget(from, miner, GetTime_ms());
+    }
+    return ok;
+}
+
+bool Server::Shard::send_share_result(uint64_t from, const std::string& id, ResultCode code) {
+    append_json_msg(_fw, Result(id, code));
     bool sent = _connections[from]->send_msg(_currentMsg, true);
     _currentMsg.clear();
     return sent;
 }
 
-void Server::on_bad_peer(uint64_t from) {
-    LOG_INFO() << STS << "-peer " << io::Address::from_u64(from);
-    _connections.erase(from);
-}
+bool Server::Shard::retarget(uint64_t connId, Miner& miner, uint32_t now_ms) {
+    uint32_t dtTrg_ms = _owner._options.shareInterval * 1000 * std::max(miner.windowShares, 1U);
+    uint32_t dtSrc_ms = now_ms - miner.windowStart_ms;
+    dtSrc_ms = std::max(dtSrc_ms, dtTrg_ms / VARDIFF_MAX_STEP);
+    dtSrc_ms = std::min(dtSrc_ms, dtTrg_ms * VARDIFF_MAX_STEP);
 
-void Server::new_job(
-    const std::string& id,
-    const Merkle::Hash& input,
-    const Block::PoW& pow,
-    const Height& height,
-    const BlockFound& callback,
-    const CancelCallback& /* cancelCallback */
-) {
-    _recentJob.id = id;
-    _recentResult.onBlockFound = callback;
-    _recentResult.height = height;	
+    Difficulty::Raw wrk;
+    miner.target.Unpack(wrk);
 
-    LOG_INFO() << STS << "new job " << id << " will be sent to " << _connections.size() << " connected peers";
+    Difficulty d;
+    d.Calculate(wrk, 1, dtTrg_ms, dtSrc_ms);
+    if (_job && d.m_Packed > _job->pow.m_Difficulty.m_Packed) {
+        d = _job->pow.m_Difficulty; // no need to go beyond
+    }
 
-    Job jobMsg(id, input, pow, height);
-    append_json_msg(_fw, jobMsg);
-	_recentJob.msg.swap(_currentMsg);
-    _currentMsg.clear();
+    miner.windowStart_ms = now_ms;
+    miner.windowShares = 0;
 
-    for (auto& p : _connections) {
-        if (!p.second->send_msg(_recentJob.msg, true)) {
-            _deadConnections.push_back(p.first);
+    if (d.m_Packed == miner.target.m_Packed) {
+        return true;
+    }
+
+    LOG_DEBUG() << STS << "share difficulty " << miner.target << " -> " << d << " for " << io::Address::from_u64(connId);
+    miner.target = d;
+    update_stats(connId, miner, stratum::no_error);
+
+    // the same job, with the new target
+    return !_job || _connections[connId]->send_msg(get_job_msg(d), true);
+}
+
+void Server::Shard::on_vardiff_timer() {
+    uint32_t now = GetTime_ms();
+    uint32_t window_ms = _owner._options.shareInterval * 1000 * VARDIFF_WINDOW_SHARES;
+
+    // miners that are too slow to fill the window
+    for (auto& x : _miners) {
+        if ((now - x.second.windowStart_ms >= window_ms) && !retarget(x.first, x.second, now)) {
+            _deadConnections.push_back(x.first);
         }
     }
 
     for (auto c : _deadConnections) {
-        _connections.erase(c);
+        drop_connection(c);
     }
     _deadConnections.clear();
 
-    // TODO job cancel policy - timer
+    _timers.set_timer(VARDIFF_TIMER, _owner._options.shareInterval * 1000, BIND_THIS_MEMFN(on_vardiff_timer));
 }
 
-void Server::get_last_found_block(std::string& jobID, Height& jobHeight, Block::PoW& pow) {
-    jobID = _recentResult.id;
-    jobHeight = _recentResult.height;	
-    pow = _recentResult.pow;
+void Server::Shard::update_stats(uint64_t connId, const Miner& miner, ResultCode code) {
+    uint32_t dt = GetTime_ms() - miner.connected_ms;
+
+    std::unique_lock<std::mutex> lock(_owner._statsMutex);
+    WorkerStats& s = _owner._workerStats[connId];
+    s.address = io::Address::from_u64(connId);
+    s.shareDifficulty = miner.target;
+    s.rate = dt ? miner.work * 1000 / dt : 0;
+
+    switch (code) {
+    case stratum::solution_accepted: s.sharesAccepted++; break;
+    case stratum::solution_rejected: s.sharesRejected++; break;
+    case stratum::solution_expired: s.sharesExpired++; break;
+    default: break;
+    }
 }
 
-void Server::stop_current() {
-    _recentJob.id.clear();
+void Server::Shard::drop_connection(uint64_t connId) {
+    _connections.erase(connId);
+    if (_miners.erase(connId)) {
+        std::unique_lock<std::mutex> lock(_owner._statsMutex);
+        _owner._workerStats.erase(connId);
+    }
 }
 
-void Server::stop() {
-    stop_current();
-    _server.reset();
+void Server::Shard::send_result(uint64_t connId, const io::SerializedMsg& msg) {
+    auto it = _connections.find(connId);
+    if (it != _connections.end() && !it->second->send_msg(msg, true)) {
+        drop_connection(connId);
+    }
+}
+
+void Server::Shard::on_bad_peer(uint64_t from) {
+    LOG_INFO() << STS << "-peer " << io::Address::from_u64(from);
+    drop_connection(from);
+}
+
+const io::SerializedMsg& Server::Shard::get_job_msg(Difficulty d) {
+    assert(_job);
+    auto it = _jobMsgs.find(d.m_Packed);
+    if (it != _jobMsgs.end()) {
+        return it->second;
+    }
+
+    Block::PoW pow = _job->pow;
+    pow.m_Difficulty = d;
+    append_json_msg(_fw, Job(_job->id, _job->input, pow, _job->height));
+
+    io::SerializedMsg& msg = _jobMsgs[d.m_Packed];
+    msg.swap(_currentMsg);
+    _currentMsg.clear();
+    return msg;
+}
+
+void Server::Shard::set_job(const JobPtr& job) {
+    _job = job;
+    _jobMsgs.clear();
+    _jobMsgs[job->pow.m_Difficulty.m_Packed] = job->msg;
+
+    LOG_DEBUG() << STS << "job will be sent to " << _connections.size() << " connected peers";
+
+    for (auto& p : _connections) {
+        Difficulty d = job->pow.m_Difficulty;
+        auto it = _miners.find(p.first);
+        if (it != _miners.end()) {
+            Miner& miner = it->second;
+            if (miner.target.m_Packed > d.m_Packed) {
+                miner.target = d;
+            }
+            d = miner.target;
+        }
+
+        if (!p.second->send_msg(get_job_msg(d), true)) {
+            _deadConnections.push_back(p.first);
+        }
+    }
+
+    for (auto c : _deadConnections) {
+        drop_connection(c);
+    }
+    _deadConnections.clear();
 }
 
 Server::AccessControl::AccessControl(const std::string &keysFileName) :
@@ -270,6 +676,7 @@ void Server::AccessControl::refresh() {
             if (line.size() < 8) continue;
             keys.insert(line);
         }
+        std::unique_lock<std::mutex> lock(_mutex);
         _keys.swap(keys);
     } catch (std::exception& e) {
         LOG_ERROR() << STS << e.what();
@@ -278,6 +685,7 @@ void Server::AccessControl::refresh() {
 
 bool Server::AccessControl::check(const std::string& key) {
     if (!_enabled) return true;
+    std::unique_lock<std::mutex> lock(_mutex);
     return _keys.count(key) > 0;
 }
 
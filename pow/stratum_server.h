@@ -18,8 +18,11 @@
 #include "p2p/line_protocol.h"
 #include "utility/io/tcpserver.h"
 #include "utility/io/coarsetimer.h"
+#include "utility/io/asyncevent.h"
 #include <set>
 #include <map>
+#include <mutex>
+#include <thread>
 
 namespace beam { namespace stratum {
 
@@ -31,15 +34,17 @@ struct ConnectionToServer {
     virtual void on_bad_peer(uint64_t from) = 0;
 };
 
-class Server : public IExternalPOW, public ConnectionToServer {
+class Server : public IExternalPOW {
 public:
     Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address listenTo, unsigned noncePrefixDigits);
+    ~Server() override;
 
 private:
     class AccessControl {
     public:
         explicit AccessControl(const std::string& keysFileName);
 
+        // thread-safe
         bool check(const std::string& key);
 
         void refresh();
@@ -47,6 +52,7 @@ private:
         bool _enabled;
         std::string _keysFileName;
         time_t _lastModified;
+        std::mutex _mutex;
         std::set<std::string> _keys;
     };
 
@@ -81,17 +87,106 @@ private:
         bool _loggedIn;
     };
 
-    void start_server();
+    struct Worker;
 
-    void refresh_acl();
+    struct JobParams {
+        std::string id;
+        Merkle::Hash input;
+        Block::PoW pow;
+        Height height;
+        io::SerializedMsg msg; // serialized with the block difficulty
+    };
+
+    using JobPtr = std::shared_ptr<const JobParams>;
+
+    // Accepts and serves the connections on a single reactor: either the owner's one, or (if Options::threads is set)
+    // one per worker thread, all listening to the same port.
+    class Shard : public ConnectionToServer {
+    public:
+        Shard(Server& owner, io::Reactor& reactor, Worker* worker);
+
+        // sends the job to all the logged-in connections. The buffers are shared, not copied
+        void set_job(const JobPtr& job);
+
+        void send_result(uint64_t connId, const io::SerializedMsg& msg);
+
+        void stop_listening();
+
+    private:
+        void start_server();
+
+        void on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode);
+
+        bool on_login(uint64_t from, const Login& login) override;
+        bool on_solution(uint64_t from, const Solution& solution) override;
+        void on_bad_peer(uint64_t from) override;
+
+        // vardiff
+        struct Miner {
+            Difficulty target;
+            uint32_t windowStart_ms;
+            uint32_t windowShares;
+            uint32_t connected_ms;
+            double work;
+        };
+
+        // the job serialized with the given share difficulty, cached per job
+        const io::SerializedMsg& get_job_msg(Difficulty d);
+
+        bool on_share(uint64_t from, Miner& miner, const Solution& solution);
+        bool send_share_result(uint64_t from, const std::string& id, ResultCode code);
+        bool on_block_solution(uint64_t from, const Solution& solution);
+        bool retarget(uint64_t connId, Miner& miner, uint32_t now_ms);
+        void on_vardiff_timer();
+        void update_stats(uint64_t connId, const Miner& miner, ResultCode code);
+        void drop_connection(uint64_t connId);
+
+        Server& _owner;
+        io::Reactor& _reactor;
+        Worker* _worker; // null for the owner's reactor
+        io::MultipleTimers _timers;
+        io::SerializedMsg _currentMsg;
+        io::FragmentWriter _fw;
+        io::TcpServer::Ptr _server;
+        std::map<uint64_t, std::unique_ptr<Connection>> _connections;
+        std::map<uint64_t, Miner> _miners; // logged-in connections, if vardiff is on
+        JobPtr _job;
+        std::map<uint32_t, io::SerializedMsg> _jobMsgs; // share difficulty -> serialized _job
+        std::vector<uint64_t> _deadConnections;
+        bool _stopped;
+    };
+
+    // Thread with its own reactor and shard. The owner talks to it only via the fields guarded by _mutex, and the event.
+    struct Worker {
+        io::Reactor::Ptr _reactor;
+        std::unique_ptr<Shard> _shard;
+        io::AsyncEvent::Ptr _event;
+        std::thread _thread;
 
-    void on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode);
+        std::mutex _mutex;
+        JobPtr _job;
+        std::vector<std::pair<uint64_t, io::SerializedMsg> > _results;
+        bool _stopListening = false;
+        bool _shutdown = false;
+
+        void on_event();
+    };
+
+    struct PostedSolution {
+        Worker* worker;
+        uint64_t from;
+        Solution solution;
+    };
+
+    void refresh_acl();
 
     std::string gen_nonceprefix(uint64_t connId);
 
-    bool on_login(uint64_t from, const Login& login) override;
-    bool on_solution(uint64_t from, const Solution& solution) override;
-    void on_bad_peer(uint64_t from) override;
+    Result process_solution(const Solution& solution);
+
+    // from the worker threads
+    void post_solution(Worker& worker, uint64_t from, const Solution& solution);
+    void on_solutions_posted();
 
     void new_job(
         const std::string&,
@@ -104,21 +199,32 @@ private:
     void get_last_found_block(std::string& jobID, Height& jobHeight, Block::PoW& pow) override;
     void stop_current() override;
     void stop() override;
+    void get_worker_stats(std::vector<WorkerStats>& v) override;
+    void log_stats();
 
     Options _options;
     io::Reactor& _reactor;
     io::Address _bindAddress;
     io::MultipleTimers _timers;
+    io::SerializedMsg _currentMsg;
     io::FragmentWriter _fw;
-    io::TcpServer::Ptr _server;
-    std::map<uint64_t, std::unique_ptr<Connection>> _connections;
     AccessControl _acl;
 
+    std::unique_ptr<Shard> _shard; // when there're no workers
+    std::vector<std::unique_ptr<Worker> > _workers;
+
+    std::mutex _solutionsMutex;
+    std::vector<PostedSolution> _solutions;
+    io::AsyncEvent::Ptr _solutionsEvent;
+
 	struct RecentJob {
-		io::SerializedMsg msg;
+		JobPtr params;
 		std::string id;
 	} _recentJob;
 
+    std::mutex _statsMutex;
+    std::map<uint64_t, WorkerStats> _workerStats; // updated by the shards
+
 	struct RecentResult {
 		std::string id;
 		Height height;
@@ -126,8 +232,6 @@ private:
 		BlockFound onBlockFound;
 	} _recentResult;
 
-    io::SerializedMsg _currentMsg;
-    std::vector<uint64_t> _deadConnections;
     unsigned _prefixDigits; // nonceprefix hex digits, 0..6
     uint64_t _prefixSeed;
 };
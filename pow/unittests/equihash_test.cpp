@@ -1,119 +1,273 @@
-// Copyright 2018 The Beam Team
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-//    http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-
-#include "core/block_crypt.h"
-#include <iostream>
-#include "3rdparty/crypto/equihashR.h"
-#include "wallet/unittests/test_helpers.h"
-#include <algorithm>
-
-WALLET_TEST_INIT
-using namespace std;
-
-void TestArrayExpanding(size_t N, size_t K)
-{
-    cout << "Test array expanding: " << N << "," << K << "...\n";
-    size_t bitsLeft = N;
-    size_t collisionBits = N / (K + 1);
-    size_t collisionBytes = (collisionBits + 7) / 8;
-    size_t outBytes = sizeof(uint32_t);
-    size_t bytePad = outBytes - (collisionBits + 7) / 8;
-    size_t outputSize = (K + 1) * (collisionBytes + bytePad);
-    size_t inputSize = (N + 7) / 8;
-
-    vector<uint8_t> input(inputSize, 0);
-    for (size_t i = 0; i < inputSize - 1; ++i)
-    {
-        input[i] = 0xc0 + uint8_t(i);//0xff;
-        bitsLeft -= 8;
-    }
-    WALLET_CHECK(bitsLeft <= 8);
-    input[inputSize - 1] = 0xff << (8 - bitsLeft);
-    vector<uint8_t> output(outputSize, 0);
-    ExpandArray(input.data(), input.size(), output.data(), output.size(), collisionBits, bytePad);
-
-    for (size_t i = outBytes; i < output.size(); i += outBytes)
-    {
-   //     WALLET_CHECK(equal(&output[i], &output[i] + outBytes, &output[0]));
-    }
-
-    vector<uint8_t> temp(input.size(), 0);
-    CompressArray(output.data(), output.size(), &temp[0], input.size(), collisionBits, bytePad);
-    WALLET_CHECK(equal(temp.begin(), temp.end(), input.begin()));
-}
-
-void TestArrayExpanding()
-{
-    {
-        vector<uint8_t> output(8, 0);
-        vector<uint8_t> temp(7, 0);
-        vector<uint8_t> input = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc };
-        ExpandArray(input.data(), input.size(), output.data(), output.size(), 27, 0);
-        CompressArray(output.data(), output.size(), &temp[0], temp.size(), 27, 0);
-        WALLET_CHECK(temp[6] == 0xfc);
-    }
-    {
-        vector<uint8_t> output( 8, 0 );
-        vector<uint8_t> input = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 };
-        ExpandArray(input.data(), input.size(), output.data(), output.size(), 26, 0);
-    }
-    {
-        vector<uint8_t> output = {0x3, 0xff, 0xff, 0xff, 0x3, 0xff, 0xff, 0xff };
-        vector<uint8_t> temp(7, 0);
-        CompressArray(output.data(), output.size(), &temp[0], temp.size(), 26, 0);
-        WALLET_CHECK(temp[6] == 0xf0);
-    }
-    {
-        vector<uint8_t> output(8, 0);
-        vector<uint8_t> temp(7, 0);
-        vector<uint8_t> input = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc };
-        ExpandArray(input.data(), input.size(), output.data(), output.size(), 27, 0);
-        CompressArray(output.data(), output.size(), &temp[0], temp.size(), 27, 0);
-        WALLET_CHECK(temp[6] == 0xfc);
-    }
-    TestArrayExpanding(156, 5);
-    TestArrayExpanding(120, 5);
-    TestArrayExpanding(144, 5);
-    TestArrayExpanding(150, 5);
-    TestArrayExpanding(96, 5);
-}
-
-int main()
-{
-    TestArrayExpanding();
-    
-    // commented since it doesn't complete in 10 minutes and failes auto tests
-/*
-    {
-        cout << "Test PoW...\n";
-        uint8_t pInput[] = { 1, 2, 3, 4, 56 };
-
-        beam::Block::PoW pow;
-        pow.m_Difficulty = 0; // d=0, runtime ~48 sec. d=1,2 - almost close to this. d=4 - runtime 4 miuntes, several cycles until solution is achieved.
-        pow.m_Nonce = 0x010204U;
-
-        {
-            pow.Solve(pInput, sizeof(pInput));
-
-            WALLET_CHECK(pow.IsValid(pInput, sizeof(pInput)));
-        }
-
-        //#endif
-
-        std::cout << "Solution is correct\n";
-    }
-*/
-    assert(g_failureCount == 0);
-    return WALLET_CHECK_RESULT;
-}
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "core/block_crypt.h"
+#include <iostream>
+#include "3rdparty/crypto/equihashR.h"
+#include "3rdparty/crypto/beamHashIII.h"
+#include "wallet/unittests/test_helpers.h"
+#include "utility/test_helpers.h"
+#include "utility/hex.h"
+#include <algorithm>
+
+WALLET_TEST_INIT
+using namespace std;
+
+void TestArrayExpanding(size_t N, size_t K)
+{
+    cout << "Test array expanding: " << N << "," << K << "...\n";
+    size_t bitsLeft = N;
+    size_t collisionBits = N / (K + 1);
+    size_t collisionBytes = (collisionBits + 7) / 8;
+    size_t outBytes = sizeof(uint32_t);
+    size_t bytePad = outBytes - (collisionBits + 7) / 8;
+    size_t outputSize = (K + 1) * (collisionBytes + bytePad);
+    size_t inputSize = (N + 7) / 8;
+
+    vector<uint8_t> input(inputSize, 0);
+    for (size_t i = 0; i < inputSize - 1; ++i)
+    {
+        input[i] = 0xc0 + uint8_t(i);//0xff;
+        bitsLeft -= 8;
+    }
+    WALLET_CHECK(bitsLeft <= 8);
+    input[inputSize - 1] = 0xff << (8 - bitsLeft);
+    vector<uint8_t> output(outputSize, 0);
+    ExpandArray(input.data(), input.size(), output.data(), output.size(), collisionBits, bytePad);
+
+    for (size_t i = outBytes; i < output.size(); i += outBytes)
+    {
+   //     WALLET_CHECK(equal(&output[i], &output[i] + outBytes, &output[0]));
+    }
+
+    vector<uint8_t> temp(input.size(), 0);
+    CompressArray(output.data(), output.size(), &temp[0], input.size(), collisionBits, bytePad);
+    WALLET_CHECK(equal(temp.begin(), temp.end(), input.begin()));
+}
+
+void TestArrayExpanding()
+{
+    {
+        vector<uint8_t> output(8, 0);
+        vector<uint8_t> temp(7, 0);
+        vector<uint8_t> input = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc };
+        ExpandArray(input.data(), input.size(), output.data(), output.size(), 27, 0);
+        CompressArray(output.data(), output.size(), &temp[0], temp.size(), 27, 0);
+        WALLET_CHECK(temp[6] == 0xfc);
+    }
+    {
+        vector<uint8_t> output( 8, 0 );
+        vector<uint8_t> input = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 };
+        ExpandArray(input.data(), input.size(), output.data(), output.size(), 26, 0);
+    }
+    {
+        vector<uint8_t> output = {0x3, 0xff, 0xff, 0xff, 0x3, 0xff, 0xff, 0xff };
+        vector<uint8_t> temp(7, 0);
+        CompressArray(output.data(), output.size(), &temp[0], temp.size(), 26, 0);
+        WALLET_CHECK(temp[6] == 0xf0);
+    }
+    {
+        vector<uint8_t> output(8, 0);
+        vector<uint8_t> temp(7, 0);
+        vector<uint8_t> input = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc };
+        ExpandArray(input.data(), input.size(), output.data(), output.size(), 27, 0);
+        CompressArray(output.data(), output.size(), &temp[0], temp.size(), 27, 0);
+        WALLET_CHECK(temp[6] == 0xfc);
+    }
+    TestArrayExpanding(156, 5);
+    TestArrayExpanding(120, 5);
+    TestArrayExpanding(144, 5);
+    TestArrayExpanding(150, 5);
+    TestArrayExpanding(96, 5);
+}
+
+std::vector<uint32_t> GetIndicesFromMinimal(std::vector<uint8_t> soln);
+
+// The original stepElem based verification flow, used as a reference
+bool IsValidSolutionReference(const blake2b_state& base_state, const std::vector<uint8_t>& soln)
+{
+    if (soln.size() != 104)
+        return false;
+
+    uint64_t prePow[4];
+    blake2b_state state = base_state;
+    blake2b_update(&state, &soln[100], 4);
+    blake2b_final(&state, (uint8_t*) &prePow[0], static_cast<uint8_t>(32));
+
+    std::vector<stepElem> X;
+    for (uint32_t index : GetIndicesFromMinimal(soln))
+        X.emplace_back(&prePow[0], index);
+
+    for (uint32_t round = 1; X.size() > 1; round++)
+    {
+        std::vector<stepElem> Xtmp;
+        for (size_t i = 0; i < X.size(); i += 2)
+        {
+            uint32_t remLen = workBitSize - (round - 1) * collisionBitSize;
+            if (round == 5) remLen -= 64;
+
+            X[i].applyMix(remLen);
+            X[i + 1].applyMix(remLen);
+
+            if (!hasCollision(X[i], X[i + 1]) || !distinctIndices(X[i], X[i + 1]) || !indexAfter(X[i], X[i + 1]))
+                return false;
+
+            remLen = workBitSize - round * collisionBitSize;
+            if (round == 4) remLen -= 64;
+            if (round == 5) remLen = collisionBitSize;
+
+            Xtmp.emplace_back(X[i], X[i + 1], remLen);
+        }
+        X.swap(Xtmp);
+    }
+
+    return X[0].isZero();
+}
+
+struct BeamHashIIIVector
+{
+    blake2b_state m_State;
+    std::vector<uint8_t> m_Solution;
+
+    BeamHashIIIVector()
+    {
+        BeamHash_III bh;
+        bh.InitialiseState(m_State);
+
+        uint8_t pInput[32];
+        for (uint32_t i = 0; i < _countof(pInput); i++)
+            pInput[i] = static_cast<uint8_t>(i * 7 + 1);
+        blake2b_update(&m_State, pInput, sizeof(pInput));
+
+        m_Solution = beam::from_hex(
+            "8dbb16c052cfff71cc4b19bf1ba25507772af8cf19d05119afcf5b5f20d463a6"
+            "6b4ceb803d88d58dd5581cf5e6f758ced4c189d934fee5671edc669145081aef"
+            "1c45bbe09c1b12b1d29399e25c73aa652fc5707ccafff71bb52c4b7416342831"
+            "d699f1df00000000");
+    }
+};
+
+void TestBeamHashIII()
+{
+    cout << "Test BeamHash III verification...\n";
+
+    BeamHashIIIVector v;
+    BeamHash_III bh;
+
+    WALLET_CHECK(v.m_Solution.size() == 104);
+    WALLET_CHECK(IsValidSolutionReference(v.m_State, v.m_Solution));
+    WALLET_CHECK(bh.IsValidSolution(v.m_State, v.m_Solution));
+    WALLET_CHECK(BeamHash_III::IsValidSolution(v.m_State, &v.m_Solution.front(), v.m_Solution.size()));
+    WALLET_CHECK(!BeamHash_III::IsValidSolution(v.m_State, &v.m_Solution.front(), v.m_Solution.size() - 1));
+
+    auto fnCompare = [&](const std::vector<uint8_t>& sol)
+    {
+        bool bRef = IsValidSolutionReference(v.m_State, sol);
+        WALLET_CHECK(bRef == BeamHash_III::IsValidSolution(v.m_State, &sol.front(), sol.size()));
+        return bRef;
+    };
+
+    // every single-bit corruption is rejected by both
+    for (uint32_t iBit = 0; iBit < v.m_Solution.size() * 8; iBit++)
+    {
+        std::vector<uint8_t> sol = v.m_Solution;
+        sol[iBit >> 3] ^= static_cast<uint8_t>(1 << (iBit & 7));
+        WALLET_CHECK(!fnCompare(sol));
+    }
+
+    // swapped subtrees break the index order at every round
+    std::vector<uint32_t> indices = GetIndicesFromMinimal(v.m_Solution);
+    for (uint32_t treeSize = 1; treeSize < indices.size(); treeSize <<= 1)
+    {
+        std::vector<uint32_t> idx = indices;
+        std::swap_ranges(idx.begin(), idx.begin() + treeSize, idx.begin() + treeSize);
+
+        std::vector<uint8_t> sol(104, 0);
+        for (uint32_t i = 0; i < idx.size(); i++)
+            for (uint32_t iBit = 0; iBit < collisionBitSize + 1; iBit++)
+                if ((idx[i] >> iBit) & 1)
+                {
+                    uint32_t pos = i * (collisionBitSize + 1) + iBit;
+                    sol[pos >> 3] |= static_cast<uint8_t>(1 << (pos & 7));
+                }
+
+        WALLET_CHECK(!fnCompare(sol));
+    }
+
+    // random garbage
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        std::vector<uint8_t> sol(104);
+        for (auto& x : sol)
+            x = static_cast<uint8_t>(rand());
+        WALLET_CHECK(!fnCompare(sol));
+    }
+}
+
+void TestBeamHashIIIPerformance()
+{
+    cout << "BeamHash III verification throughput...\n";
+
+    BeamHashIIIVector v;
+    const uint32_t nCount = 2000;
+
+    beam::helpers::StopWatch sw;
+    uint32_t nValid = 0;
+
+    sw.start();
+    for (uint32_t i = 0; i < nCount; i++)
+        nValid += IsValidSolutionReference(v.m_State, v.m_Solution);
+    sw.stop();
+    cout << "\treference: " << nCount * 1000000ULL / std::max<uint64_t>(sw.microseconds(), 1) << " solutions/sec\n";
+    WALLET_CHECK(nValid == nCount);
+
+    nValid = 0;
+    sw.start();
+    for (uint32_t i = 0; i < nCount; i++)
+        nValid += BeamHash_III::IsValidSolution(v.m_State, &v.m_Solution.front(), v.m_Solution.size());
+    sw.stop();
+    cout << "\tfixed buffers: " << nCount * 1000000ULL / std::max<uint64_t>(sw.microseconds(), 1) << " solutions/sec\n";
+    WALLET_CHECK(nValid == nCount);
+}
+
+int main()
+{
+    TestArrayExpanding();
+    TestBeamHashIII();
+    TestBeamHashIIIPerformance();
+    
+    // commented since it doesn't complete in 10 minutes and failes auto tests
+/*
+    {
+        cout << "Test PoW...\n";
+        uint8_t pInput[] = { 1, 2, 3, 4, 56 };
+
+        beam::Block::PoW pow;
+        pow.m_Difficulty = 0; // d=0, runtime ~48 sec. d=1,2 - almost close to this. d=4 - runtime 4 miuntes, several cycles until solution is achieved.
+        pow.m_Nonce = 0x010204U;
+
+        {
+            pow.Solve(pInput, sizeof(pInput));
+
+            WALLET_CHECK(pow.IsValid(pInput, sizeof(pInput)));
+        }
+
+        //#endif
+
+        std::cout << "Solution is correct\n";
+    }
+*/
+    assert(g_failureCount == 0);
+    return WALLET_CHECK_RESULT;
+}
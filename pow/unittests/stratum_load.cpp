@@ -0,0 +1,280 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Stratum server load test: connects N simulated miners and measures how long it takes for a new job
+// to reach all of them.
+//
+// usage: stratum_load [clients=1000] [server threads=0] [jobs=20] [share interval=0]
+//
+// With the share interval (vardiff) on, each client also answers every job with a junk share, to load the
+// share validation.
+
+#include "pow/external_pow.h"
+#include "pow/stratum.h"
+#include "p2p/line_protocol.h"
+#include "utility/io/reactor.h"
+#include "utility/io/tcpstream.h"
+#include "utility/io/asyncevent.h"
+#include "utility/io/timer.h"
+#include "utility/logger.h"
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <map>
+
+using namespace beam;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+unsigned g_Clients = 1000;
+unsigned g_Threads = 0;
+unsigned g_Jobs = 20;
+unsigned g_ShareInterval = 0;
+
+const uint16_t PORT = 20100;
+
+struct JobStats {
+    Clock::time_point issued;
+    Clock::time_point first;
+    Clock::time_point last;
+    unsigned received = 0;
+};
+
+std::mutex g_StatsMutex;
+std::map<std::string, JobStats> g_Stats;
+
+io::AsyncEvent::Ptr g_JobDelivered; // posted by the clients' thread
+
+void on_job_received(const std::string& id) {
+    auto now = Clock::now();
+    bool done = false;
+    {
+        std::unique_lock<std::mutex> lock(g_StatsMutex);
+        JobStats& s = g_Stats[id];
+        if (!s.received++) {
+            s.first = now;
+        }
+        s.last = now;
+        done = (s.received == g_Clients);
+    }
+    if (done) {
+        g_JobDelivered->post();
+    }
+}
+
+class Client : public stratum::ParserCallback {
+public:
+    Client(io::TcpStream::Ptr&& stream) :
+        _stream(std::move(stream)),
+        _lineReader(
+            [this](void* data, size_t size) -> bool {
+                return stratum::parse_json_msg(data, size, *this);
+            }
+        )
+    {
+        _stream->enable_read(
+            [this](io::ErrorCode errorCode, void* data, size_t size) -> bool {
+                if (errorCode != 0) {
+                    LOG_ERROR() << "client: " << io::error_str(errorCode);
+                    return false;
+                }
+                return _lineReader.new_data_from_stream(data, size);
+            }
+        );
+
+        io::SerializedMsg msg;
+        io::FragmentWriter fw(1024, 0, [&msg](io::SharedBuffer&& buf) { msg.push_back(buf); });
+        stratum::append_json_msg(fw, stratum::Login("load-test"));
+        _stream->write(msg);
+    }
+
+private:
+    bool on_message(const stratum::Result& res) override {
+        if (res.id == "login" && res.code != stratum::no_error) {
+            LOG_ERROR() << "client: login failed";
+            return false;
+        }
+        return true;
+    }
+
+    bool on_message(const stratum::Job& job) override {
+        on_job_received(job.id);
+
+        if (g_ShareInterval) {
+            Block::PoW pow;
+            ECC::GenRandom(pow.m_Indices.data(), Block::PoW::nSolutionBytes);
+            ECC::GenRandom(pow.m_Nonce);
+
+            io::SerializedMsg msg;
+            io::FragmentWriter fw(1024, 0, [&msg](io::SharedBuffer&& buf) { msg.push_back(buf); });
+            stratum::append_json_msg(fw, stratum::Solution(job.id, pow));
+            _stream->write(msg);
+        }
+        return true;
+    }
+
+    io::TcpStream::Ptr _stream;
+    LineReader _lineReader;
+};
+
+void run_clients(const io::Reactor::Ptr& reactor) {
+    std::vector<std::unique_ptr<Client>> clients;
+    clients.reserve(g_Clients);
+
+    auto address = io::Address::localhost().port(PORT);
+    for (unsigned i = 0; i < g_Clients; i++) {
+        reactor->tcp_connect(
+            address,
+            i,
+            [&clients](uint64_t, io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
+                if (errorCode != 0) {
+                    LOG_ERROR() << "cannot connect: " << io::error_str(errorCode);
+                    return;
+                }
+                clients.push_back(std::make_unique<Client>(std::move(newStream)));
+            }
+        );
+    }
+
+    reactor->run();
+}
+
+Block::PoW g_Pow;
+Merkle::Hash g_Input;
+unsigned g_JobsIssued = 0;
+
+IExternalPOW::BlockFoundResult on_block_found() {
+    return IExternalPOW::solution_rejected;
+}
+
+void issue_job(IExternalPOW& server) {
+    std::string id = std::to_string(++g_JobsIssued);
+    ECC::GenRandom(&g_Input.m_pData, 32);
+    {
+        std::unique_lock<std::mutex> lock(g_StatsMutex);
+        g_Stats[id].issued = Clock::now();
+    }
+    server.new_job(id, g_Input, g_Pow, g_JobsIssued, &on_block_found, []() { return false; });
+}
+
+void print_stats(IExternalPOW& server) {
+    if (g_ShareInterval) {
+        std::vector<IExternalPOW::WorkerStats> v;
+        server.get_worker_stats(v);
+
+        uint64_t accepted = 0, rejected = 0, expired = 0;
+        for (const auto& x : v) {
+            accepted += x.sharesAccepted;
+            rejected += x.sharesRejected;
+            expired += x.sharesExpired;
+        }
+        LOG_INFO() << "miners=" << v.size() << " shares accepted=" << accepted << " rejected=" << rejected << " expired=" << expired;
+    }
+
+    std::unique_lock<std::mutex> lock(g_StatsMutex);
+
+    uint64_t sumFirst = 0, sumLast = 0, maxLast = 0;
+    unsigned n = 0;
+    for (const auto& x : g_Stats) {
+        const JobStats& s = x.second;
+        if (x.first == "1" || s.received != g_Clients) {
+            continue; // the 1st job is received by the clients on login
+        }
+        auto first = std::chrono::duration_cast<std::chrono::microseconds>(s.first - s.issued).count();
+        auto last = std::chrono::duration_cast<std::chrono::microseconds>(s.last - s.issued).count();
+        sumFirst += first;
+        sumLast += last;
+        if (maxLast < (uint64_t)last) {
+            maxLast = last;
+        }
+        ++n;
+    }
+
+    if (!n) {
+        LOG_ERROR() << "no jobs delivered";
+        return;
+    }
+
+    LOG_INFO()
+        << "clients=" << g_Clients << " threads=" << g_Threads << " jobs=" << n
+        << " first (avg)=" << sumFirst / n << "us"
+        << " all (avg)=" << sumLast / n << "us"
+        << " all (max)=" << maxLast << "us";
+}
+
+int run() {
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    io::Reactor::Scope scope(*reactor);
+
+    IExternalPOW::Options options;
+    options.threads = g_Threads;
+    options.shareInterval = g_ShareInterval;
+    std::unique_ptr<IExternalPOW> server = IExternalPOW::create(options, *reactor, io::Address().port(PORT), 0);
+
+    g_Pow.m_Difficulty = 0;
+
+    g_JobDelivered = io::AsyncEvent::create(*reactor, [&server, &reactor]() {
+        if (g_JobsIssued > g_Jobs) {
+            reactor->stop();
+        } else {
+            issue_job(*server);
+        }
+    });
+
+    issue_job(*server);
+
+    // let the server start listening
+    io::Timer::Ptr startTimer = io::Timer::create(*reactor);
+    io::Reactor::Ptr clientsReactor = io::Reactor::create();
+    std::thread clientsThread;
+    startTimer->start(500, false, [&]() {
+        clientsThread = std::thread(&run_clients, clientsReactor);
+    });
+
+    reactor->run();
+
+    print_stats(*server);
+
+    clientsReactor->stop();
+    if (clientsThread.joinable()) {
+        clientsThread.join();
+    }
+
+    g_JobDelivered.reset();
+    server.reset();
+    return 0;
+}
+
+} //namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) g_Clients = std::stoul(argv[1]);
+    if (argc > 2) g_Threads = std::stoul(argv[2]);
+    if (argc > 3) g_Jobs = std::stoul(argv[3]);
+    if (argc > 4) g_ShareInterval = std::stoul(argv[4]);
+
+    ECC::InitializeContext();
+    auto logger = Logger::create(LOG_LEVEL_INFO, LOG_LEVEL_INFO);
+
+    int retCode = 0;
+    try {
+        retCode = run();
+    } catch (const std::exception& e) {
+        LOG_ERROR() << "EXCEPTION: " << e.what();
+        retCode = 255;
+    }
+    return retCode;
+}
@@ -133,6 +133,8 @@ namespace beam
         const char* STRATUM_PORT = "stratum_port";
         const char* STRATUM_SECRETS_PATH = "stratum_secrets_path";
         const char* STRATUM_USE_TLS = "stratum_use_tls";
+        const char* STRATUM_THREADS = "stratum_threads";
+        const char* STRATUM_SHARE_INTERVAL = "stratum_share_interval";
         const char* STORAGE = "storage";
         const char* WALLET_STORAGE = "wallet_path";
         const char* MINING_THREADS = "mining_threads";
@@ -180,6 +182,7 @@ namespace beam
         const char* KEY_SUBKEY = "subkey";
         const char* KEY_OWNER = "key_owner";  // deprecated
         const char* OWNER_KEY = "owner_key";
+        const char* OWNER_KEYS_EXTRA = "owner_keys_extra";
         const char* KEY_MINE = "key_mine"; // deprecated
         const char* MINER_KEY = "miner_key";
         const char* BBS_ENABLE = "bbs_enable";
@@ -229,8 +232,12 @@ namespace beam
         const char* IP_WHITELIST = "ip_whitelist";
         const char* FAST_SYNC = "fast_sync";
         const char* GENERATE_RECOVERY_PATH = "generate_recovery";
+        const char* SNAPSHOT_EXPORT = "snapshot_export";
+        const char* SNAPSHOT_HEIGHT = "snapshot_height";
+        const char* SNAPSHOT_IMPORT = "snapshot_import";
         const char* RECOVERY_AUTO_PATH = "recovery_auto_path";
         const char* RECOVERY_AUTO_PERIOD = "recovery_auto_period";
+        const char* TX_POOL_SNAPSHOT = "tx_pool_snapshot";
         const char* SWAP_INIT = "swap_init";
         const char* SWAP_ACCEPT = "swap_accept";
         const char* SWAP_TOKEN = "swap_token";
@@ -389,6 +396,8 @@ namespace beam
             (cli::STRATUM_PORT, po::value<uint16_t>()->default_value(0), "port to start stratum server on")
             (cli::STRATUM_SECRETS_PATH, po::value<string>()->default_value("."), "path to stratum server api keys file, and tls certificate and private key")
             (cli::STRATUM_USE_TLS, po::value<bool>()->default_value(true), "enable TLS on startum server")
+            (cli::STRATUM_THREADS, po::value<unsigned>()->default_value(0), "number of threads serving stratum connections (0 - serve them on the main thread)")
+            (cli::STRATUM_SHARE_INTERVAL, po::value<unsigned>()->default_value(0), "desired seconds between shares of a stratum miner, the share difficulty is adjusted accordingly (0 - no shares, miners get the block difficulty)")
             (cli::RESET_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication). Must do if the node is cloned")
             (cli::ERASE_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication) and stop before re-creating the new one.")
             (cli::PRINT_TXO, po::value<bool>()->default_value(false), "Print TXO movements (create/spend) recognized by the owner key.")
@@ -400,14 +409,19 @@ namespace beam
             (cli::CRASH, po::value<int>()->default_value(0), "Induce crash (test proper handling)")
             (cli::OWNER_KEY, po::value<string>(), "Owner viewer key")
             (cli::KEY_OWNER, po::value<string>(), "Owner viewer key (deprecated)")
+            (cli::OWNER_KEYS_EXTRA, po::value<vector<string>>()->multitoken(), "Additional owner viewer keys, the node indexes events for each of them separately. Append only, don't reorder")
             (cli::MINER_KEY, po::value<string>(), "Standalone miner key")
             (cli::KEY_MINE, po::value<string>(), "Standalone miner key (deprecated)")
             (cli::PASS, po::value<string>(), "password for keys")
             (cli::LOG_UTXOS, po::value<bool>()->default_value(false), "Log recovered UTXOs (make sure the log file is not exposed)")
             (cli::FAST_SYNC, po::value<bool>(), "Fast sync on/off (override horizons)")
             (cli::GENERATE_RECOVERY_PATH, po::value<string>(), "Recovery file to generate immediately after start")
+            (cli::SNAPSHOT_EXPORT, po::value<string>(), "Export the node state snapshot (for the fast bootstrap) to the specified file and exit")
+            (cli::SNAPSHOT_HEIGHT, po::value<Height>()->default_value(0), "Height of the exported snapshot (0 = current tip)")
+            (cli::SNAPSHOT_IMPORT, po::value<string>(), "Bootstrap the node from the specified snapshot file. The node data must not exist")
             (cli::RECOVERY_AUTO_PATH, po::value<string>(), "path and file prefix for recovery auto-generation")
             (cli::RECOVERY_AUTO_PERIOD, po::value<uint32_t>()->default_value(30), "period (in blocks) for recovery auto-generation")
+            (cli::TX_POOL_SNAPSHOT, po::value<string>(), "tx pool snapshot file, saved periodically and on exit, loaded on start")
             ;
 
         po::options_description node_treasury_options("Node treasury options");
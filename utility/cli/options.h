@@ -31,6 +31,8 @@ namespace beam
         extern const char* STRATUM_PORT;
         extern const char* STRATUM_SECRETS_PATH;
         extern const char* STRATUM_USE_TLS;
+        extern const char* STRATUM_THREADS;
+        extern const char* STRATUM_SHARE_INTERVAL;
         extern const char* STORAGE;
         extern const char* WALLET_STORAGE;
         extern const char* MINING_THREADS;
@@ -80,6 +82,7 @@ namespace beam
         extern const char* KEY_SUBKEY;
         extern const char* KEY_OWNER;  // deprecated
         extern const char* OWNER_KEY;
+        extern const char* OWNER_KEYS_EXTRA;
         extern const char* KEY_MINE;  // deprecated
         extern const char* MINER_KEY;
         extern const char* BBS_ENABLE;
@@ -131,8 +134,12 @@ namespace beam
         extern const char* IP_WHITELIST;
         extern const char* FAST_SYNC;
         extern const char* GENERATE_RECOVERY_PATH;
+        extern const char* SNAPSHOT_EXPORT;
+        extern const char* SNAPSHOT_HEIGHT;
+        extern const char* SNAPSHOT_IMPORT;
         extern const char* RECOVERY_AUTO_PATH;
         extern const char* RECOVERY_AUTO_PERIOD;
+        extern const char* TX_POOL_SNAPSHOT;
         extern const char* SWAP_INIT;
         extern const char* SWAP_ACCEPT;
         extern const char* SWAP_TOKEN;
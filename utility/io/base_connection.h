@@ -35,6 +35,11 @@ public:
         return _stream->write(msg, flush);
     }
 
+    /// Sends the messages written with flush=false
+    io::Result flush() {
+        return _stream->flush();
+    }
+
     /// Shutdowns write side, waits for pending write requests to complete, but on reactor's side
     void shutdown()  {
         _stream->shutdown();
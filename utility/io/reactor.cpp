@@ -523,16 +523,34 @@ void Reactor::cancel_timer(Object* o) {
     }
 }
 
-ErrorCode Reactor::init_tcpserver(Object* o, Address bindAddress, uv_connection_cb cb) {
+ErrorCode Reactor::init_tcpserver(Object* o, Address bindAddress, uv_connection_cb cb, bool reusePort) {
     assert(o);
     assert(cb);
 
     uv_handle_t* h = _handlePool.alloc();
-    ErrorCode errorCode = (ErrorCode)uv_tcp_init(&_loop, (uv_tcp_t*)h);
+    // with reusePort the socket must be created before binding, to set the option
+    ErrorCode errorCode = (ErrorCode)(reusePort ? uv_tcp_init_ex(&_loop, (uv_tcp_t*)h, AF_INET) : uv_tcp_init(&_loop, (uv_tcp_t*)h));
     if (init_object(errorCode, o, h) != EC_OK) {
         return errorCode;
     }
 
+    if (reusePort) {
+#ifdef SO_REUSEPORT
+        uv_os_fd_t fd;
+        errorCode = (ErrorCode)uv_fileno(h, &fd);
+        if (errorCode != 0) {
+            return errorCode;
+        }
+
+        int on = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+            return (ErrorCode)uv_translate_sys_error(errno);
+        }
+#else // SO_REUSEPORT
+        return EC_ENOTSUP;
+#endif // SO_REUSEPORT
+    }
+
     sockaddr_in addr;
     bindAddress.fill_sockaddr_in(addr);
 
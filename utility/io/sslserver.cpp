@@ -21,7 +21,7 @@ namespace beam { namespace io {
 TcpServer::Ptr SslServer::create(
     Reactor& reactor, Address bindAddress, Callback&& callback,
     const char* certFileName, const char* privKeyFileName,
-    bool requestCertificate, bool rejectUnauthorized
+    bool requestCertificate, bool rejectUnauthorized, bool reusePort
 ) {
     assert(callback && certFileName && privKeyFileName);
 
@@ -30,11 +30,11 @@ TcpServer::Ptr SslServer::create(
 
     SSLContext::Ptr ctx = SSLContext::create_server_ctx(certFileName, privKeyFileName, requestCertificate, rejectUnauthorized);
 
-    return Ptr(new SslServer(std::move(callback), reactor, bindAddress, std::move(ctx)));
+    return Ptr(new SslServer(std::move(callback), reactor, bindAddress, std::move(ctx), reusePort));
 }
 
-SslServer::SslServer(Callback&& callback, Reactor& reactor, Address bindAddress, SSLContext::Ptr&& ctx) :
-    TcpServer(std::move(callback), reactor, bindAddress),
+SslServer::SslServer(Callback&& callback, Reactor& reactor, Address bindAddress, SSLContext::Ptr&& ctx, bool reusePort) :
+    TcpServer(std::move(callback), reactor, bindAddress, reusePort),
     _ctx(std::move(ctx))
 {}
 
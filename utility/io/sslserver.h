@@ -23,12 +23,12 @@ public:
     /// Creates the server and starts listening
     static Ptr create(Reactor& reactor, Address bindAddress, Callback&& callback,
                       const char* certFileName, const char* privKeyFileName,
-                      bool requestCertificate = false, bool rejectUnauthorized = false);
+                      bool requestCertificate = false, bool rejectUnauthorized = false, bool reusePort = false);
 
     ~SslServer() = default;
 
 private:
-    SslServer(Callback&& callback, Reactor& reactor, Address bindAddress, SSLContext::Ptr&& ctx);
+    SslServer(Callback&& callback, Reactor& reactor, Address bindAddress, SSLContext::Ptr&& ctx, bool reusePort);
 
     void on_accept(ErrorCode errorCode) override;
 
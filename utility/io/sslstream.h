@@ -29,6 +29,9 @@ public:
     /// Writes raw data, returns status code
     Result write(const SerializedMsg& fragments, bool flush=true) override;
 
+    /// Encrypts and sends the enqueued data
+    Result flush() override;
+
     /// Shutdowns write side, waits for pending write requests to complete, but on reactor's side
     void shutdown() override;
 
@@ -25,13 +25,14 @@ public:
     /// Either newStream is accepted or status != 0
     using Callback = std::function<void(TcpStream::Ptr&& newStream, ErrorCode status)>;
 
-    /// Creates the server and starts listening
-    static Ptr create(Reactor& reactor, Address bindAddress, Callback&& callback);
+    /// Creates the server and starts listening.
+    /// reusePort lets several servers (on different reactors) listen to the same port, the kernel balances the connections between them
+    static Ptr create(Reactor& reactor, Address bindAddress, Callback&& callback, bool reusePort=false);
 
     virtual ~TcpServer() = default;
 
 protected:
-    TcpServer(Callback&& callback, Reactor& reactor, Address bindAddress);
+    TcpServer(Callback&& callback, Reactor& reactor, Address bindAddress, bool reusePort);
 
     virtual void on_accept(ErrorCode errorCode);
 
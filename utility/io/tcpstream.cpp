@@ -104,6 +104,11 @@ Result TcpStream::write(const SerializedMsg& fragments, bool flush) {
     return do_write(flush);
 }
 
+Result TcpStream::flush() {
+    if (!is_connected()) return make_unexpected(EC_ENOTCONN);
+    return do_write(true);
+}
+
 /*
 Result TcpStream::write(const BufferChain& fragments, bool flush) {
     if (!is_connected()) return make_unexpected(EC_ENOTCONN);
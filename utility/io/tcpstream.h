@@ -62,6 +62,9 @@ public:
     /// Writes raw data, returns status code
     //virtual Result write(const BufferChain& fragments, bool flush=true);
 
+    /// Sends the data written with flush=false, returns status code
+    virtual Result flush();
+
     /// Shutdowns write side, waits for pending write requests to complete, but on reactor's side
     virtual void shutdown();
 
@@ -0,0 +1,232 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lz_codec.h"
+#include <string.h>
+#include <vector>
+
+namespace beam
+{
+    namespace
+    {
+        const size_t nMinMatch = 4;
+        const size_t nLastLiterals = 5; // the last bytes are always literals
+        const size_t nMatchLimit = 12; // last match must start before this
+        const size_t nMaxOffset = 0xffff;
+        const uint32_t nHashBits = 12;
+
+        uint32_t Read32(const uint8_t* p)
+        {
+            uint32_t x;
+            memcpy(&x, p, sizeof(x));
+            return x;
+        }
+
+        uint32_t Hash4(uint32_t x)
+        {
+            return (x * 2654435761U) >> (32 - nHashBits);
+        }
+
+        struct Writer
+        {
+            uint8_t* m_p;
+            size_t m_nRemaining;
+
+            bool Put(uint8_t x)
+            {
+                if (!m_nRemaining)
+                    return false;
+
+                *m_p++ = x;
+                m_nRemaining--;
+                return true;
+            }
+
+            bool Put(const uint8_t* p, size_t n)
+            {
+                if (m_nRemaining < n)
+                    return false;
+
+                memcpy(m_p, p, n);
+                m_p += n;
+                m_nRemaining -= n;
+                return true;
+            }
+
+            bool PutLen(size_t n) // extra length bytes, after the token nibble is saturated
+            {
+                for (; n >= 0xff; n -= 0xff)
+                    if (!Put(0xff))
+                        return false;
+
+                return Put(static_cast<uint8_t>(n));
+            }
+
+            // nMatch == 0 for the last (literals-only) sequence
+            bool PutSequence(const uint8_t* pLit, size_t nLit, size_t nOffset, size_t nMatch)
+            {
+                size_t nMatchCode = nMatch ? (nMatch - nMinMatch) : 0;
+
+                uint8_t nToken = static_cast<uint8_t>(((nLit < 0xf) ? nLit : 0xf) << 4);
+                nToken |= static_cast<uint8_t>((nMatchCode < 0xf) ? nMatchCode : 0xf);
+
+                if (!Put(nToken))
+                    return false;
+                if ((nLit >= 0xf) && !PutLen(nLit - 0xf))
+                    return false;
+                if (!Put(pLit, nLit))
+                    return false;
+
+                if (!nMatch)
+                    return true;
+
+                if (!Put(static_cast<uint8_t>(nOffset)) || !Put(static_cast<uint8_t>(nOffset >> 8)))
+                    return false;
+
+                return (nMatchCode < 0xf) || PutLen(nMatchCode - 0xf);
+            }
+        };
+
+        struct Reader
+        {
+            const uint8_t* m_p;
+            size_t m_nRemaining;
+
+            bool Get(uint8_t& x)
+            {
+                if (!m_nRemaining)
+                    return false;
+
+                x = *m_p++;
+                m_nRemaining--;
+                return true;
+            }
+
+            bool GetLen(size_t& n)
+            {
+                while (true)
+                {
+                    uint8_t x;
+                    if (!Get(x))
+                        return false;
+
+                    n += x;
+                    if (0xff != x)
+                        return true;
+                }
+            }
+        };
+    }
+
+    size_t LzCodec::Compress(uint8_t* pDst, size_t nDst, const uint8_t* pSrc, size_t nSrc)
+    {
+        Writer w;
+        w.m_p = pDst;
+        w.m_nRemaining = nDst;
+
+        size_t iAnchor = 0;
+
+        if (nSrc > nMatchLimit)
+        {
+            std::vector<uint32_t> vHash(1U << nHashBits, 0); // position + 1
+            const size_t iLimit = nSrc - nMatchLimit;
+            const size_t iMatchEnd = nSrc - nLastLiterals;
+
+            for (size_t i = 0; i <= iLimit; )
+            {
+                uint32_t x = Read32(pSrc + i);
+                uint32_t& nPos = vHash[Hash4(x)];
+
+                size_t iRef = nPos;
+                nPos = static_cast<uint32_t>(i + 1);
+
+                if (!iRef || (i - (--iRef) > nMaxOffset) || (Read32(pSrc + iRef) != x))
+                {
+                    i++;
+                    continue;
+                }
+
+                size_t iEnd = i + nMinMatch;
+                for (size_t j = iRef + nMinMatch; (iEnd < iMatchEnd) && (pSrc[iEnd] == pSrc[j]); j++)
+                    iEnd++;
+
+                if (!w.PutSequence(pSrc + iAnchor, i - iAnchor, i - iRef, iEnd - i))
+                    return 0;
+
+                i = iAnchor = iEnd;
+            }
+        }
+
+        if (!w.PutSequence(pSrc + iAnchor, nSrc - iAnchor, 0, 0))
+            return 0;
+
+        return nDst - w.m_nRemaining;
+    }
+
+    bool LzCodec::Decompress(uint8_t* pDst, size_t nDst, const uint8_t* pSrc, size_t nSrc)
+    {
+        Reader r;
+        r.m_p = pSrc;
+        r.m_nRemaining = nSrc;
+
+        size_t nDone = 0;
+
+        while (true)
+        {
+            uint8_t nToken;
+            if (!r.Get(nToken))
+                return false;
+
+            size_t nLit = nToken >> 4;
+            if ((0xf == nLit) && !r.GetLen(nLit))
+                return false;
+
+            if ((nLit > r.m_nRemaining) || (nLit > nDst - nDone))
+                return false;
+
+            memcpy(pDst + nDone, r.m_p, nLit);
+            nDone += nLit;
+            r.m_p += nLit;
+            r.m_nRemaining -= nLit;
+
+            if (!r.m_nRemaining)
+                break; // the last sequence
+
+            uint8_t pOffs[2];
+            if (!r.Get(pOffs[0]) || !r.Get(pOffs[1]))
+                return false;
+
+            size_t nOffset = pOffs[0] | (size_t(pOffs[1]) << 8);
+            if (!nOffset || (nOffset > nDone))
+                return false;
+
+            size_t nMatch = nToken & 0xf;
+            if ((0xf == nMatch) && !r.GetLen(nMatch))
+                return false;
+            nMatch += nMinMatch;
+
+            if (nMatch > nDst - nDone)
+                return false;
+
+            // may overlap, copy byte-by-byte
+            const uint8_t* pRef = pDst + nDone - nOffset;
+            for (size_t i = 0; i < nMatch; i++)
+                pDst[nDone + i] = pRef[i];
+
+            nDone += nMatch;
+        }
+
+        return nDone == nDst;
+    }
+}
@@ -0,0 +1,31 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+namespace beam
+{
+    // Fast byte-oriented LZ77 codec, the data layout is the LZ4 block format.
+    // Designed for speed rather than ratio: single hash probe, no entropy coding.
+    struct LzCodec
+    {
+        // Returns the compressed size, or 0 if the result doesn't fit nDst (i.e. not worth it)
+        static size_t Compress(uint8_t* pDst, size_t nDst, const uint8_t* pSrc, size_t nSrc);
+
+        // nDst must be the exact uncompressed size. Returns false if the data is malformed
+        static bool Decompress(uint8_t* pDst, size_t nDst, const uint8_t* pSrc, size_t nSrc);
+    };
+}
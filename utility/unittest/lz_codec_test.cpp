@@ -0,0 +1,113 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utility/lz_codec.h"
+#include <vector>
+#include <random>
+#include <iostream>
+#include <assert.h>
+
+using namespace beam;
+
+namespace {
+
+int g_TestsFailed = 0;
+
+void TestFailed(const char* szExpr, uint32_t nLine) {
+    std::cout << "Test failed! Line=" << nLine << ", Expression: " << szExpr << std::endl;
+    g_TestsFailed++;
+}
+
+#define verify_test(x) \
+    do { \
+        if (!(x)) \
+            TestFailed(#x, __LINE__); \
+    } while (false)
+
+void TestRoundtrip(const std::vector<uint8_t>& v, bool bCompressible) {
+    std::vector<uint8_t> vC(v.size() + v.size() / 255 + 16);
+    size_t n = LzCodec::Compress(vC.data(), vC.size(), v.data(), v.size());
+    verify_test(n);
+    if (bCompressible) {
+        verify_test(n < v.size() / 2);
+    }
+
+    std::vector<uint8_t> vD(v.size());
+    verify_test(LzCodec::Decompress(vD.data(), vD.size(), vC.data(), n));
+    verify_test(vD == v);
+
+    if (v.empty()) {
+        return;
+    }
+
+    // wrong size
+    std::vector<uint8_t> vD2(v.size() + 1);
+    verify_test(!LzCodec::Decompress(vD2.data(), v.size() - 1, vC.data(), n));
+    verify_test(!LzCodec::Decompress(vD2.data(), v.size() + 1, vC.data(), n));
+
+    // truncated
+    verify_test(!LzCodec::Decompress(vD.data(), vD.size(), vC.data(), n - 1));
+
+    // doesn't fit
+    if (bCompressible) {
+        verify_test(!LzCodec::Compress(vC.data(), n - 1, v.data(), v.size()));
+    }
+}
+
+void TestCodec() {
+    std::mt19937 rnd(17);
+
+    for (size_t n : { 0, 1, 5, 12, 13, 100, 70000 }) {
+        std::vector<uint8_t> v(n);
+        for (auto& x : v) {
+            x = static_cast<uint8_t>(rnd());
+        }
+        TestRoundtrip(v, false);
+    }
+
+    // zeroes, long overlapping matches
+    TestRoundtrip(std::vector<uint8_t>(100000, 0), true);
+
+    // repeated records with random fields, matches beyond 64K are not reachable
+    std::vector<uint8_t> v;
+    std::vector<uint8_t> vRec(100);
+    for (size_t i = 0; i < 3000; i++) {
+        for (size_t j = 0; j < 8; j++) {
+            vRec[j] = static_cast<uint8_t>(rnd());
+        }
+        v.insert(v.end(), vRec.begin(), vRec.end());
+    }
+    TestRoundtrip(v, true);
+
+    // malformed: bad offset
+    uint8_t pBad[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    uint8_t pOut[16];
+    verify_test(!LzCodec::Decompress(pOut, sizeof(pOut), pBad, sizeof(pBad)));
+
+    // random garbage must not crash
+    for (size_t i = 0; i < 1000; i++) {
+        uint8_t pIn[64];
+        for (auto& x : pIn) {
+            x = static_cast<uint8_t>(rnd());
+        }
+        LzCodec::Decompress(pOut, sizeof(pOut), pIn, 1 + (rnd() % sizeof(pIn)));
+    }
+}
+
+} // namespace
+
+int main() {
+    TestCodec();
+    return g_TestsFailed ? -1 : 0;
+}
@@ -19,6 +19,8 @@
 #include "wallet_api.h"
 #include "utility/test_helpers.h"
 
+#include <cinttypes>
+
 using namespace beam;
 using namespace std::placeholders;
 
@@ -49,6 +51,63 @@ namespace
         {"status_string", [] (const Coin& a, const Coin& b) { return a.getStatusString() < b.getStatusString();}}
     };
 
+    // sort fields that are served by an index in the wallet database, see IWalletDB::getCoinsPage
+    const std::map<std::string, CoinsPageFilter::SortField> utxoIndexedSortMap =
+    {
+        {"default", CoinsPageFilter::SortField::Default},
+        {"amount", CoinsPageFilter::SortField::Amount},
+        {"asset_id", CoinsPageFilter::SortField::AssetID},
+        {"type", CoinsPageFilter::SortField::Type}
+    };
+
+    // cursors are opaque for the API user, "<sort value>:<position>"
+    std::string CoinsCursorToString(const CoinsCursor& cursor)
+    {
+        return std::to_string(cursor.m_Value) + ":" + std::to_string(cursor.m_RowID);
+    }
+
+    boost::optional<CoinsCursor> CoinsCursorFromString(const std::string& str)
+    {
+        CoinsCursor cursor;
+        char tail = 0;
+        if (sscanf(str.c_str(), "%" SCNd64 ":%" SCNd64 "%c", &cursor.m_Value, &cursor.m_RowID, &tail) != 2)
+        {
+            return boost::none;
+        }
+        return cursor;
+    }
+
+    std::string TxListCursorToString(const TxListCursor& cursor)
+    {
+        return std::to_string(cursor.m_CreateTime) + ":" + TxIDToString(cursor.m_TxID);
+    }
+
+    boost::optional<TxListCursor> TxListCursorFromString(const std::string& str)
+    {
+        auto pos = str.find(':');
+        if (pos == std::string::npos)
+        {
+            return boost::none;
+        }
+
+        TxListCursor cursor;
+        char tail = 0;
+        if (sscanf(str.substr(0, pos).c_str(), "%" SCNu64 "%c", &cursor.m_CreateTime, &tail) != 1)
+        {
+            return boost::none;
+        }
+
+        bool isValid = false;
+        auto txid = from_hex(str.substr(pos + 1), &isValid);
+        if (!isValid || txid.size() != cursor.m_TxID.size())
+        {
+            return boost::none;
+        }
+
+        std::copy_n(txid.begin(), cursor.m_TxID.size(), cursor.m_TxID.begin());
+        return cursor;
+    }
+
     WalletAddress::ExpirationStatus MapExpirationStatus(AddressData::Expiration exp)
     {
         switch (exp)
@@ -631,6 +690,48 @@ namespace beam::wallet
 
         GetUtxo::Response response;
         response.confirmations_count = walletDB->getCoinConfirmationsOffset();
+
+        if (const auto it = utxoIndexedSortMap.find(data.sort.field); it != utxoIndexedSortMap.end())
+        {
+            // page is selected by the database, no need to load all the coins
+            CoinsPageFilter filter;
+            filter.m_SortField = it->second;
+            filter.m_Desc = data.sort.desc;
+            filter.m_WithAssets = data.withAssets;
+            filter.m_AssetID = data.filter.assetId;
+            filter.m_Skip = data.skip;
+            filter.m_Count = data.count;
+
+            if (data.cursor && !data.cursor->empty())
+            {
+                filter.m_After = CoinsCursorFromString(*data.cursor);
+                if (!filter.m_After)
+                {
+                    throw jsonrpc_exception(ApiError::InvalidParamsJsonRpc, "Invalid 'cursor' parameter.");
+                }
+            }
+
+            CoinsCursor last;
+            // zero count and non-asset filter by asset id give an empty page, keep it as it was
+            if (data.count && !(data.filter.assetId && *data.filter.assetId == Asset::s_InvalidID))
+            {
+                response.utxos = walletDB->getCoinsPage(filter, last);
+            }
+
+            if (data.cursor)
+            {
+                response.nextCursor = response.utxos.size() == data.count ? CoinsCursorToString(last) : std::string();
+            }
+
+            doResponse(id, response);
+            return;
+        }
+
+        if (data.cursor)
+        {
+            throw jsonrpc_exception(ApiError::InvalidParamsJsonRpc, "Cursor is not supported when sorting by \"" + data.sort.field + "\" field");
+        }
+
         walletDB->visitCoins([&response, &data](const Coin& c)->bool {
             if(!data.withAssets && c.isAsset())
             {
@@ -644,21 +745,14 @@ namespace beam::wallet
             return true;
         });
 
-        if (data.sort.field != "default")
+        if (const auto& it = utxoSortMap.find(data.sort.field); it != utxoSortMap.end())
         {
-            if (const auto& it = utxoSortMap.find(data.sort.field); it != utxoSortMap.end())
-            {
-                std::sort(response.utxos.begin(), response.utxos.end(),
-                        data.sort.desc ? std::bind(it->second, _2, _1) : it->second);
-            }
-            else
-            {
-                throw jsonrpc_exception(ApiError::InvalidParamsJsonRpc, "Can't sort by \"" + data.sort.field + "\" field");
-            }
+            std::sort(response.utxos.begin(), response.utxos.end(),
+                    data.sort.desc ? std::bind(it->second, _2, _1) : it->second);
         }
-        else if (data.sort.desc)
+        else
         {
-            std::reverse(response.utxos.begin(), response.utxos.end());
+            throw jsonrpc_exception(ApiError::InvalidParamsJsonRpc, "Can't sort by \"" + data.sort.field + "\" field");
         }
 
         doPagination(data.skip, data.count, response.utxos);
@@ -745,8 +839,6 @@ namespace beam::wallet
             Block::SystemState::ID stateID = {};
             walletDB->getSystemStateID(stateID);
             res.resultList.reserve(data.count);
-            uint32_t offset = 0;
-            uint32_t counter = 0;
 
             TxListFilter filter;
             filter.m_AssetID = data.filter.assetId;
@@ -756,44 +848,55 @@ namespace beam::wallet
                 filter.m_AssetConfirmedHeight = data.filter.height;
             }
             filter.m_KernelProofHeight = data.filter.height;
-            walletDB->visitTx(
-                [&](const TxDescription& tx)
+
+            // filter supported tx types
+            // TODO: remove this in future, this condition was added to preserve existing behavior
+            filter.m_TxTypes = { TxType::Simple, TxType::PushTransaction };
+            if (data.withAssets)
             {
-                // filter supported tx types
-                // TODO: remove this in future, this condition was added to preserve existing behavior
-                if (tx.m_txType != TxType::Simple
-                    && tx.m_txType != TxType::PushTransaction
-                    && tx.m_txType != TxType::AssetIssue
-                    && tx.m_txType != TxType::AssetConsume
-                    && tx.m_txType != TxType::AssetInfo)
-                {
-                    return true;
-                }
+                filter.m_TxTypes.push_back(TxType::AssetIssue);
+                filter.m_TxTypes.push_back(TxType::AssetConsume);
+                filter.m_TxTypes.push_back(TxType::AssetInfo);
+            }
+            else
+            {
+                filter.m_NoAssets = true;
+            }
 
-                if (!data.withAssets && (tx.m_txType == TxType::AssetIssue
-                    || tx.m_txType == TxType::AssetConsume
-                    || tx.m_txType == TxType::AssetInfo
-                    || tx.m_assetId != Asset::s_InvalidID))
+            // skipped rows are not loaded, with cursor they are not even visited
+            filter.m_Skip = data.skip;
+            filter.m_Count = data.count;
+            if (data.cursor && !data.cursor->empty())
+            {
+                filter.m_After = TxListCursorFromString(*data.cursor);
+                if (!filter.m_After)
                 {
-                    return true;
+                    throw jsonrpc_exception(ApiError::InvalidParamsJsonRpc, "Invalid 'cursor' parameter.");
                 }
+            }
 
-                ++offset;
-                if (offset <= data.skip)
-                {
-                    return true;
-                }
+            walletDB->visitTx(
+                [&](const TxDescription& tx)
+            {
                 const auto height = storage::DeduceTxProofHeight(*walletDB, tx);
                 Status::Response& item = res.resultList.emplace_back();
                 item.tx = tx;
                 item.txHeight = height;
                 item.systemHeight = stateID.m_Height;
                 item.confirmations = 0;
-
-                ++counter;
-                return data.count == 0 || counter < data.count;
+                return true;
             }, filter);
             assert(data.count == 0 || (uint32_t)res.resultList.size() <= data.count);
+
+            if (data.cursor)
+            {
+                res.nextCursor = std::string();
+                if (data.count && res.resultList.size() == data.count)
+                {
+                    const auto& tx = res.resultList.back().tx;
+                    res.nextCursor = TxListCursorToString(TxListCursor{ tx.m_createTime, tx.m_txId });
+                }
+            }
         }
         
         doResponse(id, res);
@@ -598,6 +598,8 @@ namespace beam::wallet {
             getUtxo.skip = *skip;
         }
 
+        getUtxo.cursor = getOptionalParam<std::string>(params, "cursor");
+
         if (hasParam(params, "sort"))
         {
             if (hasParam(params["sort"], "field") && params["sort"]["field"].is_string())
@@ -668,6 +670,8 @@ namespace beam::wallet {
             txList.skip = *skip;
         }
 
+        txList.cursor = getOptionalParam<std::string>(params, "cursor");
+
         onMessage(id, txList);
     }
 
@@ -1227,12 +1231,23 @@ namespace beam::wallet {
             {"result", json::array()}
         };
 
+        if (res.nextCursor)
+        {
+            msg["result"] = json
+            {
+                {"items", json::array()},
+                {"next_cursor", *res.nextCursor}
+            };
+        }
+
+        auto& items = res.nextCursor ? msg["result"]["items"] : msg["result"];
+
         for (auto& utxo : res.utxos)
         {
             std::string createTxId = utxo.m_createTxId.is_initialized() ? TxIDToString(*utxo.m_createTxId) : "";
             std::string spentTxId = utxo.m_spentTxId.is_initialized() ? TxIDToString(*utxo.m_spentTxId) : "";
 
-            msg["result"].push_back(
+            items.push_back(
             {
                 {"id", utxo.toStringID()},
                 {"asset_id", utxo.m_ID.m_AssetID},
@@ -1415,6 +1430,17 @@ namespace beam::wallet {
             {"result", json::array()}
         };
 
+        if (res.nextCursor)
+        {
+            msg["result"] = json
+            {
+                {"items", json::array()},
+                {"next_cursor", *res.nextCursor}
+            };
+        }
+
+        auto& items = res.nextCursor ? msg["result"]["items"] : msg["result"];
+
         for (const auto& resItem : res.resultList)
         {
             json item = {};
@@ -1424,7 +1450,7 @@ namespace beam::wallet {
                 resItem.txHeight,
                 resItem.systemHeight,
                 true);
-            msg["result"].push_back(item);
+            items.push_back(item);
         }
     }
 
@@ -379,10 +379,13 @@ namespace beam::wallet
             bool desc = false;
         } sort;
 
+        boost::optional<std::string> cursor; // keyset pagination, empty string requests the first page
+
         struct Response
         {
             std::vector<Coin> utxos;
             uint32_t confirmations_count = 0;
+            boost::optional<std::string> nextCursor;
         };
     };
 
@@ -420,10 +423,12 @@ namespace beam::wallet
 
         uint32_t count = 0;
         uint32_t skip = 0;
+        boost::optional<std::string> cursor; // keyset pagination, empty string requests the first page
 
         struct Response
         {
             std::vector<Status::Response> resultList;
+            boost::optional<std::string> nextCursor;
         };
     };
 
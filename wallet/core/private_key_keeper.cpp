@@ -68,8 +68,39 @@ namespace beam::wallet
 	}
 
 	KEY_KEEPER_METHODS(THE_MACRO)
+	THE_MACRO(CreateOutputs)
 #undef THE_MACRO
 
+	void IPrivateKeyKeeper2::InvokeAsync(Method::CreateOutputs& m, const Handler::Ptr& pHandler)
+	{
+		struct MyHandler
+			:public Handler
+		{
+			Handler::Ptr m_pNext;
+			size_t m_nPending;
+			Status::Type m_Status = Status::Success;
+
+			virtual void OnDone(Status::Type n) override
+			{
+				if (Status::Success == m_Status)
+					m_Status = n; // report the 1st error
+
+				assert(m_nPending);
+				if (!--m_nPending)
+					m_pNext->OnDone(m_Status);
+			}
+		};
+
+		assert(!m.m_vOutputs.empty());
+
+		auto p = std::make_shared<MyHandler>();
+		p->m_pNext = pHandler;
+		p->m_nPending = m.m_vOutputs.size();
+
+		for (auto& x : m.m_vOutputs)
+			InvokeAsync(x, p);
+	}
+
 	////////////////////////////////
 	// misc
 	IPrivateKeyKeeper2::Status::Type IPrivateKeyKeeper2::get_Commitment(ECC::Point::Native& res, const CoinID& cid)
@@ -182,6 +213,7 @@ namespace beam::wallet
 	}
 
 	KEY_KEEPER_METHODS(THE_MACRO)
+	THE_MACRO(CreateOutputs)
 #undef THE_MACRO
 
 	////////////////////////////////
@@ -190,8 +222,63 @@ namespace beam::wallet
 	{
 		std::unique_lock<std::mutex> scope(m_MutexIn);
 
-		if (m_queIn.Push(p))
-			m_NewIn.notify_one();
+		Task& t = Cast::Up<Task>(*p);
+		t.m_Seq = m_SeqIn++;
+
+		m_queIn.Push(p);
+		m_NewIn.notify_one();
+	}
+
+	bool ThreadedPrivateKeyKeeper::PopIn(Task::Ptr& pRes)
+	{
+		// the oldest task, skipping those that use slots while another such a task is in progress
+		for (TaskList::iterator it = m_queIn.begin(); m_queIn.end() != it; it++)
+		{
+			Task& t = Cast::Up<Task>(*it);
+			if (t.m_SlotBound)
+			{
+				if (m_SlotBusy)
+					continue;
+				m_SlotBusy = true;
+			}
+
+			m_queIn.erase(it);
+			pRes.reset(&t);
+			return true;
+		}
+
+		return false;
+	}
+
+	void ThreadedPrivateKeyKeeper::OnExecuted(Task::Ptr& pTask)
+	{
+		std::unique_lock<std::mutex> scope(m_MutexIn);
+
+		Task& t = Cast::Up<Task>(*pTask);
+		if (t.m_SlotBound)
+		{
+			assert(m_SlotBusy);
+			m_SlotBusy = false;
+			m_NewIn.notify_all();
+		}
+
+		if (t.m_Seq != m_SeqOut)
+		{
+			m_mapDone[t.m_Seq] = std::move(pTask);
+			return;
+		}
+
+		PushOut(pTask);
+
+		while (++m_SeqOut, !m_mapDone.empty())
+		{
+			auto it = m_mapDone.begin();
+			if (it->first != m_SeqOut)
+				break;
+
+			PushOut(it->second);
+			m_mapDone.erase(it);
+		}
 	}
 
 	void ThreadedPrivateKeyKeeper::Thread(const Rules& r)
@@ -209,11 +296,8 @@ namespace beam::wallet
 					if (!m_Run)
 						return;
 
-					if (!m_queIn.empty())
-					{
-						m_queIn.Pop(pTask);
+					if (PopIn(pTask))
 						break;
-					}
 
 					m_NewIn.wait(scope);
 				}
@@ -222,28 +306,31 @@ namespace beam::wallet
 			assert(pTask);
 			Cast::Up<Task>(*pTask).Exec(*m_pKeyKeeper);
 
-			PushOut(pTask);
+			OnExecuted(pTask);
 		}
 	}
 
-	ThreadedPrivateKeyKeeper::ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p)
+	ThreadedPrivateKeyKeeper::ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p, uint32_t nThreads)
 		:m_pKeyKeeper(p)
 	{
 		EnsureEvtOut();
-		m_Thread = std::thread(&ThreadedPrivateKeyKeeper::Thread, this, Rules::get());
+
+		m_vThreads.resize(std::max(nThreads, 1U));
+		for (auto& t : m_vThreads)
+			t = std::thread(&ThreadedPrivateKeyKeeper::Thread, this, Rules::get());
 	}
 
 	ThreadedPrivateKeyKeeper::~ThreadedPrivateKeyKeeper()
 	{
-		if (m_Thread.joinable())
 		{
-			{
-				std::unique_lock<std::mutex> scope(m_MutexIn);
-				m_Run = false;
-				m_NewIn.notify_one();
-			}
-			m_Thread.join();
+			std::unique_lock<std::mutex> scope(m_MutexIn);
+			m_Run = false;
+			m_NewIn.notify_all();
 		}
+
+		for (auto& t : m_vThreads)
+			if (t.joinable())
+				t.join();
 	}
 
 	template <typename TMethod>
@@ -257,6 +344,7 @@ namespace beam::wallet
 		Task::Ptr pTask(new MyTask);
 		pTask->m_pHandler = pHandler;
 		Cast::Up<MyTask>(*pTask).m_pM = &m;
+		Cast::Up<MyTask>(*pTask).m_SlotBound = std::is_same<TMethod, Method::SignSender>::value;
 
 		PushIn(pTask);
 	}
@@ -93,6 +93,10 @@ namespace beam::wallet
                 CreateOutput() { ZeroObject(m_User); }
             };
 
+            struct CreateOutputs {
+                std::vector<CreateOutput> m_vOutputs; // independent, each gets its own result
+            };
+
             struct CreateInputShielded
                 :public ShieldedTxo::ID
             {
@@ -183,6 +187,11 @@ namespace beam::wallet
         KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+        // Batch of outputs. By default implemented via CreateOutput for each element, completes once all of them are done.
+        // Implementations may override it to build the outputs concurrently. Must not be empty
+        virtual Status::Type InvokeSync(Method::CreateOutputs&);
+        virtual void InvokeAsync(Method::CreateOutputs&, const Handler::Ptr&);
+
         virtual ~IPrivateKeyKeeper2() {}
 
         // synthetic functions (in terms of underlying ones)
@@ -250,16 +259,21 @@ namespace beam::wallet
 		void InvokeAsync(Method::method& m, const Handler::Ptr& pHandler) override;
 
 		KEY_KEEPER_METHODS(THE_MACRO)
+		THE_MACRO(CreateOutputs)
 #undef THE_MACRO
 
 	};
 
+	// Runs the methods of the underlying key keeper on a pool of worker threads.
+	// With more than 1 thread the underlying key keeper must tolerate concurrent invocation of the methods that don't use nonce slots.
+	// The methods that use slots are executed one at a time, in the order of invocation.
+	// Completion is always reported in the order of invocation, as with a single thread.
 	class ThreadedPrivateKeyKeeper
 		:public PrivateKeyKeeper_WithMarshaller
 	{
         IPrivateKeyKeeper2::Ptr m_pKeyKeeper;
 
-		std::thread m_Thread;
+		std::vector<std::thread> m_vThreads;
 		bool m_Run = true;
 
 		std::mutex m_MutexIn;
@@ -268,17 +282,26 @@ namespace beam::wallet
         struct Task
             :public TaskFin
         {
+            uint64_t m_Seq;
+            bool m_SlotBound;
             virtual void Exec(IPrivateKeyKeeper2&) = 0;
         };
 
 		TaskList m_queIn;
 
+		uint64_t m_SeqIn = 0;
+		uint64_t m_SeqOut = 0;
+		std::map<uint64_t, Task::Ptr> m_mapDone; // completed out of order
+		bool m_SlotBusy = false;
+
         void PushIn(Task::Ptr& p);
+        bool PopIn(Task::Ptr& p);
+        void OnExecuted(Task::Ptr& p);
         void Thread(const Rules&);
 
     public:
 
-        ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p);
+        ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p, uint32_t nThreads = 1);
         ~ThreadedPrivateKeyKeeper();
 
 		template <typename TMethod>
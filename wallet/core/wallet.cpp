@@ -65,6 +65,17 @@ namespace beam::wallet
             }
             return txChanged;
         }
+
+        void DeserializeBody(const proto::BodyBuffers& b, Block::Body& block)
+        {
+            Deserializer der;
+            der.reset(b.m_Perishable);
+            der& Cast::Down<Block::BodyBase>(block);
+            der& Cast::Down<TxVectors::Perishable>(block);
+
+            der.reset(b.m_Eternal);
+            der& Cast::Down<TxVectors::Eternal>(block);
+        }
     }
 
     // @param SBBS address as string
@@ -1191,7 +1202,7 @@ namespace beam::wallet
         {
         }
 
-        void InsertEvent(Height h, const Blob& b, const Blob& k) override
+        void InsertEvent(Height h, const Blob& b, const Blob& k, uint32_t iOwner) override
         {
             m_Wallet.m_WalletDB->insertEvent(h, b, k);
         }
@@ -1255,7 +1266,7 @@ namespace beam::wallet
                 body.n -= sizeof(NodeDB::EventIndexType);
                 ((const uint8_t*&) body.p) += sizeof(NodeDB::EventIndexType);
 
-                if (!handler.OnEvent(h, body))
+                if (!handler.OnEvent(h, body, 0))
                     return true; // continue
 
                 bFound = true;
@@ -1277,9 +1288,19 @@ namespace beam::wallet
             {
                 RequestBodies(r.m_Msg.m_Height0, startHeight + r.m_Res.m_Bodies.size());
             }
-            for (const auto& b : r.m_Res.m_Bodies)
+
+            if (!m_pBodiesExecutor)
             {
-                ProcessBody(b, startHeight, recognizer);
+                m_pBodiesExecutor = std::make_unique<ExecutorMT_R>();
+            }
+
+            // bodies are decoded in parallel, and only then recognized in height order (bodies after a corrupted one are dropped)
+            std::vector<Block::Body> blocks;
+            DecodeBodies(r.m_Res.m_Bodies, startHeight, h.m_pOwner.get(), blocks, *m_pBodiesExecutor);
+
+            for (auto& block : blocks)
+            {
+                ProcessBlock(block, startHeight, recognizer);
 
                 ++startHeight;
             }
@@ -1293,6 +1314,123 @@ namespace beam::wallet
         }
     }
 
+    size_t Wallet::DecodeBodies(const std::vector<proto::BodyBuffers>& bodies, Height h0, Key::IPKdf* pOwner, std::vector<Block::Body>& blocks, Executor& executor)
+    {
+        blocks.clear();
+        blocks.resize(bodies.size());
+
+        std::vector<uint8_t> vDecoded(bodies.size(), 0);
+
+        struct DeserializeTask
+            :public Executor::TaskSync
+        {
+            const std::vector<proto::BodyBuffers>& m_Bodies;
+            std::vector<Block::Body>& m_Blocks;
+            std::vector<uint8_t>& m_Decoded;
+
+            DeserializeTask(const std::vector<proto::BodyBuffers>& bodies, std::vector<Block::Body>& blocks, std::vector<uint8_t>& vDecoded)
+                : m_Bodies(bodies)
+                , m_Blocks(blocks)
+                , m_Decoded(vDecoded)
+            {
+            }
+
+            void Exec(Executor::Context& ctx) override
+            {
+                uint32_t i0, nCount;
+                ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_Bodies.size()));
+
+                for (uint32_t i = i0; i < i0 + nCount; i++)
+                {
+                    try
+                    {
+                        DeserializeBody(m_Bodies[i], m_Blocks[i]);
+                        m_Decoded[i] = 1;
+                    }
+                    catch (const std::exception&)
+                    {
+                    }
+                }
+            }
+        } taskDeserialize(bodies, blocks, vDecoded);
+
+        executor.ExecAll(taskDeserialize);
+
+        size_t nDecoded = 0;
+        while ((nDecoded < vDecoded.size()) && vDecoded[nDecoded])
+            nDecoded++;
+
+        blocks.resize(nDecoded);
+
+        if (!pOwner)
+            return nDecoded;
+
+        // flatten all the outputs, so that the load is split evenly regardless of the block sizes
+        struct OutputRef
+        {
+            Block::Body* m_pBlock;
+            Height m_Height;
+            uint32_t m_Idx;
+            bool m_IsMine;
+        };
+        std::vector<OutputRef> vOuts;
+
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            for (uint32_t j = 0; j < blocks[i].m_vOutputs.size(); j++)
+            {
+                vOuts.push_back({ &blocks[i], h0 + i, j, false });
+            }
+        }
+
+        struct RecoverTask
+            :public Executor::TaskSync
+        {
+            std::vector<OutputRef>& m_Outs;
+            Key::IPKdf& m_Owner;
+
+            RecoverTask(std::vector<OutputRef>& vOuts, Key::IPKdf& owner)
+                : m_Outs(vOuts)
+                , m_Owner(owner)
+            {
+            }
+
+            void Exec(Executor::Context& ctx) override
+            {
+                uint32_t i0, nCount;
+                ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_Outs.size()));
+
+                for (uint32_t i = i0; i < i0 + nCount; i++)
+                {
+                    auto& ref = m_Outs[i];
+
+                    CoinID cid;
+                    ref.m_IsMine = ref.m_pBlock->m_vOutputs[ref.m_Idx]->Recover(ref.m_Height, m_Owner, cid);
+                }
+            }
+        } taskRecover(vOuts, *pOwner);
+
+        executor.ExecAll(taskRecover);
+
+        // leave only recognized outputs, they'll be recovered once more on recognition, which is cheap for a few of them
+        size_t iOut = 0;
+        for (auto& block : blocks)
+        {
+            auto& outputs = block.m_vOutputs;
+            size_t nKeep = 0;
+            for (size_t j = 0; j < outputs.size(); j++, iOut++)
+            {
+                if (vOuts[iOut].m_IsMine)
+                {
+                    outputs[nKeep++] = std::move(outputs[j]);
+                }
+            }
+            outputs.resize(nKeep);
+        }
+
+        return nDecoded;
+    }
+
     void Wallet::OnRequestComplete(MyRequestBody& r)
     {
         RecognizerHandler h(*this, m_WalletDB->get_MasterKdf());
@@ -1336,13 +1474,12 @@ namespace beam::wallet
     void Wallet::ProcessBody(const proto::BodyBuffers& b, Height h, NodeProcessor::Recognizer& recognizer)
     {
         Block::Body block;
-        Deserializer der;
-        der.reset(b.m_Perishable);
-        der& Cast::Down<Block::BodyBase>(block);
-        der& Cast::Down<TxVectors::Perishable>(block);
+        DeserializeBody(b, block);
+        ProcessBlock(block, h, recognizer);
+    }
 
-        der.reset(b.m_Eternal);
-        der& Cast::Down<TxVectors::Eternal>(block);
+    void Wallet::ProcessBlock(Block::Body& block, Height h, NodeProcessor::Recognizer& recognizer)
+    {
         PreprocessBlock(block);
         recognizer.Recognize(block, h, 0, false);
         SetEventsHeight(h);
@@ -1517,11 +1654,13 @@ namespace beam::wallet
             :public proto::Event::IGroupParser
         {
             Wallet& m_This;
+            ActiveInputs m_ActiveInputs;
+            std::vector<UtxoEvent> m_vUtxo; // processed in bulk after parsing
             MyParser(Wallet& x) :m_This(x) {}
 
             virtual void OnEventType(proto::Event::Shielded& evt) override
             {
-                m_This.ProcessEventShieldedUtxo(evt, m_Height);
+                m_This.ProcessEventShieldedUtxo(evt, m_Height, m_ActiveInputs);
             }
 
             virtual void OnEventType(proto::Event::AssetCtl& evt) override
@@ -1531,12 +1670,17 @@ namespace beam::wallet
 
             virtual void OnEventType(proto::Event::Utxo& evt) override
             {
-                m_This.ProcessEventUtxo(evt, m_Height);
+                m_vUtxo.emplace_back();
+                if (!m_This.FilterEventUtxo(evt, m_Height, m_vUtxo.back()))
+                    m_vUtxo.pop_back();
             }
 
         } p(*this);
 
+        get_ActiveInputs(p.m_ActiveInputs);
+
         uint32_t nCount = p.Proceed(r.m_Res.m_Events);
+        ProcessEventsUtxo(p.m_vUtxo, p.m_ActiveInputs);
 
         if (nCount < r.m_Max)
         {
@@ -1564,61 +1708,159 @@ namespace beam::wallet
         return storage::getNextEventHeight(*m_WalletDB);
     }
 
-    void Wallet::ProcessEventUtxo(const proto::Event::Utxo& evt, Height h)
+    void Wallet::get_ActiveInputs(ActiveInputs& ai) const
+    {
+        for (const auto& [txid, txptr] : m_ActiveTransactions)
+        {
+            std::vector<Coin::ID> icoins;
+            if (txptr->GetParameter(TxParameterID::InputCoins, icoins))
+            {
+                for (const auto& cid : icoins)
+                {
+                    ECC::Hash::Value hv;
+                    cid.get_Hash(hv);
+                    ai.m_Coins[hv] = txid;
+                }
+            }
+
+            std::vector<IPrivateKeyKeeper2::ShieldedInput> inputShielded;
+            if (txptr->GetParameter(TxParameterID::InputCoinsShielded, inputShielded))
+            {
+                for (const auto& si : inputShielded)
+                    ai.m_Shielded[si.m_Key.m_kSerG.m_Value] = txid;
+            }
+        }
+    }
+
+    bool Wallet::FilterEventUtxo(const proto::Event::Utxo& evt, Height h, UtxoEvent& res)
     {
         CoinID cid = evt.m_Cid;
         // filter-out false positives
         if (!m_WalletDB->IsRecoveredMatch(cid, evt.m_Commitment))
+            return false;
+
+        res.m_Cid = evt.m_Cid;
+        res.m_Height = h;
+        res.m_Maturity = evt.m_Maturity;
+        res.m_Add = 0 != (proto::Event::Flags::Add & evt.m_Flags);
+        res.m_User = evt.m_User;
+
+        CacheCommitment(evt.m_Commitment, evt.m_Maturity, res.m_Add);
+        return true;
+    }
+
+    void Wallet::ProcessEventUtxo(const proto::Event::Utxo& evt, Height h)
+    {
+        std::vector<UtxoEvent> v(1);
+        if (!FilterEventUtxo(evt, h, v.front()))
             return;
 
-        bool bAdd = 0 != (proto::Event::Flags::Add & evt.m_Flags);
-        CacheCommitment(evt.m_Commitment, evt.m_Maturity, bAdd);
-        ProcessEventUtxo(evt.m_Cid, h, evt.m_Maturity, bAdd, evt.m_User);
+        ActiveInputs ai;
+        get_ActiveInputs(ai);
+        ProcessEventsUtxo(v, ai);
     }
 
     void Wallet::ProcessEventUtxo(const CoinID& cid, Height h, Height hMaturity, bool bAdd, const Output::User& user)
     {
-        Coin c;
-        c.m_ID = cid;
-        bool bExists = m_WalletDB->findCoin(c);
-        c.m_maturity = hMaturity;
+        std::vector<UtxoEvent> v(1);
+        UtxoEvent& evt = v.front();
+        evt.m_Cid = cid;
+        evt.m_Height = h;
+        evt.m_Maturity = hMaturity;
+        evt.m_Add = bAdd;
+        evt.m_User = user;
+
+        ActiveInputs ai;
+        get_ActiveInputs(ai);
+        ProcessEventsUtxo(v, ai);
+    }
+
+    void Wallet::ProcessEventsUtxo(const std::vector<UtxoEvent>& v, const ActiveInputs& ai)
+    {
+        if (v.empty())
+            return;
 
-        const auto* data = Output::User::ToPacked(user);
+        // the same coin may appear several times (i.e. confirmed and spent), events are applied in order
+        std::vector<Coin> coins;
+        std::vector<size_t> idx;
+        idx.reserve(v.size());
+
+        std::map<ECC::Hash::Value, size_t> mapIdx;
+        for (const auto& evt : v)
+        {
+            ECC::Hash::Value hv;
+            evt.m_Cid.get_Hash(hv);
+
+            auto [it, isNew] = mapIdx.emplace(hv, coins.size());
+            if (isNew)
+            {
+                coins.emplace_back();
+                coins.back().m_ID = evt.m_Cid;
+            }
+            idx.push_back(it->second);
+        }
+
+        std::vector<bool> exists;
+        m_WalletDB->findCoins(coins, exists);
+
+        std::vector<bool> modified(coins.size(), false);
+        for (size_t i = 0; i < v.size(); ++i)
+        {
+            size_t iCoin = idx[i];
+            if (ApplyEventUtxo(coins[iCoin], exists[iCoin], v[i], ai))
+                exists[iCoin] = modified[iCoin] = true;
+        }
+
+        std::vector<Coin> toSave;
+        toSave.reserve(coins.size());
+        for (size_t i = 0; i < coins.size(); ++i)
+        {
+            if (modified[i])
+                toSave.push_back(std::move(coins[i]));
+        }
+
+        m_WalletDB->saveCoins(toSave);
+    }
+
+    bool Wallet::ApplyEventUtxo(Coin& c, bool bExists, const UtxoEvent& evt, const ActiveInputs& ai)
+    {
+        c.m_maturity = evt.m_Maturity;
+
+        const auto* data = Output::User::ToPacked(evt.m_User);
         if (!memis0(data->m_TxID.m_pData, sizeof(TxID)))
         {
             c.m_createTxId.emplace();
             std::copy_n(data->m_TxID.m_pData, sizeof(TxID), c.m_createTxId->begin());
         }
 
-        LOG_INFO() << "CoinID: " << c.m_ID << " Maturity=" << hMaturity << (bAdd ? " Confirmed" : " Spent") << ", Height=" << h;
+        LOG_INFO() << "CoinID: " << c.m_ID << " Maturity=" << evt.m_Maturity << (evt.m_Add ? " Confirmed" : " Spent") << ", Height=" << evt.m_Height;
 
-        if (bAdd)
+        if (evt.m_Add)
         {
-            std::setmin(c.m_confirmHeight, h); // in case of std utxo proofs - the event height may be bigger than actual utxo height
+            std::setmin(c.m_confirmHeight, evt.m_Height); // in case of std utxo proofs - the event height may be bigger than actual utxo height
 
             // Check if this Coin participates in any active transaction
             // if it does and mark it as outgoing (bug: ux_504)
-            for (const auto& [txid, txptr] : m_ActiveTransactions)
+            ECC::Hash::Value hv;
+            c.m_ID.get_Hash(hv);
+
+            auto it = ai.m_Coins.find(hv);
+            if (ai.m_Coins.end() != it)
             {
-                std::vector<Coin::ID> icoins;
-                txptr->GetParameter(TxParameterID::InputCoins, icoins);
-                if (std::find(icoins.begin(), icoins.end(), c.m_ID) != icoins.end())
-                {
-                    c.m_status = Coin::Status::Outgoing;
-                    c.m_spentTxId = txid;
-                    LOG_INFO() << "CoinID: " << c.m_ID << " marked as Outgoing";
-                }
+                c.m_status = Coin::Status::Outgoing;
+                c.m_spentTxId = it->second;
+                LOG_INFO() << "CoinID: " << c.m_ID << " marked as Outgoing";
             }
         }
         else
         {
             if (!bExists)
-                return; // should alert!
+                return false; // should alert!
 
-            std::setmin(c.m_spentHeight, h); // reported spend height may be bigger than it actuall was (in case of macroblocks)
+            std::setmin(c.m_spentHeight, evt.m_Height); // reported spend height may be bigger than it actuall was (in case of macroblocks)
         }
 
-        m_WalletDB->saveCoin(c);
+        return true;
     }
 
     void Wallet::ProcessEventAsset(const proto::Event::AssetCtl& assetCtl, Height h)
@@ -1627,6 +1869,13 @@ namespace beam::wallet
     }
 
     void Wallet::ProcessEventShieldedUtxo(const proto::Event::Shielded& shieldedEvt, Height h)
+    {
+        ActiveInputs ai;
+        get_ActiveInputs(ai);
+        ProcessEventShieldedUtxo(shieldedEvt, h, ai);
+    }
+
+    void Wallet::ProcessEventShieldedUtxo(const proto::Event::Shielded& shieldedEvt, Height h, const ActiveInputs& ai)
     {
         auto shieldedCoin = m_WalletDB->getShieldedCoin(shieldedEvt.m_CoinID.m_Key);
         if (!shieldedCoin)
@@ -1655,17 +1904,12 @@ namespace beam::wallet
         }
 
         // Check if this Coin participates in any active transaction
-        for (const auto& [txid, txptr] : m_ActiveTransactions)
+        auto it = ai.m_Shielded.find(shieldedEvt.m_CoinID.m_Key.m_kSerG.m_Value);
+        if (ai.m_Shielded.end() != it)
         {
-
-            std::vector<IPrivateKeyKeeper2::ShieldedInput> inputShielded;
-            txptr->GetParameter(TxParameterID::InputCoinsShielded, inputShielded);
-            if (std::find(inputShielded.begin(), inputShielded.end(), shieldedEvt.m_CoinID) != inputShielded.end())
-            {
-                shieldedCoin->m_Status = ShieldedCoin::Status::Outgoing;;
-                shieldedCoin->m_spentTxId = txid;
-                LOG_INFO() << "Shielded output, ID: " << shieldedEvt.m_TxoID << " marked as Outgoing";
-            }
+            shieldedCoin->m_Status = ShieldedCoin::Status::Outgoing;
+            shieldedCoin->m_spentTxId = it->second;
+            LOG_INFO() << "Shielded output, ID: " << shieldedEvt.m_TxoID << " marked as Outgoing";
         }
 
         m_WalletDB->saveShieldedCoin(*shieldedCoin);
@@ -221,6 +221,7 @@ namespace beam::wallet
         void UpdateOnNextTip(BaseTransaction::Ptr tx);
         void SaveKnownState();
         void ProcessBody(const proto::BodyBuffers& b, Height h, NodeProcessor::Recognizer& recoginzer);
+        void ProcessBlock(Block::Body& block, Height h, NodeProcessor::Recognizer& recoginzer);
         void PreprocessBlock(TxVectors::Full& block);
         void RequestBodies();
         void RequestTreasury();
@@ -228,12 +229,33 @@ namespace beam::wallet
         void AbortBodiesRequests();
         void RequestEvents();
         void AbortEvents();
+        // Inputs of the active transactions, to mark the arriving coins that are already being spent.
+        // Built once per events batch instead of querying every active tx for every event
+        struct ActiveInputs
+        {
+            std::map<ECC::Hash::Value, TxID> m_Coins; // by CoinID hash
+            std::map<ECC::uintBig, TxID> m_Shielded; // by the serial key
+        };
+        void get_ActiveInputs(ActiveInputs&) const;
+
+        struct UtxoEvent
+        {
+            CoinID m_Cid;
+            Height m_Height;
+            Height m_Maturity;
+            bool m_Add;
+            Output::User m_User;
+        };
         void ProcessEventUtxo(const proto::Event::Utxo& utxoEvt, Height h);
         void ProcessEventUtxo(const CoinID&, Height h, Height hMaturity, bool bAdd, const Output::User& user);
+        bool FilterEventUtxo(const proto::Event::Utxo& utxoEvt, Height h, UtxoEvent&);
+        void ProcessEventsUtxo(const std::vector<UtxoEvent>&, const ActiveInputs&); // bulk coin lookup and a single save
+        bool ApplyEventUtxo(Coin&, bool bExists, const UtxoEvent&, const ActiveInputs&);
         void ProcessEventAsset(const proto::Event::AssetCtl& assetCtl, Height h);
         void SetEventsHeight(Height);
         Height GetEventsHeightNext();
         void ProcessEventShieldedUtxo(const proto::Event::Shielded& shieldedEvt, Height h);
+        void ProcessEventShieldedUtxo(const proto::Event::Shielded& shieldedEvt, Height h, const ActiveInputs&);
         void RequestStateSummary();
 
         void OnTransactionMsg(const WalletID& myID, const SetTxParameter& msg);
@@ -256,6 +278,12 @@ namespace beam::wallet
         void ResetCommitmentsCache();
         bool IsMobileNodeEnabled() const;
 
+    public:
+        // Deserializes block bodies starting from height h0 and trial-decodes their outputs using all threads of the executor.
+        // Outputs that don't belong to the owner are removed, the rest of recognition must be done in height order.
+        // Returns the number of leading bodies decoded successfully
+        static size_t DecodeBodies(const std::vector<proto::BodyBuffers>& bodies, Height h0, Key::IPKdf* pOwner, std::vector<Block::Body>& blocks, Executor& executor);
+
     private:
 
 // The following macros define
@@ -463,5 +491,6 @@ namespace beam::wallet
         bool m_IsTreasuryHandled = false;
         std::map<ECC::Point, Height> m_Commitments;
         bool m_IsCommitmentsCached = false;
+        std::unique_ptr<ExecutorMT_R> m_pBodiesExecutor; // created on demand
     };
 }
@@ -1144,6 +1144,16 @@ namespace beam::wallet
             return stm.step();
         }
 
+        // indices for paged coin listing (see getCoinsPage)
+        void CreateStorageSortIndex(sqlite3* db)
+        {
+            const char* req = "CREATE INDEX IF NOT EXISTS CoinAmountIndex ON " STORAGE_NAME "(amount);"
+                "CREATE INDEX IF NOT EXISTS CoinAssetIndex ON " STORAGE_NAME "(IFNULL(assetId,0));"
+                "CREATE INDEX IF NOT EXISTS CoinTypeIndex ON " STORAGE_NAME "(Type);";
+            int ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
+            throwIfError(ret, db);
+        }
+
         void CreateStorageTable(sqlite3* db)
         {
             const char* req = "CREATE TABLE " STORAGE_NAME " (" ENUM_ALL_STORAGE_FIELDS(LIST_WITH_TYPES, COMMA, ) ");"
@@ -1151,6 +1161,7 @@ namespace beam::wallet
                 "CREATE INDEX ConfirmIndex ON " STORAGE_NAME"(confirmHeight);";
             int ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
             throwIfError(ret, db);
+            CreateStorageSortIndex(db);
         }
 
         void CreateWalletMessageTable(sqlite3* db)
@@ -2068,6 +2079,7 @@ namespace beam::wallet
 
                 case DbVersion:
                     CreateTxParamsIndex(walletDB->_db);
+                    CreateStorageSortIndex(walletDB->_db);
                     // drop private variables from public database for cold wallet
                     if (separateDBForPrivateData && !DropPrivateVariablesFromPublicDatabase(*walletDB))
                     {
@@ -2159,7 +2171,10 @@ namespace beam::wallet
             const char* req =
                 "ALTER TABLE " STORAGE_NAME " RENAME TO " STORAGE_NAME "_del;"
                 "DROP INDEX CoinIndex;"
-                "DROP INDEX ConfirmIndex;";
+                "DROP INDEX ConfirmIndex;"
+                "DROP INDEX IF EXISTS CoinAmountIndex;"
+                "DROP INDEX IF EXISTS CoinAssetIndex;"
+                "DROP INDEX IF EXISTS CoinTypeIndex;";
 
             int ret = sqlite3_exec(_db, req, NULL, NULL, NULL);
             throwIfError(ret, _db);
@@ -2218,6 +2233,15 @@ namespace beam::wallet
     {
         if (_db)
         {
+            try
+            {
+                flushTxParameters();
+            }
+            catch (const runtime_error& ex)
+            {
+                LOG_ERROR() << "Wallet DB flush failed: " << ex.what();
+            }
+
             if (m_DbTransaction)
             {
                 try
@@ -2496,6 +2520,10 @@ namespace beam::wallet
         MyParser p(*this, prog);
         p.Init(get_OwnerKdf());
 
+        // utxos are recognized on all cores
+        ExecutorMT_R executor;
+        Executor::Scope scope(executor);
+
         if (p.Proceed(path.c_str()))
         {
             storage::setTreasuryHandled(*this, true);
@@ -2965,12 +2993,17 @@ namespace beam::wallet
         if (coins.empty())
             return;
 
+        vector<Coin> added, updated;
         for (auto& coin : coins)
         {
-            saveCoinRaw(coin);
+            if (saveCoinRaw(coin))
+                updated.push_back(coin);
+            else
+                added.push_back(coin);
         }
 
-        notifyCoinsChanged(ChangeAction::Updated, getUpdatedCoins(coins));
+        notifyCoinsChanged(ChangeAction::Added, getUpdatedCoins(added));
+        notifyCoinsChanged(ChangeAction::Updated, getUpdatedCoins(updated));
     }
 
     uint64_t WalletDB::AllocateKidRange(uint64_t nCount)
@@ -3069,6 +3102,36 @@ namespace beam::wallet
         return true;
     }
 
+    void WalletDB::findCoins(vector<Coin>& coins, vector<bool>& found)
+    {
+        found.assign(coins.size(), false);
+        if (coins.empty())
+            return;
+
+        const char* req = "SELECT " ENUM_STORAGE_FIELDS(LIST, COMMA, ) " FROM " STORAGE_NAME STORAGE_WHERE_ID;
+        sqlite::Statement stm(this, req);
+        Height h = getCurrentHeight();
+
+        for (size_t i = 0; i < coins.size(); ++i)
+        {
+            Coin& coin = coins[i];
+            if (i)
+                stm.Reset();
+
+            int colIdx = 0;
+            STORAGE_BIND_ID(coin)
+
+            if (!stm.step())
+                continue;
+
+            colIdx = 0;
+            ENUM_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+            storage::DeduceStatus(*this, coin, h);
+            found[i] = true;
+        }
+    }
+
     struct WalletDB::ShieldedStatusCtx
     {
         Height m_hTip;
@@ -3135,6 +3198,90 @@ namespace beam::wallet
         }
     }
 
+    std::vector<Coin> WalletDB::getCoinsPage(const CoinsPageFilter& filter, CoinsCursor& last)
+    {
+        const char* sortColumn = "ROWID";
+        switch (filter.m_SortField)
+        {
+        case CoinsPageFilter::SortField::Amount:  sortColumn = "amount"; break;
+        case CoinsPageFilter::SortField::AssetID: sortColumn = "IFNULL(assetId,0)"; break;
+        case CoinsPageFilter::SortField::Type:    sortColumn = "Type"; break;
+        default: break;
+        }
+
+        const char* cmp = filter.m_Desc ? "<" : ">";
+        const char* order = filter.m_Desc ? " DESC" : " ASC";
+
+        std::string query = "SELECT " STORAGE_FIELDS ", ROWID, ";
+        query.append(sortColumn).append(" FROM " STORAGE_NAME);
+
+        std::vector<std::string> parts;
+        if (!filter.m_WithAssets)
+        {
+            parts.push_back("IFNULL(assetId,0)=0");
+        }
+
+        if (filter.m_AssetID)
+        {
+            parts.push_back("IFNULL(assetId,0)=?1");
+        }
+
+        if (filter.m_After)
+        {
+            std::string q = "(";
+            q.append(sortColumn).append(cmp).append("?2 OR (")
+             .append(sortColumn).append("=?2 AND ROWID").append(cmp).append("?3))");
+            parts.push_back(std::move(q));
+        }
+
+        if (!parts.empty())
+        {
+            query.append(" WHERE ").append(boost::join(parts, " AND "));
+        }
+
+        query.append(" ORDER BY ").append(sortColumn).append(order)
+             .append(", ROWID").append(order)
+             .append(" LIMIT ?4 OFFSET ?5;");
+
+        sqlite::Statement stm(this, query.c_str());
+        if (filter.m_AssetID)
+        {
+            stm.bind(1, *filter.m_AssetID);
+        }
+        if (filter.m_After)
+        {
+            stm.bind(2, static_cast<uint64_t>(filter.m_After->m_Value));
+            stm.bind(3, static_cast<uint64_t>(filter.m_After->m_RowID));
+        }
+        stm.bind(4, filter.m_Count ? (int)filter.m_Count : -1);
+        stm.bind(5, filter.m_Skip);
+
+        std::vector<Coin> coins;
+        if (filter.m_Count)
+        {
+            coins.reserve(filter.m_Count);
+        }
+
+        Height h = getCurrentHeight();
+        while (stm.step())
+        {
+            Coin& coin = coins.emplace_back();
+
+            int colIdx = 0;
+            ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+            uint64_t rowID = 0, value = 0;
+            stm.get(colIdx++, rowID);
+            stm.get(colIdx++, value);
+            last.m_RowID = static_cast<int64_t>(rowID);
+            last.m_Value = static_cast<int64_t>(value);
+
+            storage::DeduceStatus(*this, coin, h);
+        }
+
+        return coins;
+    }
+
     void WalletDB::setVarRaw(const char* name, const void* data, size_t size)
     {
         const char* req = "INSERT or REPLACE INTO " VARIABLES_NAME " (" VARIABLES_FIELDS ") VALUES(?1, ?2);";
@@ -3447,6 +3594,8 @@ namespace beam::wallet
         helpers::StopWatch sw;
         sw.start();
 
+        flushTxParameters(); // tx_summary is updated on flush
+
         std::string query = "SELECT TxID FROM " TX_SUMMARY_NAME;
         std::vector<std::string> parts;
         std::string whereParams;
@@ -3480,6 +3629,37 @@ namespace beam::wallet
             }
             whereParams.append(boost::join(parts, " OR "))
                        .append(")");
+            parts.clear();
+        }
+
+        if (!filter.m_TxTypes.empty())
+        {
+            std::vector<std::string> types;
+            for (auto type : filter.m_TxTypes)
+            {
+                types.push_back(std::to_string((int)type));
+            }
+            parts.push_back("TransactionType IN (" + boost::join(types, ",") + ")");
+        }
+
+        if (filter.m_NoAssets)
+        {
+            parts.push_back("IFNULL(AssetID,0)=0");
+        }
+
+        if (filter.m_After)
+        {
+            // keyset pagination, served by CreateTimeIndex (which implicitly ends with the TxID primary key)
+            parts.push_back("(CreateTime<?1 OR (CreateTime=?1 AND TxID<?2))");
+        }
+
+        if (!parts.empty())
+        {
+            if (!whereParams.empty())
+            {
+                whereParams.append(" AND ");
+            }
+            whereParams.append(boost::join(parts, " AND "));
         }
 
         if (!whereParams.empty())
@@ -3488,9 +3668,25 @@ namespace beam::wallet
             query.append(whereParams);
         }
         
-        query.append(" ORDER BY CreateTime DESC");
+        query.append(" ORDER BY CreateTime DESC, TxID DESC");
+
+        if (filter.m_Count || filter.m_Skip)
+        {
+            query.append(" LIMIT ?3 OFFSET ?4");
+        }
 
         sqlite::Statement stm(this, query.c_str());
+        if (filter.m_After)
+        {
+            stm.bind(1, filter.m_After->m_CreateTime);
+            stm.bind(2, filter.m_After->m_TxID);
+        }
+        if (filter.m_Count || filter.m_Skip)
+        {
+            stm.bind(3, filter.m_Count ? (int)filter.m_Count : -1);
+            stm.bind(4, filter.m_Skip);
+        }
+
         sqlite::Statement stm2(this, "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1;");
         TxID txID;
         while (stm.step())
@@ -3513,6 +3709,8 @@ namespace beam::wallet
 
     vector<TxDescription> WalletDB::getTxHistory(wallet::TxType txType, uint64_t start, int count) const
     {
+        flushTxParameters();
+
         // TODO this is temporary solution
         int txCount = 0;
         {
@@ -3579,36 +3777,82 @@ namespace beam::wallet
     
     boost::optional<TxDescription> WalletDB::getTx(const TxID& txId) const
     {
-        // load only simple TX that supported by TxDescription
-        const char* req = "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1;";
-        sqlite::Statement stm(this, req);
-        return getTxImpl(txId, stm);
+        if (m_FullyCachedTxs.find(txId) == m_FullyCachedTxs.end())
+        {
+            // load only simple TX that supported by TxDescription
+            const char* req = "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1;";
+            sqlite::Statement stm(this, req);
+            loadTxToCache(txId, stm);
+        }
+        return makeTxDescription(txId, m_TxParametersCache[txId]);
     }
 
-    boost::optional<TxDescription> WalletDB::getTxImpl(const TxID& txId, sqlite::Statement& stm) const
+    void WalletDB::loadTxToCache(const TxID& txId, sqlite::Statement& stm) const
     {
         stm.Reset();
         stm.bind(1, txId);
 
-        TxDescription txDescription(txId);
-        struct Set : public std::priority_queue<TxParameterID, std::vector<TxParameterID>, std::greater<TxParameterID> >
+        auto& txParams = m_TxParametersCache[txId];
+        while (stm.step())
+        {
+            TxParameter parameter = {};
+            int colIdx = 0;
+            ENUM_TX_PARAMS_FIELDS(STM_GET_LIST, NOSEP, parameter);
+
+            // cached values are never older than the database ones
+            txParams[static_cast<SubTxID>(parameter.m_subTxID)].emplace(static_cast<TxParameterID>(parameter.m_paramID), std::move(parameter.m_value));
+        }
+        m_FullyCachedTxs.insert(txId);
+    }
+
+    boost::optional<TxDescription> WalletDB::getTxImpl(const TxID& txId, sqlite::Statement& stm) const
+    {
+        auto txIter = m_TxParametersCache.find(txId);
+        if (txIter != m_TxParametersCache.end() && m_FullyCachedTxs.find(txId) != m_FullyCachedTxs.end())
+        {
+            return makeTxDescription(txId, txIter->second);
+        }
+
+        // don't put the whole history into the cache, merge the cached parameters locally
+        ParameterCache::mapped_type txParams;
+        if (txIter != m_TxParametersCache.end())
         {
-            container_type::const_iterator begin() const noexcept { return c.begin(); }
-            container_type::const_iterator end() const noexcept { return c.end(); }
-        } gottenParams;
+            txParams = txIter->second;
+        }
+
+        stm.Reset();
+        stm.bind(1, txId);
 
         while (stm.step())
         {
             TxParameter parameter = {};
             int colIdx = 0;
             ENUM_TX_PARAMS_FIELDS(STM_GET_LIST, NOSEP, parameter);
-            auto parameterID = static_cast<TxParameterID>(parameter.m_paramID);
 
-            txDescription.SetParameter(parameterID, std::move(parameter.m_value), static_cast<SubTxID>(parameter.m_subTxID));
+            txParams[static_cast<SubTxID>(parameter.m_subTxID)].emplace(static_cast<TxParameterID>(parameter.m_paramID), std::move(parameter.m_value));
+        }
+
+        return makeTxDescription(txId, txParams);
+    }
+
+    boost::optional<TxDescription> WalletDB::makeTxDescription(const TxID& txId, const ParameterCache::mapped_type& params) const
+    {
+        TxDescription txDescription(txId);
+        std::set<TxParameterID> gottenParams;
 
-            if (parameter.m_subTxID == kDefaultSubTxID)
+        for (const auto& [subTxID, subTxParams] : params)
+        {
+            for (const auto& [parameterID, value] : subTxParams)
             {
-                gottenParams.emplace(parameterID);
+                if (!value)
+                    continue;
+
+                txDescription.SetParameter(parameterID, ByteBuffer(*value), subTxID);
+
+                if (subTxID == kDefaultSubTxID)
+                {
+                    gottenParams.insert(parameterID);
+                }
             }
         }
 
@@ -3650,6 +3894,8 @@ namespace beam::wallet
 
     void WalletDB::deleteTx(const TxID& txId)
     {
+        flushTxParameters();
+
         auto tx = getTx(txId);
         if (tx.is_initialized())
         {
@@ -4515,76 +4761,37 @@ namespace beam::wallet
 
     bool WalletDB::setTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const ByteBuffer& blob, bool shouldNotifyAboutChanges, bool allowModify /* = true */)
     {
-        if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
+        boost::optional<ByteBuffer> prevValue;
+        if (!findParameterInCache(txID, subTxID, paramID, prevValue))
         {
-            if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
+            ByteBuffer buf;
+            if (getTxParameter(txID, subTxID, paramID, buf))
             {
-                if (auto pit = subTxIter->second.find(paramID); pit != subTxIter->second.end())
-                {
-                    if (pit->second && blob == *(pit->second))
-                    {
-                        return false;
-                    }
-                }
+                prevValue = std::move(buf);
             }
         }
 
-        bool hasTx = hasTransaction(txID);
+        if (prevValue)
         {
-            sqlite::Statement stm(this, "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1 AND subTxID=?2 AND paramID=?3;");
-
-            stm.bind(1, txID);
-            stm.bind(2, subTxID);
-            stm.bind(3, paramID);
-
-            if (stm.step())
-            {
-                // already set
-                if (!allowModify)
-                    return false;
+            // already set
+            if (!allowModify || blob == *prevValue)
+                return false;
+        }
 
-                sqlite::Statement stm2(this, "UPDATE " TX_PARAMS_NAME  " SET value = ?4 WHERE txID = ?1 AND subTxID=?2 AND paramID = ?3;");
-                stm2.bind(1, txID);
-                stm2.bind(2, subTxID);
-                stm2.bind(3, paramID);
-                stm2.bind(4, blob);
-                stm2.step();
+        bool hasTx = hasTransaction(txID);
 
-                if (shouldNotifyAboutChanges)
-                {
-                    auto tx = getTx(txID);
-                    if (tx.is_initialized())
-                    {
-                        notifyTransactionChanged(ChangeAction::Updated, { *tx });
-                    }
-                }
+        // the value is written to the database on the next flush
+        insertParameterToCache(txID, subTxID, paramID, blob);
+        markParameterDirty(txID, subTxID, paramID);
 
-                insertParameterToCache(txID, subTxID, paramID, blob);
-                OnTxSummaryParam(txID, subTxID, paramID, &blob);
-                return true;
-            }
-        }
-        
-        sqlite::Statement stm(this, "INSERT INTO " TX_PARAMS_NAME " (" ENUM_TX_PARAMS_FIELDS(LIST, COMMA, ) ") VALUES(" ENUM_TX_PARAMS_FIELDS(BIND_LIST, COMMA, ) ");");
-        TxParameter parameter;
-        parameter.m_txID = txID;
-        parameter.m_subTxID = subTxID;
-        parameter.m_paramID = static_cast<int>(paramID);
-        parameter.m_value = blob;
-        int colIdx = 0;
-        ENUM_TX_PARAMS_FIELDS(STM_BIND_LIST, NOSEP, parameter);
-        stm.step();
         if (shouldNotifyAboutChanges)
         {
             auto tx = getTx(txID);
             if (tx.is_initialized())
             {
-                notifyTransactionChanged(hasTx ? ChangeAction::Updated : ChangeAction::Added, { *tx });
+                notifyTransactionChanged((prevValue || hasTx) ? ChangeAction::Updated : ChangeAction::Added, { *tx });
             }
         }
-
-        insertParameterToCache(txID, subTxID, paramID, blob);
-        OnTxSummaryParam(txID, subTxID, paramID, &blob);
         return true;
     }
 
@@ -4677,46 +4884,22 @@ namespace beam::wallet
 
     bool WalletDB::delTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID)
     {
-        if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
-        {
-            if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
-            {
-                if (auto pit = subTxIter->second.find(paramID); pit != subTxIter->second.end())
-                {
-                    subTxIter->second.erase(pit);
-                }
-            }
-        }
-
-        sqlite::Statement stm(this, "DELETE FROM " TX_PARAMS_NAME " WHERE txID=?1 AND subTxID=?2 AND paramID=?3;");
-
-        stm.bind(1, txID);
-        stm.bind(2, subTxID);
-        stm.bind(3, paramID);
-
-        stm.step();
-
-        OnTxSummaryParam(txID, subTxID, paramID, nullptr);
-
+        insertParameterToCache(txID, subTxID, paramID, boost::optional<ByteBuffer>());
+        markParameterDirty(txID, subTxID, paramID);
         return true;
     }
 
     bool WalletDB::getTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob) const
     {
-        if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
+        boost::optional<ByteBuffer> value;
+        if (findParameterInCache(txID, subTxID, paramID, value))
         {
-            if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
+            if (value)
             {
-                if (auto pit = subTxIter->second.find(paramID); pit != subTxIter->second.end())
-                {
-                    if (pit->second)
-                    {
-                        blob = *(pit->second);
-                        return true;
-                    }
-                    return false;
-                }
+                blob = *value;
+                return true;
             }
+            return false;
         }
 
         sqlite::Statement stm(this, "SELECT value FROM " TX_PARAMS_NAME " WHERE txID=?1 AND subTxID=?2 AND paramID=?3;");
@@ -4742,6 +4925,8 @@ namespace beam::wallet
 
     std::vector<TxParameter> WalletDB::getAllTxParameters() const
     {
+        flushTxParameters();
+
         sqlite::Statement stm(this, "SELECT * FROM " TX_PARAMS_NAME ";");
         std::vector<TxParameter> res;
         while (stm.step())
@@ -4766,6 +4951,96 @@ namespace beam::wallet
     void WalletDB::deleteParametersFromCache(const TxID& txID)
     {
         m_TxParametersCache.erase(txID);
+        m_FullyCachedTxs.erase(txID);
+    }
+
+    bool WalletDB::findParameterInCache(const TxID& txID, SubTxID subTxID, TxParameterID paramID, boost::optional<ByteBuffer>& blob) const
+    {
+        auto txIter = m_TxParametersCache.find(txID);
+        if (txIter == m_TxParametersCache.end())
+            return false;
+
+        if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
+        {
+            if (auto pit = subTxIter->second.find(paramID); pit != subTxIter->second.end())
+            {
+                blob = pit->second;
+                return true;
+            }
+        }
+
+        // all the parameters of this tx are known, the parameter is just absent
+        return m_FullyCachedTxs.find(txID) != m_FullyCachedTxs.end();
+    }
+
+    void WalletDB::markParameterDirty(const TxID& txID, SubTxID subTxID, TxParameterID paramID)
+    {
+        m_DirtyTxParameters[txID].emplace(subTxID, paramID);
+
+        if (m_Initialized)
+        {
+            onModified();
+        }
+        else
+        {
+            // wallet db is opening or migrating, there could be no reactor to run timer
+            flushTxParameters();
+        }
+    }
+
+    void WalletDB::flushTxParameters()
+    {
+        if (m_DirtyTxParameters.empty())
+            return;
+
+        auto dirty = std::move(m_DirtyTxParameters);
+        m_DirtyTxParameters.clear();
+
+        sqlite::Statement stm(this, "INSERT OR REPLACE INTO " TX_PARAMS_NAME " (" ENUM_TX_PARAMS_FIELDS(LIST, COMMA, ) ") VALUES(" ENUM_TX_PARAMS_FIELDS(BIND_LIST, COMMA, ) ");");
+        sqlite::Statement stmDel(this, "DELETE FROM " TX_PARAMS_NAME " WHERE txID=?1 AND subTxID=?2 AND paramID=?3;");
+
+        for (const auto& [txID, params] : dirty)
+        {
+            for (const auto& [subTxID, paramID] : params)
+            {
+                boost::optional<ByteBuffer> value;
+                if (!findParameterInCache(txID, subTxID, paramID, value))
+                {
+                    assert(false); // dirty parameters must stay in cache until flushed
+                    continue;
+                }
+
+                if (value)
+                {
+                    TxParameter parameter;
+                    parameter.m_txID = txID;
+                    parameter.m_subTxID = subTxID;
+                    parameter.m_paramID = static_cast<int>(paramID);
+                    parameter.m_value = *value;
+
+                    stm.Reset();
+                    int colIdx = 0;
+                    ENUM_TX_PARAMS_FIELDS(STM_BIND_LIST, NOSEP, parameter);
+                    stm.step();
+                }
+                else
+                {
+                    stmDel.Reset();
+                    stmDel.bind(1, txID);
+                    stmDel.bind(2, subTxID);
+                    stmDel.bind(3, paramID);
+                    stmDel.step();
+                }
+
+                OnTxSummaryParam(txID, subTxID, paramID, value.get_ptr());
+            }
+        }
+    }
+
+    void WalletDB::flushTxParameters() const
+    {
+        // pending parameters must reach the database before it is queried directly
+        const_cast<WalletDB*>(this)->flushTxParameters();
     }
 
     bool WalletDB::hasTransaction(const TxID& txID) const
@@ -4805,6 +5080,11 @@ namespace beam::wallet
             m_DbTransaction->rollback();
             m_DbTransaction.reset();
         }
+
+        // cached parameters may not match the database anymore
+        m_DirtyTxParameters.clear();
+        m_TxParametersCache.clear();
+        m_FullyCachedTxs.clear();
     }
 
     void WalletDB::onModified()
@@ -4826,6 +5106,9 @@ namespace beam::wallet
 
     void WalletDB::onFlushTimer()
     {
+        // write cached parameters while the flush is still marked as pending, so that the timer isn't restarted
+        flushTxParameters();
+
         m_IsFlushPending = false;
         if (m_DbTransaction)
         {
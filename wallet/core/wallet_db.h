@@ -233,11 +233,50 @@ namespace beam::wallet
     BEAM_TX_LIST_NORMAL_PARAM_MAP(MACRO) \
     BEAM_TX_LIST_HEIGHT_MAP(MACRO) 
 
+    // Position of the last visited transaction, used to continue the listing (keyset pagination).
+    // Transactions are visited in (CreateTime, TxID) descending order
+    struct TxListCursor
+    {
+        Timestamp m_CreateTime = 0;
+        TxID m_TxID = {};
+    };
+
     struct TxListFilter
     {
 #define MACRO(id, type) boost::optional<type> m_##id;
         BEAM_TX_LIST_FILTER_MAP(MACRO)
 #undef MACRO
+        std::vector<TxType> m_TxTypes;          // if not empty, only the listed types are visited
+        bool m_NoAssets = false;                // skip transactions with non-zero asset id
+        boost::optional<TxListCursor> m_After;  // start right after this position
+        uint32_t m_Skip = 0;
+        uint32_t m_Count = 0;                   // 0 - no limit
+    };
+
+    // Keyset pagination over the stored coins. Coins are ordered by the indexed column and ROWID as a tie-breaker
+    struct CoinsCursor
+    {
+        int64_t m_Value = 0;
+        int64_t m_RowID = 0;
+    };
+
+    struct CoinsPageFilter
+    {
+        enum class SortField
+        {
+            Default, // insertion order
+            Amount,
+            AssetID,
+            Type
+        };
+
+        SortField m_SortField = SortField::Default;
+        bool m_Desc = false;
+        bool m_WithAssets = true;
+        boost::optional<Asset::ID> m_AssetID;
+        boost::optional<CoinsCursor> m_After;
+        uint32_t m_Skip = 0;
+        uint32_t m_Count = 0;                   // 0 - no limit
     };
 
     struct IWalletDB;
@@ -454,12 +493,19 @@ namespace beam::wallet
         virtual void removeCoin(const Coin::ID&) = 0;
         virtual void removeCoins(const std::vector<Coin::ID>&) = 0;
         virtual bool findCoin(Coin& coin) = 0;
+        virtual void findCoins(std::vector<Coin>& coins, std::vector<bool>& found) // bulk findCoin
+        {
+            found.resize(coins.size());
+            for (size_t i = 0; i < coins.size(); ++i)
+                found[i] = findCoin(coins[i]);
+        }
         virtual void clearCoins() = 0;
         virtual void setCoinConfirmationsOffset(uint32_t offset) = 0;
         virtual uint32_t getCoinConfirmationsOffset() const = 0;
 
         // Generic visitors
         virtual void visitCoins(std::function<bool(const Coin& coin)> func) = 0;
+        virtual std::vector<Coin> getCoinsPage(const CoinsPageFilter& filter, CoinsCursor& last) = 0;
         virtual void visitAssets(std::function<bool(const WalletAsset&)> func) = 0;
         virtual void visitShieldedCoins(std::function<bool(const ShieldedCoin& info)> func) = 0;
         virtual void visitShieldedCoinsUnspent(const std::function<bool(const ShieldedCoin& info)>& func) = 0;
@@ -632,11 +678,13 @@ namespace beam::wallet
         void removeCoin(const Coin::ID&) override;
         void removeCoins(const std::vector<Coin::ID>&) override;
         bool findCoin(Coin& coin) override;
+        void findCoins(std::vector<Coin>& coins, std::vector<bool>& found) override;
         void clearCoins() override;
         void setCoinConfirmationsOffset(uint32_t offset) override;
         uint32_t getCoinConfirmationsOffset() const override;
 
         void visitCoins(std::function<bool(const Coin& coin)> func) override;
+        std::vector<Coin> getCoinsPage(const CoinsPageFilter& filter, CoinsCursor& last) override;
         void visitAssets(std::function<bool(const WalletAsset& info)> func) override;
         void visitShieldedCoins(std::function<bool(const ShieldedCoin& info)> func) override;
         void visitShieldedCoinsUnspent(const std::function<bool(const ShieldedCoin& info)>& func) override;
@@ -778,6 +826,12 @@ namespace beam::wallet
 
         void insertParameterToCache(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const boost::optional<ByteBuffer>& blob) const;
         void deleteParametersFromCache(const TxID& txID);
+        bool findParameterInCache(const TxID& txID, SubTxID subTxID, TxParameterID paramID, boost::optional<ByteBuffer>& blob) const;
+        boost::optional<TxDescription> makeTxDescription(const TxID& txId, const ParameterCache::mapped_type& params) const;
+        void loadTxToCache(const TxID& txId, sqlite::Statement& stm) const;
+        void markParameterDirty(const TxID& txID, SubTxID subTxID, TxParameterID paramID);
+        void flushTxParameters();
+        void flushTxParameters() const;
         bool hasTransaction(const TxID& txID) const;
         void flushDB();
         void rollbackDB();
@@ -833,6 +887,11 @@ namespace beam::wallet
         } m_History;
         
         mutable ParameterCache m_TxParametersCache;
+        // transactions whose whole parameter set is in m_TxParametersCache
+        mutable std::set<TxID> m_FullyCachedTxs;
+        // parameters modified in the cache, but not written to the database yet.
+        // They're written in a single batch on the flush timer, within the same db transaction
+        std::map<TxID, std::set<std::pair<SubTxID, TxParameterID>>> m_DirtyTxParameters;
 
         struct LocalKeyKeeper;
         LocalKeyKeeper* m_pLocalKeyKeeper = nullptr;
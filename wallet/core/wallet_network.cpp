@@ -20,6 +20,8 @@ namespace
 {
     const char* BBS_TIMESTAMPS = "BbsTimestamps";
     const unsigned AddressUpdateInterval_ms = 60 * 1000; // check addresses every minute
+    const size_t MaxUnrecognizedMsgs = 10000;
+    const size_t MinAddrsForParallelDecrypt = 16;
 }
 
 
@@ -62,48 +64,119 @@ namespace beam::wallet {
         Addr::Channel key;
         key.m_Value = channel;
 
-        for (ChannelSet::iterator it = m_Channels.lower_bound(key); ; ++it)
+        ChannelSet::iterator it0 = m_Channels.lower_bound(key);
+        if ((m_Channels.end() == it0) || (it0->m_Value != channel))
+            return;
+
+        if (!m_pKdfSbbs)
         {
-            if (m_Channels.end() == it)
-                break;
-            if (it->m_Value != channel)
-                break; // as well
+            // read-only wallet
+            m_WalletDB->saveIncomingWalletMessage(channel, msg);
+            OnIncomingMessage();
+            return;
+        }
 
+        ECC::Hash::Value hvMsg;
+        ECC::Hash::Processor() << channel << Blob(msg) >> hvMsg;
 
-            if (!m_pKdfSbbs)
-            {
-                // read-only wallet
-                m_WalletDB->saveIncomingWalletMessage(channel, msg);
-                OnIncomingMessage();
-                return;
-            }
+        if (m_UnrecognizedMsgs.end() != m_UnrecognizedMsgs.find(hvMsg))
+            return; // already tried
 
-            ByteBuffer buf = msg; // duplicate
-            uint8_t* pMsg = &buf.front();
-            uint32_t nSize = static_cast<uint32_t>(buf.size());
+        proto::Bbs::Decryptor dec;
+        if (msg.empty() || !dec.Init(&msg.front(), static_cast<uint32_t>(msg.size())))
+        {
+            AddUnrecognized(hvMsg);
+            return;
+        }
 
-            if (!proto::Bbs::Decrypt(pMsg, nSize, it->get_ParentObj().m_sk))
-                continue;
+        std::vector<const Addr*> vAddrs;
+        for (ChannelSet::iterator it = it0; (m_Channels.end() != it) && (it->m_Value == channel); ++it)
+            vAddrs.push_back(&it->get_ParentObj());
 
-            SetTxParameter msgWallet;
-            bool bValid = false;
+        ByteBuffer buf; // reused by all attempts
 
-            try {
-                Deserializer der;
-                der.reset(pMsg, nSize);
-                der& msgWallet;
-                bValid = true;
-            }
-            catch (const std::exception&) {
-                LOG_WARNING() << "BBS deserialization failed";
-            }
+        if (vAddrs.size() < MinAddrsForParallelDecrypt)
+        {
+            for (const Addr* pAddr : vAddrs)
+                if (TryDecrypt(dec, *pAddr, nullptr, buf))
+                    return;
+        }
+        else
+        {
+            if (!m_pExecutor)
+                m_pExecutor = std::make_unique<ExecutorMT_R>();
+
+            std::vector<ECC::NoLeak<ECC::Hash::Value> > vSecrets(vAddrs.size());
 
-            if (bValid)
+            struct Task
+                :public Executor::TaskSync
             {
-                m_Wallet.OnWalletMessage(it->get_ParentObj().m_Wid.m_Value, msgWallet);
-                break;
-            }
+                const proto::Bbs::Decryptor& m_Dec;
+                const std::vector<const Addr*>& m_vAddrs;
+                std::vector<ECC::NoLeak<ECC::Hash::Value> >& m_vSecrets;
+
+                Task(const proto::Bbs::Decryptor& dec, const std::vector<const Addr*>& vAddrs, std::vector<ECC::NoLeak<ECC::Hash::Value> >& vSecrets)
+                    : m_Dec(dec)
+                    , m_vAddrs(vAddrs)
+                    , m_vSecrets(vSecrets)
+                {
+                }
+
+                void Exec(Executor::Context& ctx) override
+                {
+                    uint32_t i0, nCount;
+                    ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_vAddrs.size()));
+
+                    for (uint32_t i = i0; i < i0 + nCount; i++)
+                        m_Dec.get_Secret(m_vSecrets[i].V, m_vAddrs[i]->m_sk);
+                }
+            } t(dec, vAddrs, vSecrets);
+
+            m_pExecutor->ExecAll(t);
+
+            for (size_t i = 0; i < vAddrs.size(); i++)
+                if (TryDecrypt(dec, *vAddrs[i], &vSecrets[i].V, buf))
+                    return;
         }
+
+        AddUnrecognized(hvMsg);
+    }
+
+    bool BaseMessageEndpoint::TryDecrypt(const proto::Bbs::Decryptor& dec, const Addr& addr, const ECC::Hash::Value* pSecret, ByteBuffer& buf)
+    {
+        bool bDecrypted = pSecret ?
+            dec.Decrypt(buf, *pSecret, addr.m_Pk) :
+            dec.Decrypt(buf, addr.m_sk, addr.m_Pk);
+
+        if (!bDecrypted)
+            return false;
+
+        SetTxParameter msgWallet;
+
+        try {
+            Deserializer der;
+            der.reset(buf);
+            der& msgWallet;
+        }
+        catch (const std::exception&) {
+            LOG_WARNING() << "BBS deserialization failed";
+            return false;
+        }
+
+        m_Wallet.OnWalletMessage(addr.m_Wid.m_Value, msgWallet);
+        return true;
+    }
+
+    void BaseMessageEndpoint::AddUnrecognized(const ECC::Hash::Value& hvMsg)
+    {
+        if (m_UnrecognizedOrder.size() >= MaxUnrecognizedMsgs)
+        {
+            m_UnrecognizedMsgs.erase(m_UnrecognizedOrder.front());
+            m_UnrecognizedOrder.pop_front();
+        }
+
+        m_UnrecognizedMsgs.insert(hvMsg);
+        m_UnrecognizedOrder.push_back(hvMsg);
     }
 
     BaseMessageEndpoint::Addr* BaseMessageEndpoint::CreateOwnAddr(const WalletID& wid)
@@ -115,6 +188,10 @@ namespace beam::wallet {
         m_Addresses.insert(pAddr->m_Wid);
         m_Channels.insert(pAddr->m_Channel);
 
+        // the new address may decrypt messages we couldn't
+        m_UnrecognizedMsgs.clear();
+        m_UnrecognizedOrder.clear();
+
         if (IsSingleChannelUser(pAddr->m_Channel))
             OnChannelAdded(pAddr->m_Channel.m_Value);
 
@@ -136,6 +213,7 @@ namespace beam::wallet {
         {
             pAddr = CreateOwnAddr(address.m_walletID);
             m_WalletDB->get_SbbsPeerID(pAddr->m_sk, pAddr->m_Wid.m_Value.m_Pk, address.m_OwnID);
+            pAddr->m_Pk = pAddr->m_Wid.m_Value.m_Pk;
         }
         else
         {
@@ -233,6 +311,7 @@ namespace beam::wallet {
     {
         Addr* pAddr = CreateOwnAddr(addr);
         pAddr->m_sk = sk;
+        pAddr->m_Pk.FromSk(pAddr->m_sk);
         pAddr->m_ExpirationTime = Timestamp(-1);
     }
 
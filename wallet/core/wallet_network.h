@@ -20,6 +20,7 @@
 #include "bbs_miner.h"
 #include <boost/intrusive/set.hpp>
 #include <boost/intrusive/list.hpp>
+#include <deque>
 #include "wallet_request_bbs_msg.h"
 #include "wallet.h"
 
@@ -50,6 +51,7 @@ namespace beam::wallet
             }
 
             ECC::Scalar::Native m_sk; // private addr
+            PeerID m_Pk; // public addr, matching m_sk
             Timestamp m_ExpirationTime;
         };
     public:
@@ -74,6 +76,8 @@ namespace beam::wallet
         void Listen(const WalletID&, const ECC::Scalar::Native&) override;
         void Unlisten(const WalletID&) override;
         void OnAddressTimer();
+        bool TryDecrypt(const proto::Bbs::Decryptor&, const Addr&, const ECC::Hash::Value* pSecret, ByteBuffer& buf);
+        void AddUnrecognized(const ECC::Hash::Value& hvMsg);
         
     private:
         typedef bi::multiset<Addr::Wid> WidSet;
@@ -86,6 +90,13 @@ namespace beam::wallet
         IWalletDB::Ptr m_WalletDB;
         Key::IKdf::Ptr m_pKdfSbbs;
         io::Timer::Ptr m_AddressExpirationTimer;
+
+        // Messages none of our addresses could decrypt, to skip them if received again. Reset when an address is added
+        std::set<ECC::Hash::Value> m_UnrecognizedMsgs;
+        std::deque<ECC::Hash::Value> m_UnrecognizedOrder; // for eviction
+
+        // Shared secrets for channels with many addresses are derived on all cores
+        std::unique_ptr<ExecutorMT_R> m_pExecutor;
     };
 
     class BbsSender
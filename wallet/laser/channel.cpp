@@ -389,7 +389,7 @@ int Channel::get_LastState() const
     return m_lastState;
 }
 
-void Channel::UpdateRestorePoint()
+bool Channel::UpdateRestorePoint()
 {
     Serializer ser;
 
@@ -440,7 +440,11 @@ void Channel::UpdateRestorePoint()
     }
 
     Blob blob(ser.buffer().first, static_cast<uint32_t>(ser.buffer().second));
-    blob.Export(m_data);
+    ByteBuffer data;
+    blob.Export(data);
+
+    bool bChanged = (data != m_data);
+    m_data.swap(data);
 
     m_bbsTimestamp = getTimestamp();
 
@@ -469,7 +473,8 @@ void Channel::UpdateRestorePoint()
                 - m_Params.m_hPostLockReserve;
         }
     }
-    
+
+    return bChanged;
 }
 
 void Channel::LogState()
@@ -578,6 +583,16 @@ bool Channel::IsSubscribed() const
     return m_isSubscribed;
 }
 
+Height Channel::get_UpdateScheduled() const
+{
+    return m_hUpdateScheduled;
+}
+
+void Channel::set_UpdateScheduled(Height h)
+{
+    m_hUpdateScheduled = h;
+}
+
 void Channel::RestoreInternalState(const ByteBuffer& data)
 {
     try
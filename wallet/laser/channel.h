@@ -91,7 +91,7 @@ public:
     bool Open(Height hOpenTxDh);
     bool TransformLastState();
     int get_LastState() const;
-    void UpdateRestorePoint();
+    bool UpdateRestorePoint(); // returns true if the persistent state has changed
     void LogState();
     void Subscribe();
     void Unsubscribe();
@@ -99,6 +99,8 @@ public:
     bool IsUpdateStuck() const;
     bool IsGracefulCloseStuck() const;
     bool IsSubscribed() const;
+    Height get_UpdateScheduled() const;
+    void set_UpdateScheduled(Height h);
 
 private:
     void RestoreInternalState(const ByteBuffer& data);
@@ -122,5 +124,6 @@ private:
     std::unique_ptr<Receiver> m_upReceiver;
     ByteBuffer m_data;
     bool m_isSubscribed = false;
+    Height m_hUpdateScheduled = MaxHeight;
 };
 }  // namespace beam::wallet::laser
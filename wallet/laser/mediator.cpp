@@ -79,7 +79,9 @@ void Mediator::OnNewTip()
     if (!ValidateTip())
         return;
 
-    UpdateChannels();
+    Block::SystemState::Full tip;
+    get_History().get_Tip(tip);
+    UpdateChannels(tip.m_Height);
 
     for (auto& sceduledAction : m_actionsQueue)
         sceduledAction();
@@ -122,6 +124,12 @@ void Mediator::OnRolledBack()
         }
     }
 
+    for (auto& it: m_channels)
+    {
+        if (it.second)
+            ScheduleUpdate(it.second);
+    }
+
     m_closedChannels.erase(
         std::remove(m_closedChannels.begin(),
                     m_closedChannels.end(),
@@ -197,12 +205,13 @@ void Mediator::OnMsg(const ChannelIDPtr& chID, Blob&& blob)
 
     channel->OnPeerData(dataIn);
     auto state = channel->get_State();
-    if (state == Lightning::Channel::State::Closing1)
+    if (state == Lightning::Channel::State::Closing1 &&
+        channel->UpdateRestorePoint())
     {
-        channel->UpdateRestorePoint();
         m_pWalletDB->saveLaserChannel(*channel);
     }
     UpdateChannelExterior(channel);
+    ScheduleUpdate(channel);
 }
 
 bool Mediator::Decrypt(const ChannelIDPtr& chID, uint8_t* pMsg, Blob* blob)
@@ -380,6 +389,7 @@ void Mediator::OpenChannel(Amount aMy,
         *this, myOutAddr, receiverWalletID, aMy, aTrg, params);
 
     auto chID = channel->get_chID();
+    ScheduleUpdate(channel);
     m_channels[chID] = std::move(channel);
     
     m_actionsQueue.emplace_back([this, chID, hOpenTxDh] () {
@@ -662,6 +672,7 @@ bool Mediator::OnIncoming(const ChannelIDPtr& channelID,
     auto channel = std::make_unique<Channel>(
         *this, channelID, m_myInAddr, trgWid, aMy, aTrg, params);
     channel->Subscribe();
+    ScheduleUpdate(channel);
     m_channels[channel->get_chID()] = std::move(channel);
 
     m_pInputReceiver.reset();
@@ -683,6 +694,7 @@ void Mediator::OpenInternal(const ChannelIDPtr& chID, Height hOpenTxDh)
         LOG_INFO() << "Opening channel: "
                    << to_hex(chID->m_pData, chID->nBytes);
         UpdateChannelExterior(channel);
+        ScheduleUpdate(channel);
         return;
     }
 
@@ -715,6 +727,7 @@ void Mediator::TransferInternal(Amount amount, const Channel::Ptr& channel)
                     << " to channel: " << channelIdStr
                     << " started";
             UpdateChannelExterior(channel);
+            ScheduleUpdate(channel);
             return;
         }
         else
@@ -755,6 +768,7 @@ void Mediator::GracefulCloseInternal(const Channel::Ptr& channel)
         }
         UpdateChannelExterior(channel);
         channel->Subscribe();
+        ScheduleUpdate(channel);
     }
     else
     {
@@ -770,6 +784,7 @@ void Mediator::CloseInternal(const ChannelIDPtr& chID)
         channel->Close();
         UpdateChannelExterior(channel);
         channel->Subscribe();
+        ScheduleUpdate(channel);
         return;
     }
     LOG_ERROR() << "Can't close channel: " << to_hex(chID->m_pData, chID->nBytes);
@@ -853,6 +868,7 @@ bool Mediator::LoadAndStoreChannelInternal(const ChannelIDPtr& p_channelID)
     auto channel = LoadChannelInternal(p_channelID);
     if (channel && CanBeHandled(channel->get_State()))
     {
+        ScheduleUpdate(channel);
         m_channels[p_channelID] = std::move(channel);
         return true;
     }
@@ -863,48 +879,77 @@ bool Mediator::LoadAndStoreChannelInternal(const ChannelIDPtr& p_channelID)
     return false;
 }
 
-void Mediator::UpdateChannels()
+void Mediator::UpdateChannels(Height hTip)
 {
-    for (auto& it: m_channels)
+    // collect all the due channels first, rescheduling them won't affect this pass
+    std::vector<ChannelIDPtr> dueChannels;
+    while (!m_updatesQueue.empty() && m_updatesQueue.top().m_Height <= hTip)
     {
-        auto& channel = it.second;
-        auto state = channel->get_State();
+        ScheduledUpdate su = m_updatesQueue.top();
+        m_updatesQueue.pop();
 
-        bool revisionDiscarded = false;
-        if (state == Lightning::Channel::State::Updating && channel->IsUpdateStuck())
-        {
-            LOG_WARNING() << "Update stuck, discarding last revision...";
-            channel->DiscardLastRevision();
-            revisionDiscarded = true;
-        }
+        auto it = m_channels.find(su.m_chID);
+        if (it == m_channels.end() || !it->second)
+            continue;
 
-        bool closingDiscarded = false;
-        if (state == Lightning::Channel::State::Closing1 && channel->IsGracefulCloseStuck())
-        {
-            LOG_WARNING() << "Closing stuck, discarding last revision...";
-            channel->DiscardLastRevision();
-            closingDiscarded = true;
-        }
+        auto& channel = it->second;
+        if (channel->get_UpdateScheduled() != su.m_Height)
+            continue; // rescheduled
 
-        if (state != Lightning::Channel::State::None &&
-            state != Lightning::Channel::State::Closed &&
-            state != Lightning::Channel::State::OpenFailed &&
-            channel->IsSubscribed())
-        {
-            channel->Update();
-        }
+        channel->set_UpdateScheduled(MaxHeight);
+        dueChannels.push_back(su.m_chID);
+    }
 
-        UpdateChannelExterior(channel);
+    for (const auto& chID : dueChannels)
+    {
+        auto it = m_channels.find(chID);
+        if (it != m_channels.end() && it->second)
+            UpdateChannel(it->second);
+    }
+}
 
-        if (revisionDiscarded)
-            for (auto observer : m_observers)
-                observer->OnTransferFailed(channel->get_chID());
+void Mediator::UpdateChannel(const Channel::Ptr& channel)
+{
+    auto state = channel->get_State();
 
-        if (closingDiscarded)
-            for (auto observer : m_observers)
-                observer->OnCloseFailed(channel->get_chID());
+    bool revisionDiscarded = false;
+    if (state == Lightning::Channel::State::Updating && channel->IsUpdateStuck())
+    {
+        LOG_WARNING() << "Update stuck, discarding last revision...";
+        channel->DiscardLastRevision();
+        revisionDiscarded = true;
+    }
 
+    bool closingDiscarded = false;
+    if (state == Lightning::Channel::State::Closing1 && channel->IsGracefulCloseStuck())
+    {
+        LOG_WARNING() << "Closing stuck, discarding last revision...";
+        channel->DiscardLastRevision();
+        closingDiscarded = true;
     }
+
+    Height hTip = channel->get_Tip();
+    if (state != Lightning::Channel::State::None &&
+        state != Lightning::Channel::State::Closed &&
+        state != Lightning::Channel::State::OpenFailed &&
+        channel->IsSubscribed() &&
+        channel->get_NextUpdate() <= hTip)
+    {
+        channel->Update();
+    }
+
+    UpdateChannelExterior(channel);
+
+    if (revisionDiscarded)
+        for (auto observer : m_observers)
+            observer->OnTransferFailed(channel->get_chID());
+
+    if (closingDiscarded)
+        for (auto observer : m_observers)
+            observer->OnCloseFailed(channel->get_chID());
+
+    // Idle open channels are checked periodically, all others on each block
+    ScheduleUpdate(channel, std::max(channel->get_NextUpdate(), hTip + 1));
 }
 
 void Mediator::UpdateChannelExterior(const Channel::Ptr& channel)
@@ -960,6 +1005,15 @@ void Mediator::UpdateChannelExterior(const Channel::Ptr& channel)
     }
 }
 
+void Mediator::ScheduleUpdate(const Channel::Ptr& channel, Height h)
+{
+    if (channel->get_UpdateScheduled() <= h)
+        return; // already scheduled earlier
+
+    channel->set_UpdateScheduled(h);
+    m_updatesQueue.push({ h, channel->get_chID() });
+}
+
 bool Mediator::ValidateTip()
 {
     Block::SystemState::Full tip;
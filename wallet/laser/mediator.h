@@ -17,6 +17,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <queue>
 #include <vector>
 
 #include "wallet/laser/i_channel_holder.h"
@@ -102,8 +103,10 @@ private:
     Channel::Ptr LoadChannelInternal(
         const ChannelIDPtr& p_channelID);
     bool LoadAndStoreChannelInternal(const ChannelIDPtr& p_channelID);
-    void UpdateChannels();
+    void UpdateChannels(Height hTip);
+    void UpdateChannel(const Channel::Ptr& channel);
     void UpdateChannelExterior(const Channel::Ptr& channel);
+    void ScheduleUpdate(const Channel::Ptr& channel, Height h = 0);
     bool ValidateTip();
     bool IsEnoughCoinsAvailable(Amount required);
     void Subscribe();
@@ -121,6 +124,18 @@ private:
     WalletAddress m_myInAddr;
 
     std::unordered_map<ChannelIDPtr, Channel::Ptr> m_channels;
+
+    // channels ordered by the height at which they need attention. Entries
+    // are invalidated lazily: if the channel was rescheduled - it's skipped
+    struct ScheduledUpdate
+    {
+        Height m_Height;
+        ChannelIDPtr m_chID;
+
+        bool operator < (const ScheduledUpdate& x) const { return m_Height > x.m_Height; } // the earliest on top
+    };
+    std::priority_queue<ScheduledUpdate> m_updatesQueue;
+
     std::vector<std::function<void()>> m_actionsQueue;
     std::vector<ChannelIDPtr> m_readyForCloseChannels;
     std::vector<ChannelIDPtr> m_openedWithFailChannels;
@@ -770,6 +770,87 @@ namespace
         WALLET_CHECK(newSenderCoins[3].m_ID.m_Type == Key::Type::Regular);
     }
 
+    void TestBbsDecryptor()
+    {
+        cout << "\nTesting BBS trial decryption...\n";
+
+        constexpr size_t MessageSize = 256;
+        constexpr size_t MessageNum = 20;
+
+        ECC::Key::IKdf::Ptr kdf, senderKdf;
+        ECC::HKdf::Create(kdf, unsigned(123));
+        ECC::HKdf::Create(senderKdf, unsigned(3256));
+
+        ByteBuffer message(MessageSize);
+        std::generate(message.begin(), message.end(), []() { return static_cast<uint8_t>(std::rand() % 255); });
+
+        for (size_t nAddrs = 1; nAddrs <= 1000; nAddrs *= 10)
+        {
+            std::vector<ECC::Scalar::Native> vSk(nAddrs);
+            std::vector<PeerID> vPk(nAddrs);
+            for (size_t i = 0; i < nAddrs; ++i)
+            {
+                ECC::Hash::Value v;
+                ECC::Hash::Processor() << i >> v;
+                kdf->DeriveKey(vSk[i], v);
+                vPk[i].FromSk(vSk[i]);
+            }
+
+            // each message is addressed to the last address, so that all the addresses are tried
+            std::vector<ByteBuffer> messages(MessageNum);
+            for (auto& encryptedMessage : messages)
+            {
+                ECC::NoLeak<ECC::Hash::Value> hvRandom;
+                ECC::GenRandom(hvRandom.V);
+
+                ECC::Scalar::Native nonce;
+                senderKdf->DeriveKey(nonce, hvRandom.V);
+
+                WALLET_CHECK(proto::Bbs::Encrypt(encryptedMessage, vPk.back(), nonce, &message[0], static_cast<uint32_t>(message.size())));
+            }
+
+            uint32_t t = GetTime_ms();
+            for (const auto& msg : messages)
+            {
+                for (size_t i = 0; i < nAddrs; ++i)
+                {
+                    ByteBuffer buf = msg; // duplicate
+                    uint8_t* pMsg = &buf.front();
+                    uint32_t nSize = static_cast<uint32_t>(buf.size());
+                    if (proto::Bbs::Decrypt(pMsg, nSize, vSk[i]))
+                    {
+                        WALLET_CHECK(i + 1 == nAddrs);
+                        break;
+                    }
+                }
+            }
+            uint32_t dtLegacy = std::max<uint32_t>(GetTime_ms() - t, 1);
+
+            t = GetTime_ms();
+            ByteBuffer buf;
+            for (const auto& msg : messages)
+            {
+                proto::Bbs::Decryptor dec;
+                WALLET_CHECK(dec.Init(&msg.front(), static_cast<uint32_t>(msg.size())));
+
+                for (size_t i = 0; i < nAddrs; ++i)
+                {
+                    if (dec.Decrypt(buf, vSk[i], vPk[i]))
+                    {
+                        WALLET_CHECK(i + 1 == nAddrs);
+                        WALLET_CHECK(buf == message);
+                        break;
+                    }
+                }
+            }
+            uint32_t dtDecryptor = std::max<uint32_t>(GetTime_ms() - t, 1);
+
+            cout << "\tAddresses: " << nAddrs
+                << ", msgs/sec: " << MessageNum * 1000 / dtLegacy << " (per-attempt copy), "
+                << MessageNum * 1000 / dtDecryptor << " (decryptor)" << endl;
+        }
+    }
+
     void TestBbsDecrypt()
     {
         constexpr size_t AddressNum = 10000;
@@ -1443,6 +1524,82 @@ namespace
         }
     }
 
+    void TestBodiesDecoding()
+    {
+        cout << "\nTesting parallel decoding of block bodies...\n";
+
+        Key::IKdf::Ptr pOwner, pForeign;
+        HKdf::Create(pOwner, unsigned(123));
+        HKdf::Create(pForeign, unsigned(3256));
+
+        // synthetic chain: each block contains the same set of outputs, a few of them are ours
+        const uint32_t nBlocks = 50;
+        const uint32_t nForeignPerBlock = 40;
+        const uint32_t nOwnPerBlock = 2;
+        const Height h0 = 10;
+
+        std::vector<Output::Ptr> vTemplates;
+        for (uint32_t i = 0; i < nForeignPerBlock + nOwnPerBlock; i++)
+        {
+            bool bOwn = (i < nOwnPerBlock);
+            Key::IKdf& kdf = bOwn ? *pOwner : *pForeign;
+
+            CoinID cid(100 + i, i, Key::Type::Regular);
+            Scalar::Native sk;
+            auto& pOut = vTemplates.emplace_back(std::make_unique<Output>());
+            pOut->Create(h0, sk, kdf, cid, kdf);
+        }
+
+        std::vector<proto::BodyBuffers> vBodies(nBlocks);
+        for (auto& body : vBodies)
+        {
+            Block::Body block;
+            block.ZeroInit();
+            for (const auto& pTemplate : vTemplates)
+            {
+                auto& pOut = block.m_vOutputs.emplace_back(std::make_unique<Output>());
+                *pOut = *pTemplate;
+            }
+
+            Serializer ser;
+            ser & Cast::Down<Block::BodyBase>(block);
+            ser & Cast::Down<TxVectors::Perishable>(block);
+            ser.swap_buf(body.m_Perishable);
+
+            ser.reset();
+            ser & Cast::Down<TxVectors::Eternal>(block);
+            ser.swap_buf(body.m_Eternal);
+        }
+
+        for (uint32_t nThreads = 1; nThreads <= 4; nThreads <<= 1)
+        {
+            ExecutorMT_R ex;
+            ex.set_Threads(nThreads);
+
+            uint32_t t = GetTime_ms();
+
+            std::vector<Block::Body> blocks;
+            size_t nDecoded = Wallet::DecodeBodies(vBodies, h0, pOwner.get(), blocks, ex);
+
+            cout << "\t" << nBlocks * vTemplates.size() << " outputs in " << nBlocks << " blocks decoded in " << GetTime_ms() - t << " ms, Threads=" << nThreads << endl;
+
+            WALLET_CHECK(nDecoded == nBlocks);
+            WALLET_CHECK(blocks.size() == nBlocks);
+            for (const auto& block : blocks)
+            {
+                WALLET_CHECK(block.m_vOutputs.size() == nOwnPerBlock);
+            }
+        }
+
+        // corrupted body stops the decoding
+        vBodies[nBlocks / 2].m_Perishable.clear();
+
+        ExecutorMT_R ex;
+        std::vector<Block::Body> blocks;
+        WALLET_CHECK(Wallet::DecodeBodies(vBodies, h0, pOwner.get(), blocks, ex) == nBlocks / 2);
+        WALLET_CHECK(blocks.size() == nBlocks / 2);
+    }
+
     void TestTxNonces()
     {
         cout << "\nTesting tx nonce...\n";
@@ -2899,6 +3056,133 @@ void TestKeyKeeper(IPrivateKeyKeeper2::Ptr externalKeyKeeper = {}, size_t index
     WALLET_CHECK(tx.IsValid(ctx));
 }
 
+void TestThreadedKeyKeeper()
+{
+    cout << "\nTesting threaded key keeper...\n";
+
+    io::Reactor::Ptr mainReactor{ io::Reactor::create() };
+    io::Reactor::Scope scope(*mainReactor);
+
+    Key::IKdf::Ptr pKdf;
+    HKdf::Create(pKdf, 5634U);
+
+    auto pLocal = std::make_shared<LocalPrivateKeyKeeperStd>(pKdf);
+    auto pThreaded = std::make_shared<ThreadedPrivateKeyKeeper>(pLocal, 4);
+
+    const uint32_t nOutputs = 24;
+    const uint32_t nSigns = 4;
+    Height hScheme = Rules::get().pForks[1].m_Height + 19;
+
+    std::vector<uint32_t> vOrder;
+
+    struct MyHandler
+        :public IPrivateKeyKeeper2::Handler
+    {
+        std::vector<uint32_t>* m_pOrder;
+        uint32_t m_Idx;
+        uint32_t m_Total;
+
+        void OnDone(IPrivateKeyKeeper2::Status::Type n) override
+        {
+            WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == n);
+            m_pOrder->push_back(m_Idx);
+            if (m_pOrder->size() == m_Total)
+                io::Reactor::get_Current().stop();
+        }
+    };
+
+    std::vector<IPrivateKeyKeeper2::Method::CreateOutput> vOuts(nOutputs);
+    std::vector<IPrivateKeyKeeper2::Method::SignSender> vSigns(nSigns);
+
+    uint32_t nIdx = 0;
+    auto fnHandler = [&]()
+    {
+        auto pHandler = std::make_shared<MyHandler>();
+        pHandler->m_pOrder = &vOrder;
+        pHandler->m_Idx = nIdx++;
+        pHandler->m_Total = nOutputs + nSigns;
+        return pHandler;
+    };
+
+    // interleave the slot-bound methods with the outputs
+    for (uint32_t i = 0; i < nOutputs; i++)
+    {
+        auto& m = vOuts[i];
+        m.m_hScheme = hScheme;
+        m.m_Cid = CoinID(100 + i, 7000 + i, Key::Type::Regular);
+        pThreaded->InvokeAsync(m, fnHandler());
+
+        if (i % (nOutputs / nSigns))
+            continue;
+
+        auto& mS = vSigns[i / (nOutputs / nSigns)];
+        mS.m_Peer = 12U;
+        mS.m_MyIDKey = 14;
+        mS.m_Slot = 3;
+        mS.m_UserAgreement = Zero;
+        mS.m_pKernel.reset(new TxKernelStd);
+        mS.m_pKernel->m_Fee = 315;
+        mS.m_pKernel->m_Height.m_Min = hScheme;
+        mS.m_pKernel->m_Height.m_Max = hScheme + 700;
+        mS.m_vInputs.push_back(CoinID(515 + i, 2342, Key::Type::Regular, 11));
+        mS.m_vOutputs.push_back(CoinID(70, 2343, Key::Type::Change));
+        pThreaded->InvokeAsync(mS, fnHandler());
+    }
+
+    io::Timer::Ptr timer = io::Timer::create(*mainReactor);
+    timer->start(60000, false, []() { io::Reactor::get_Current().stop(); });
+
+    mainReactor->run();
+
+    // completion is reported in the order of invocation
+    WALLET_CHECK(vOrder.size() == nOutputs + nSigns);
+    for (uint32_t i = 0; i < vOrder.size(); i++)
+        WALLET_CHECK(vOrder[i] == i);
+
+    for (uint32_t i = 0; i < nOutputs; i++)
+    {
+        auto& m = vOuts[i];
+        WALLET_CHECK(m.m_pResult);
+
+        IPrivateKeyKeeper2::Method::CreateOutput m2;
+        m2.m_hScheme = hScheme;
+        m2.m_Cid = m.m_Cid;
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pLocal->InvokeSync(m2));
+        WALLET_CHECK(m2.m_pResult->m_Commitment == m.m_pResult->m_Commitment);
+
+        Point::Native comm;
+        WALLET_CHECK(m.m_pResult->IsValid(hScheme, comm));
+    }
+
+    // the same slot was used by all the signers, in order. Each one sees the same nonce
+    for (uint32_t i = 0; i < nSigns; i++)
+    {
+        WALLET_CHECK(vSigns[i].m_pKernel);
+        WALLET_CHECK(vSigns[i].m_pKernel->m_Signature.m_NoncePub == vSigns[0].m_pKernel->m_Signature.m_NoncePub);
+    }
+
+    // batched outputs, via both the local (parallel) and the threaded (per-output) implementations
+    IPrivateKeyKeeper2* ppKk[] = { pLocal.get(), pThreaded.get() };
+    for (IPrivateKeyKeeper2* pKk : ppKk)
+    {
+        IPrivateKeyKeeper2::Method::CreateOutputs mB;
+        mB.m_vOutputs.resize(nOutputs);
+        for (uint32_t i = 0; i < nOutputs; i++)
+        {
+            mB.m_vOutputs[i].m_hScheme = hScheme;
+            mB.m_vOutputs[i].m_Cid = vOuts[i].m_Cid;
+        }
+
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pKk->InvokeSync(mB));
+
+        for (uint32_t i = 0; i < nOutputs; i++)
+        {
+            WALLET_CHECK(mB.m_vOutputs[i].m_pResult);
+            WALLET_CHECK(mB.m_vOutputs[i].m_pResult->m_Commitment == vOuts[i].m_pResult->m_Commitment);
+        }
+    }
+}
+
 void TestVouchers()
 {
     cout << "\nTesting wallets vouchers exchange...\n";
@@ -3245,12 +3529,14 @@ int main()
     storage::HookErrors();
     TestTxList();
     TestKeyKeeper();
+    TestThreadedKeyKeeper();
 
     TestVouchers();
 
     TestAddressGeneration();
 
     //TestBbsDecrypt();
+    TestBbsDecryptor();
 
     TestConvertions();
     TestTxParameters();
@@ -3282,6 +3568,7 @@ int main()
     TestExpiredTransaction();
     TestNoResponse();
     TestTransactionUpdate();
+    TestBodiesDecoding();
     //TestTxPerformance();
     //TestTxNonces();
     